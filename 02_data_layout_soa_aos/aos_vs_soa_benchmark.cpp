@@ -4,6 +4,11 @@
 #include <random>
 #include <cmath>
 #include <iomanip>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
 
 // ============================================================================
 // AoS: Array of Structures（传统方式）
@@ -159,42 +164,297 @@ public:
 // ============================================================================
 // 性能测试框架
 // ============================================================================
+
+// 运行配置（由命令行设置）
+struct BenchConfig {
+    int trials = 11;            // 重复试验次数，取中位数
+    bool flush_cache = false;   // 每次试验前冲刷缓存（冷缓存测量）
+    size_t flush_bytes = 64u << 20;  // 冲刷缓冲区大小，应大于 LLC
+};
+
+// 单个基准测试的统计结果
+struct BenchResult {
+    std::string name;
+    bool cold_cache = false;    // 测量时是否冲刷缓存（冷 / 热缓存结果不可互相比较）
+    int trials = 0;
+    double median_ms = 0.0;     // 每次迭代耗时的中位数
+    double mad_ms = 0.0;        // 中位数绝对偏差（Median Absolute Deviation）
+    double min_ms = 0.0;
+    double bytes = 0.0;         // 每次迭代访问的有效字节数
+    double elements = 0.0;      // 每次迭代处理的元素数
+
+    double bytes_per_sec() const { return median_ms > 0.0 ? bytes / (median_ms / 1e3) : 0.0; }
+    double elements_per_sec() const { return median_ms > 0.0 ? elements / (median_ms / 1e3) : 0.0; }
+};
+
+BenchConfig g_config;
+std::vector<BenchResult> g_results;
+
+double median_of(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+// 读写一块大于 LLC 的缓冲区，把测试数据挤出缓存
+void flush_caches() {
+    static std::vector<char> buffer(g_config.flush_bytes);
+    volatile char sink = 0;
+    for (size_t i = 0; i < buffer.size(); i += 64) {
+        buffer[i] = static_cast<char>(buffer[i] + 1);
+        sink = sink + buffer[i];
+    }
+}
+
 template<typename Func>
-double benchmark(const std::string& name, Func func, int iterations = 1000) {
+BenchResult benchmark(const std::string& name, Func func, int iterations = 1000,
+                      double bytes = 0.0, double elements = 0.0) {
     // 预热
     func();
-    
-    auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; ++i) {
-        func();
+
+    std::vector<double> samples;
+    samples.reserve(g_config.trials);
+    for (int t = 0; t < g_config.trials; ++t) {
+        // 冷缓存模式：每次试验只计时冲刷后的单次调用，否则后续迭代又是热缓存
+        int n = iterations;
+        if (g_config.flush_cache) {
+            flush_caches();
+            n = 1;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < n; ++i) {
+            func();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count() / n);
     }
-    auto end = std::chrono::high_resolution_clock::now();
-    
-    double ms = std::chrono::duration<double, std::milli>(end - start).count();
-    double avg_ms = ms / iterations;
-    
-    std::cout << std::left << std::setw(40) << name 
-              << std::right << std::setw(10) << std::fixed << std::setprecision(3) 
-              << avg_ms << " ms/iter" << std::endl;
-    
-    return avg_ms;
+
+    BenchResult r;
+    r.name = name;
+    r.cold_cache = g_config.flush_cache;
+    r.trials = g_config.trials;
+    r.median_ms = median_of(samples);
+    std::vector<double> deviations;
+    for (double s : samples) {
+        deviations.push_back(std::abs(s - r.median_ms));
+    }
+    r.mad_ms = median_of(deviations);
+    r.min_ms = *std::min_element(samples.begin(), samples.end());
+    r.bytes = bytes;
+    r.elements = elements;
+
+    std::cout << std::left << std::setw(40) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(3)
+              << r.median_ms << " ms/iter ± " << std::setprecision(3) << r.mad_ms
+              << std::setw(9) << std::setprecision(2) << r.bytes_per_sec() / 1e9 << " GB/s"
+              << std::setw(9) << r.elements_per_sec() / 1e6 << " Melem/s" << std::endl;
+
+    g_results.push_back(r);
+    return r;
+}
+
+// ============================================================================
+// 结构化输出与回归检测
+// ============================================================================
+
+const char* cache_mode(bool cold) { return cold ? "cold" : "warm"; }
+
+constexpr const char* kCsvHeader = "name,cache,trials,median_ms,mad_ms,min_ms,bytes_per_sec,elements_per_sec";
+
+void write_csv(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    out << kCsvHeader << "\n";
+    out << std::setprecision(9);
+    for (const auto& r : results) {
+        out << r.name << ',' << cache_mode(r.cold_cache) << ',' << r.trials << ','
+            << r.median_ms << ',' << r.mad_ms << ','
+            << r.min_ms << ',' << r.bytes_per_sec() << ',' << r.elements_per_sec() << '\n';
+    }
+}
+
+void write_json(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    out << std::setprecision(9);
+    out << "{\n  \"cold_cache\": " << (g_config.flush_cache ? "true" : "false")
+        << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"trials\": " << r.trials
+            << ", \"median_ms\": " << r.median_ms << ", \"mad_ms\": " << r.mad_ms
+            << ", \"min_ms\": " << r.min_ms
+            << ", \"bytes_per_sec\": " << r.bytes_per_sec()
+            << ", \"elements_per_sec\": " << r.elements_per_sec() << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// 整个字符串都必须是数字（std::stoi("5x") 会静默返回 5），失败时抛出 std::invalid_argument
+int parse_int(const std::string& text) {
+    size_t used = 0;
+    int v = 0;
+    try {
+        v = std::stoi(text, &used);
+    } catch (const std::logic_error&) {
+        used = 0;
+    }
+    if (used == 0 || used != text.size()) throw std::invalid_argument("not an integer: '" + text + "'");
+    return v;
+}
+
+double parse_double(const std::string& text) {
+    size_t used = 0;
+    double v = 0.0;
+    try {
+        v = std::stod(text, &used);
+    } catch (const std::logic_error&) {
+        used = 0;
+    }
+    if (used == 0 || used != text.size()) throw std::invalid_argument("not a number: '" + text + "'");
+    return v;
+}
+
+// 读取 write_csv 生成的基线文件；格式不符时抛出 std::runtime_error（带行号）
+std::vector<BenchResult> read_csv(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open baseline: " + path);
+    }
+    std::vector<BenchResult> results;
+    std::string line;
+    if (!std::getline(in, line) || line != kCsvHeader) {
+        throw std::runtime_error(path + ": unexpected header (expected \"" +
+                                 std::string(kCsvHeader) + "\"); regenerate the baseline with --csv");
+    }
+    for (int line_no = 2; std::getline(in, line); ++line_no) {
+        std::istringstream row(line);
+        std::string field;
+        BenchResult r;
+        try {
+            std::getline(row, r.name, ',');
+            std::getline(row, field, ',');
+            if (field != "cold" && field != "warm") throw std::invalid_argument(field);
+            r.cold_cache = field == "cold";
+            std::getline(row, field, ','); r.trials = parse_int(field);
+            std::getline(row, field, ','); r.median_ms = parse_double(field);
+            std::getline(row, field, ','); r.mad_ms = parse_double(field);
+            std::getline(row, field, ','); r.min_ms = parse_double(field);
+        } catch (const std::logic_error&) {  // invalid_argument / out_of_range
+            throw std::runtime_error(path + ":" + std::to_string(line_no) + ": malformed row: " + line);
+        }
+        results.push_back(r);
+    }
+    return results;
+}
+
+// 当前中位数比基线慢超过 threshold（相对值）且超出噪声（3 × MAD）时判定为回归
+int compare_with_baseline(const std::vector<BenchResult>& baseline,
+                          const std::vector<BenchResult>& current, double threshold) {
+    int regressions = 0;
+    std::cout << "Regression check (threshold " << std::setprecision(1)
+              << threshold * 100.0 << "%)\n";
+    std::cout << "------------------------------------------------\n";
+    // 试验次数不同仍可比较（中位数与 MAD 都是稳健统计量），但噪声估计的可信度不同
+    if (!baseline.empty() && !current.empty() && baseline.front().trials != current.front().trials) {
+        std::cout << "  note: baseline used " << baseline.front().trials << " trials, this run "
+                  << current.front().trials << "\n";
+    }
+    for (const auto& cur : current) {
+        auto it = std::find_if(baseline.begin(), baseline.end(),
+                               [&](const BenchResult& b) { return b.name == cur.name; });
+        if (it == baseline.end()) {
+            std::cout << "  [new]  " << cur.name << "\n";
+            continue;
+        }
+        // 冷缓存比热缓存慢数倍，混合比较会得出虚假的回归 / 改进
+        if (it->cold_cache != cur.cold_cache) {
+            throw std::runtime_error("baseline '" + cur.name + "' was measured with a " +
+                                     cache_mode(it->cold_cache) + " cache, this run is " +
+                                     cache_mode(cur.cold_cache) + "; rerun with the same --cold setting");
+        }
+        double delta = cur.median_ms - it->median_ms;
+        double rel = delta / it->median_ms;
+        double noise = 3.0 * std::max(cur.mad_ms, it->mad_ms);
+        bool regressed = rel > threshold && delta > noise;
+        regressions += regressed;
+        std::cout << (regressed ? "  [FAIL] " : "  [ok]   ") << std::left << std::setw(32)
+                  << cur.name << std::right << std::showpos << std::setprecision(1)
+                  << rel * 100.0 << "%" << std::noshowpos << "\n";
+    }
+    std::cout << "\n";
+    return regressions;
 }
 
 // ============================================================================
 // 主程序
 // ============================================================================
-int main() {
+int main(int argc, char* argv[]) {
     constexpr size_t PARTICLE_COUNT = 1'000'000;  // 100 万个粒子
     constexpr int ITERATIONS = 100;
     constexpr float DT = 0.016f;  // 60 FPS
 
+    // 命令行选项
+    std::string json_path, csv_path, baseline_path;
+    double threshold = 0.05;
+    auto usage = [&]() {
+        std::cerr << "usage: " << argv[0] << " [--trials N] [--cold] [--json FILE]"
+                  << " [--csv FILE] [--baseline FILE.csv] [--threshold 0.05]\n";
+        return 2;
+    };
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--trials") g_config.trials = std::max(1, parse_int(next()));
+            else if (arg == "--cold") g_config.flush_cache = true;
+            else if (arg == "--json") json_path = next();
+            else if (arg == "--csv") csv_path = next();
+            else if (arg == "--baseline") baseline_path = next();
+            else if (arg == "--threshold") threshold = parse_double(next());
+            else return usage();
+        }
+    } catch (const std::logic_error& e) {  // invalid_argument / out_of_range
+        std::cerr << "invalid argument: " << e.what() << "\n";
+        return usage();
+    }
+    // 基线在测量之前读取：文件缺失或格式错误时不必先跑完整个测试
+    std::vector<BenchResult> baseline;
+    if (!baseline_path.empty()) {
+        try {
+            baseline = read_csv(baseline_path);
+        } catch (const std::exception& e) {
+            std::cerr << "error: " << e.what() << "\n";
+            return 2;
+        }
+        for (const auto& b : baseline) {
+            if (b.cold_cache != g_config.flush_cache) {
+                std::cerr << "error: " << baseline_path << " was measured with a "
+                          << cache_mode(b.cold_cache) << " cache, this run is "
+                          << cache_mode(g_config.flush_cache) << "; rerun with the same --cold setting\n";
+                return 2;
+            }
+        }
+    }
+
     std::cout << "================================================\n";
     std::cout << "  AoS vs SoA Performance Benchmark\n";
     std::cout << "================================================\n";
     std::cout << "Particle count: " << PARTICLE_COUNT << "\n";
     std::cout << "Iterations: " << ITERATIONS << "\n";
+    std::cout << "Trials: " << g_config.trials << " (median ± MAD)\n";
+    std::cout << "Cache: " << (g_config.flush_cache ? "cold (flushed before each trial)" : "warm")
+              << "\n";
     std::cout << "================================================\n\n";
 
+    // 每次迭代的有效数据量（与布局无关，便于横向比较）
+    // Update: 读 6 个 float，写 3 个 float；Kinetic Energy: 读 4 个 float
+    constexpr double N = static_cast<double>(PARTICLE_COUNT);
+    constexpr double UPDATE_BYTES = N * sizeof(float) * 9;
+    constexpr double KE_BYTES = N * sizeof(float) * 4;
+
     // 创建粒子系统
     std::cout << "Initializing particle systems...\n";
     ParticleSystem_AoS aos(PARTICLE_COUNT);
@@ -207,13 +467,13 @@ int main() {
     std::cout << "------------------------------------------------\n";
     
     double aos_update_time = benchmark("AoS Update", 
-        [&]() { aos.update(DT); }, ITERATIONS);
+        [&]() { aos.update(DT); }, ITERATIONS, UPDATE_BYTES, N).median_ms;
     
     double soa_update_time = benchmark("SoA Update", 
-        [&]() { soa.update(DT); }, ITERATIONS);
+        [&]() { soa.update(DT); }, ITERATIONS, UPDATE_BYTES, N).median_ms;
     
     double hybrid_update_time = benchmark("Hybrid SoA Update", 
-        [&]() { hybrid.update(DT); }, ITERATIONS);
+        [&]() { hybrid.update(DT); }, ITERATIONS, UPDATE_BYTES, N).median_ms;
 
     std::cout << "\nSpeedup:\n";
     std::cout << "  SoA vs AoS:        " << std::fixed << std::setprecision(2) 
@@ -227,15 +487,15 @@ int main() {
     
     double aos_ke_time = benchmark("AoS Kinetic Energy", 
         [&]() { volatile float ke = aos.compute_kinetic_energy(); (void)ke; }, 
-        ITERATIONS);
+        ITERATIONS, KE_BYTES, N).median_ms;
     
     double soa_ke_time = benchmark("SoA Kinetic Energy", 
         [&]() { volatile float ke = soa.compute_kinetic_energy(); (void)ke; }, 
-        ITERATIONS);
+        ITERATIONS, KE_BYTES, N).median_ms;
     
     double hybrid_ke_time = benchmark("Hybrid SoA Kinetic Energy", 
         [&]() { volatile float ke = hybrid.compute_kinetic_energy(); (void)ke; }, 
-        ITERATIONS);
+        ITERATIONS, KE_BYTES, N).median_ms;
 
     std::cout << "\nSpeedup:\n";
     std::cout << "  SoA vs AoS:        " 
@@ -299,7 +559,27 @@ int main() {
     std::cout << "✓ Use Hybrid SoA when:\n";
     std::cout << "  - Different access patterns for different operations\n";
     std::cout << "  - Can group frequently co-accessed fields\n";
-    std::cout << "================================================\n";
+    std::cout << "================================================\n\n";
+
+    // 结构化输出
+    if (!json_path.empty()) write_json(json_path, g_results);
+    if (!csv_path.empty()) write_csv(csv_path, g_results);
+
+    // 回归门禁：任一布局比基线慢超过阈值则返回非零
+    if (!baseline_path.empty()) {
+        int regressions = 0;
+        try {
+            regressions = compare_with_baseline(baseline, g_results, threshold);
+        } catch (const std::exception& e) {
+            std::cerr << "error: " << e.what() << "\n";
+            return 2;
+        }
+        if (regressions > 0) {
+            std::cout << regressions << " benchmark(s) regressed against " << baseline_path << "\n";
+            return 1;
+        }
+        std::cout << "No regressions against " << baseline_path << "\n";
+    }
 
     return 0;
 }
@@ -314,6 +594,13 @@ int main() {
   g++ -std=c++20 -O3 -march=native aos_vs_soa_benchmark.cpp -o benchmark_opt
   ./benchmark_opt
 
+结构化输出与回归门禁:
+  ./benchmark_opt --trials 21 --csv baseline.csv --json baseline.json   # 生成基线
+  ./benchmark_opt --cold --trials 21                                    # 冷缓存测量
+  ./benchmark_opt --baseline baseline.csv --threshold 0.05              # 慢 5% 以上返回 1
+  # 判定条件: (当前中位数 - 基线中位数) > 阈值 × 基线 且 > 3 × MAD（排除噪声）
+  # 基线记录缓存模式（cold / warm）与试验次数；模式不同时拒绝比较并返回 2
+
 超级优化版本（需要先运行 PGO）:
   g++ -std=c++20 -O3 -march=native -fprofile-generate aos_vs_soa_benchmark.cpp -o benchmark_pgo
   ./benchmark_pgo
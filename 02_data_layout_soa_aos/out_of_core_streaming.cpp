@@ -0,0 +1,495 @@
+// out_of_core_streaming.cpp
+// 超出内存的 SoA 粒子系统：列存于内存映射文件，按块双缓冲流式处理
+// 包含：mmap 列存储、madvise/posix_fadvise 预取、异步读取线程、I/O 与计算重叠
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <chrono>
+#include <random>
+#include <future>
+#include <iomanip>
+#include <algorithm>
+#include <system_error>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// Part 1: 内存映射列（一个 SoA 字段 = 一个文件）
+// ============================================================================
+
+class MappedColumn {
+    int fd_ = -1;
+    float* data_ = nullptr;
+    size_t count_ = 0;
+
+    static size_t page_size() {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page;
+    }
+
+    // 将 [begin, end) 元素区间扩展为页对齐的字节区间
+    std::pair<char*, size_t> page_range(size_t begin, size_t end) const {
+        const size_t page = page_size();
+        size_t first = (begin * sizeof(float)) / page * page;
+        size_t last = std::min(end * sizeof(float), bytes());
+        return { reinterpret_cast<char*>(data_) + first, last - first };
+    }
+
+public:
+    MappedColumn(const std::string& path, size_t count) : count_(count) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(bytes())) != 0) {
+            int err = errno;
+            ::close(fd_);
+            throw std::system_error(err, std::generic_category(), "ftruncate " + path);
+        }
+        void* p = ::mmap(nullptr, bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            int err = errno;
+            ::close(fd_);
+            throw std::system_error(err, std::generic_category(), "mmap " + path);
+        }
+        data_ = static_cast<float*>(p);
+        // 整体顺序访问：让内核加大预读窗口
+        ::madvise(data_, bytes(), MADV_SEQUENTIAL);
+    }
+
+    ~MappedColumn() {
+        if (data_) ::munmap(data_, bytes());
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    MappedColumn(const MappedColumn&) = delete;
+    MappedColumn& operator=(const MappedColumn&) = delete;
+
+    MappedColumn(MappedColumn&& other) noexcept
+        : fd_(other.fd_), data_(other.data_), count_(other.count_) {
+        other.fd_ = -1;
+        other.data_ = nullptr;
+    }
+
+    float* data() { return data_; }
+    const float* data() const { return data_; }
+    size_t size() const { return count_; }
+    size_t bytes() const { return count_ * sizeof(float); }
+
+    // 异步提示：请内核开始读入该区间（不阻塞）
+    void advise_willneed(size_t begin, size_t end) const {
+        auto [p, len] = page_range(begin, end);
+        ::posix_fadvise(fd_, p - reinterpret_cast<char*>(data_),
+                        static_cast<off_t>(len), POSIX_FADV_WILLNEED);
+        ::madvise(p, len, MADV_WILLNEED);
+    }
+
+    // 同步预取：每页读一个字节，强制缺页在读取线程中完成
+    size_t touch(size_t begin, size_t end) const {
+        auto [p, len] = page_range(begin, end);
+        const size_t page = page_size();
+        volatile char sink = 0;
+        for (size_t off = 0; off < len; off += page) {
+            sink = sink + p[off];
+        }
+        return len;
+    }
+
+    // 块处理完毕：异步回写脏页并释放映射，防止驻留集无限增长
+    void release(size_t begin, size_t end, bool dirty = true) {
+        auto [p, len] = page_range(begin, end);
+        if (dirty) ::msync(p, len, MS_ASYNC);
+        ::madvise(p, len, MADV_DONTNEED);
+    }
+
+    // 回写并从 page cache 中逐出，用于冷缓存测量
+    void drop_cache() {
+        ::msync(data_, bytes(), MS_SYNC);
+        ::madvise(data_, bytes(), MADV_DONTNEED);
+        ::fdatasync(fd_);
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED);
+    }
+};
+
+// ============================================================================
+// Part 2: 内存映射 SoA 粒子系统
+// ============================================================================
+
+enum class PrefetchMode {
+    None,       // 同步：缺页发生在计算循环中
+    Advise,     // madvise/posix_fadvise 提示下一块
+    AsyncRead   // 独立读取线程预取下一块（双缓冲）
+};
+
+const char* to_string(PrefetchMode mode) {
+    switch (mode) {
+        case PrefetchMode::None:      return "Synchronous (page faults)";
+        case PrefetchMode::Advise:    return "madvise/fadvise WILLNEED";
+        case PrefetchMode::AsyncRead: return "Async reader thread";
+    }
+    return "?";
+}
+
+// 一次流式遍历的统计信息
+struct StreamStats {
+    size_t bytes = 0;          // 计算阶段访问的字节数
+    double wall_ms = 0.0;      // 总耗时
+    double compute_ms = 0.0;   // 主线程计算耗时
+    double io_ms = 0.0;        // 读取线程预取耗时
+    double stall_ms = 0.0;     // 主线程等待预取的耗时
+    bool io_measured = false;  // 只有独立读取线程时 I/O 时间才能单独计量
+
+    double io_bandwidth_gbs() const {
+        return io_ms > 0.0 ? static_cast<double>(bytes) / (io_ms * 1e6) : 0.0;
+    }
+    double compute_rate_gbs() const {
+        return compute_ms > 0.0 ? static_cast<double>(bytes) / (compute_ms * 1e6) : 0.0;
+    }
+    double effective_gbs() const {
+        return wall_ms > 0.0 ? static_cast<double>(bytes) / (wall_ms * 1e6) : 0.0;
+    }
+};
+
+class ParticleSystem_MappedSoA {
+public:
+    enum Field { X, Y, Z, VX, VY, VZ, MASS, FIELD_COUNT };
+
+private:
+    static constexpr std::array<const char*, FIELD_COUNT> kFieldNames = {
+        "x", "y", "z", "vx", "vy", "vz", "mass"
+    };
+
+    std::vector<MappedColumn> columns_;
+    size_t count_;
+    size_t chunk_;
+
+    // 双缓冲流水线：计算第 k 块时，预取第 k+1 块
+    template<typename Kernel>
+    StreamStats stream(std::initializer_list<Field> fields, PrefetchMode mode,
+                       bool writes, Kernel kernel) {
+        using clock = std::chrono::high_resolution_clock;
+        StreamStats stats;
+        const size_t chunks = (count_ + chunk_ - 1) / chunk_;
+
+        auto prefetch = [&](size_t k) {
+            size_t begin = k * chunk_;
+            size_t end = std::min(begin + chunk_, count_);
+            auto t0 = clock::now();
+            for (Field f : fields) {
+                columns_[f].advise_willneed(begin, end);
+                if (mode == PrefetchMode::AsyncRead) {
+                    columns_[f].touch(begin, end);
+                }
+            }
+            return std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+        };
+
+        auto start = clock::now();
+        std::future<double> pending;
+        if (mode != PrefetchMode::None && chunks > 0) {
+            stats.io_ms += prefetch(0);
+        }
+
+        for (size_t k = 0; k < chunks; ++k) {
+            size_t begin = k * chunk_;
+            size_t end = std::min(begin + chunk_, count_);
+
+            if (pending.valid()) {
+                auto t0 = clock::now();
+                stats.io_ms += pending.get();
+                stats.stall_ms += std::chrono::duration<double, std::milli>(
+                    clock::now() - t0).count();
+            }
+            if (k + 1 < chunks) {
+                if (mode == PrefetchMode::AsyncRead) {
+                    pending = std::async(std::launch::async, prefetch, k + 1);
+                } else if (mode == PrefetchMode::Advise) {
+                    stats.io_ms += prefetch(k + 1);
+                }
+            }
+
+            auto t0 = clock::now();
+            kernel(begin, end);
+            stats.compute_ms += std::chrono::duration<double, std::milli>(
+                clock::now() - t0).count();
+
+            for (Field f : fields) {
+                columns_[f].release(begin, end, writes);
+            }
+            stats.bytes += (end - begin) * sizeof(float) * fields.size();
+        }
+
+        stats.wall_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        // 同步 / madvise 模式下缺页发生在计算循环中，I/O 无法单独拆分
+        stats.io_measured = (mode == PrefetchMode::AsyncRead);
+        return stats;
+    }
+
+public:
+    ParticleSystem_MappedSoA(const std::string& dir, size_t count, size_t chunk)
+        : count_(count), chunk_(chunk) {
+        columns_.reserve(FIELD_COUNT);
+        for (int f = 0; f < FIELD_COUNT; ++f) {
+            columns_.emplace_back(column_path(dir, static_cast<Field>(f)), count);
+        }
+    }
+
+    static std::string column_path(const std::string& dir, Field field) {
+        return dir + "/particles_" + kFieldNames[field] + ".f32";
+    }
+
+    // 删除 dir 下的全部列文件（不存在的忽略），映射关闭后调用
+    static void remove_files(const std::string& dir) {
+        for (int f = 0; f < FIELD_COUNT; ++f) {
+            ::unlink(column_path(dir, static_cast<Field>(f)).c_str());
+        }
+    }
+
+    size_t size() const { return count_; }
+    size_t chunk_size() const { return chunk_; }
+    size_t file_bytes() const { return count_ * sizeof(float) * FIELD_COUNT; }
+
+    // 按块生成初始数据（与内存版本相同的分布），每块写完即释放
+    void initialize() {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+        for (size_t begin = 0; begin < count_; begin += chunk_) {
+            size_t end = std::min(begin + chunk_, count_);
+            for (size_t i = begin; i < end; ++i) {
+                for (int f = X; f <= VZ; ++f) {
+                    columns_[f].data()[i] = dist(rng);
+                }
+                columns_[MASS].data()[i] = 1.0f;
+            }
+            for (auto& col : columns_) col.release(begin, end);
+        }
+    }
+
+    void drop_cache() {
+        for (auto& col : columns_) col.drop_cache();
+    }
+
+    // 更新粒子位置（读写 6 列）
+    StreamStats update(float dt, PrefetchMode mode) {
+        float* x = columns_[X].data();
+        float* y = columns_[Y].data();
+        float* z = columns_[Z].data();
+        const float* vx = columns_[VX].data();
+        const float* vy = columns_[VY].data();
+        const float* vz = columns_[VZ].data();
+
+        return stream({ X, Y, Z, VX, VY, VZ }, mode, true,
+            [=](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    x[i] += vx[i] * dt;
+                    y[i] += vy[i] * dt;
+                    z[i] += vz[i] * dt;
+                }
+            });
+    }
+
+    // 计算动能（只读 4 列）
+    StreamStats compute_kinetic_energy(PrefetchMode mode, double& energy) {
+        const float* vx = columns_[VX].data();
+        const float* vy = columns_[VY].data();
+        const float* vz = columns_[VZ].data();
+        const float* mass = columns_[MASS].data();
+
+        double total = 0.0;
+        StreamStats stats = stream({ VX, VY, VZ, MASS }, mode, false,
+            [&](size_t begin, size_t end) {
+                float partial = 0.0f;
+                for (size_t i = begin; i < end; ++i) {
+                    float v2 = vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i];
+                    partial += 0.5f * mass[i] * v2;
+                }
+                total += partial;
+            });
+        energy = total;
+        return stats;
+    }
+};
+
+// ============================================================================
+// Part 3: 报告
+// ============================================================================
+
+void print_header() {
+    std::cout << std::left << std::setw(28) << "Mode"
+              << std::right << std::setw(10) << "wall ms"
+              << std::setw(12) << "compute ms"
+              << std::setw(10) << "stall ms"
+              << std::setw(11) << "I/O GB/s"
+              << std::setw(14) << "compute GB/s"
+              << std::setw(11) << "eff GB/s" << "\n";
+}
+
+void print_stats(PrefetchMode mode, const StreamStats& s) {
+    std::cout << std::left << std::setw(28) << to_string(mode)
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << s.wall_ms
+              << std::setw(12) << s.compute_ms
+              << std::setw(10) << s.stall_ms
+              << std::setprecision(2) << std::setw(11);
+    if (s.io_measured) {
+        std::cout << s.io_bandwidth_gbs();
+    } else {
+        std::cout << "-";
+    }
+    std::cout << std::setw(14) << s.compute_rate_gbs()
+              << std::setw(11) << s.effective_gbs() << "\n";
+}
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+// 正整数参数：拒绝空串、负号、尾随字符、0 与溢出（strtoull 会把 "-1" 回绕成极大值）
+bool parse_count(const char* text, size_t& value) {
+    if (*text < '0' || *text > '9') return false;
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long v = std::strtoull(text, &end, 10);
+    if (errno != 0 || *end != '\0' || v == 0) return false;
+    value = static_cast<size_t>(v);
+    return true;
+}
+
+void print_usage(const char* argv0, size_t max_particles) {
+    std::cerr << "usage: " << argv0 << " [--count N] [--dir DIR] [--chunk N] [--keep]\n"
+              << "  --count, --chunk: positive integers (count <= " << max_particles << ")\n"
+              << "  --keep: leave the column files in DIR instead of deleting them on exit\n";
+}
+
+// 测量主体：列文件的创建、初始化与两组流式测试
+void run(const std::string& dir, size_t particle_count, size_t chunk) {
+    constexpr float DT = 0.016f;
+
+    std::cout << "================================================\n";
+    std::cout << "  Out-of-Core SoA Streaming (mmap + prefetch)\n";
+    std::cout << "================================================\n";
+    std::cout << "Particle count: " << particle_count << "\n";
+    std::cout << "Chunk size:     " << chunk << " particles ("
+              << static_cast<double>(chunk * sizeof(float) * 7) / 1024.0 / 1024.0
+              << " MB across 7 columns)\n";
+    std::cout << "Column dir:     " << dir << "\n";
+
+    ParticleSystem_MappedSoA system(dir, particle_count, chunk);
+    std::cout << "File footprint: " << static_cast<double>(system.file_bytes()) / 1024.0 / 1024.0
+              << " MB\n";
+    std::cout << "================================================\n\n";
+
+    std::cout << "Initializing column files...\n";
+    system.initialize();
+    std::cout << "Done!\n\n";
+
+    const PrefetchMode modes[] = {
+        PrefetchMode::None, PrefetchMode::Advise, PrefetchMode::AsyncRead
+    };
+
+    // 测试 1: Update（读写 6 列）
+    std::cout << "Test 1: Update particles, cold page cache (6 columns read+write)\n";
+    std::cout << "------------------------------------------------\n";
+    print_header();
+    for (PrefetchMode mode : modes) {
+        system.drop_cache();
+        print_stats(mode, system.update(DT, mode));
+    }
+    std::cout << "\n";
+
+    // 测试 2: Kinetic Energy（只读 4 列）
+    std::cout << "Test 2: Kinetic energy, cold page cache (4 columns read-only)\n";
+    std::cout << "------------------------------------------------\n";
+    print_header();
+    double energy = 0.0;
+    for (PrefetchMode mode : modes) {
+        system.drop_cache();
+        print_stats(mode, system.compute_kinetic_energy(mode, energy));
+    }
+    std::cout << "Total kinetic energy: " << std::setprecision(4) << std::scientific
+              << energy << std::fixed << "\n\n";
+
+    std::cout << "================================================\n";
+    std::cout << "How to read the report\n";
+    std::cout << "================================================\n";
+    std::cout << "  I/O GB/s:     bytes / time spent faulting pages in (reader side)\n";
+    std::cout << "  compute GB/s: bytes / time spent in the kernel (memory-resident rate)\n";
+    std::cout << "  eff GB/s:     bytes / wall time (what the pipeline actually delivers)\n";
+    std::cout << "  stall ms:     main thread waiting for the next chunk\n\n";
+    std::cout << "✓ eff ≈ min(I/O, compute) → I/O and compute fully overlapped\n";
+    std::cout << "✓ stall ≈ 0 → compute-bound, larger chunks will not help\n";
+    std::cout << "✓ stall ≫ 0 → I/O-bound, the storage device is the ceiling\n";
+    std::cout << "================================================\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t particle_count = 16'000'000;
+    std::string dir = "/tmp";
+    size_t chunk = 4'000'000;
+    bool keep = false;
+    // chunk = 0 会在分块计算中除零；count = 0 会以长度 0 调用 mmap（EINVAL）。
+    // 上限保证 7 列的文件大小不溢出 off_t
+    constexpr size_t MAX_PARTICLES = static_cast<size_t>(INT64_MAX) / (sizeof(float) * 7);
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool valid = true;
+        if (arg == "--keep") {
+            keep = true;
+            continue;
+        } else if (arg == "--count" && value) {
+            valid = parse_count(value, particle_count) && particle_count <= MAX_PARTICLES;
+        } else if (arg == "--chunk" && value) {
+            valid = parse_count(value, chunk);
+        } else if (arg == "--dir" && value && *value) {
+            dir = value;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            print_usage(argv[0], MAX_PARTICLES);
+            return 2;
+        }
+        ++i;
+    }
+    chunk = std::min(chunk, particle_count);
+
+    // 目录不存在 / 不可写、磁盘空间不足等在创建或映射列文件时以 system_error 抛出。
+    // 无论成功与否，退出前删除列文件（--keep 时保留，便于用 vmtouch 等工具检查）
+    int status = 0;
+    try {
+        run(dir, particle_count, chunk);
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        status = 1;
+    }
+    if (!keep) ParticleSystem_MappedSoA::remove_files(dir);
+    return status;
+}
+
+/* 编译与运行:
+
+  g++ -std=c++20 -O3 -march=native -pthread out_of_core_streaming.cpp -o ooc
+  ./ooc                                                    # 1600 万粒子, 448 MB，放在 /tmp
+  ./ooc --count 1000000000 --dir /mnt/nvme --chunk 16000000  # 10 亿粒子, 28 GB, 放在 NVMe 上
+  ./ooc --keep                                             # 退出后保留列文件（默认删除）
+
+说明:
+  1. 每个 SoA 字段是一个独立文件（particles_x.f32 ...），MAP_SHARED 映射
+  2. 每轮测试前 drop_cache() 回写并逐出 page cache，得到冷缓存数据
+  3. 块处理完毕后 MADV_DONTNEED 释放映射，驻留集始终约为 2 个块
+  4. AsyncRead 模式下读取线程在计算第 k 块时把第 k+1 块的页全部调入
+
+预期结果 (NVMe SSD, ~3 GB/s 顺序读):
+  Synchronous:    eff ≈ 0.5-1 GB/s（缺页阻塞计算）
+  madvise:        eff ≈ 1-2 GB/s
+  Async reader:   eff ≈ I/O 带宽（计算被完全隐藏）
+*/
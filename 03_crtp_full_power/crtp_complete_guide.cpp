@@ -8,6 +8,20 @@
 #include <memory>
 #include <concepts>
 #include <type_traits>
+#include <variant>
+#include <tuple>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <array>
+#include <span>
+#include <atomic>
+#include <thread>
+#include <new>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 // ============================================================================
 // 第一部分：传统虚函数 vs CRTP 性能对比
@@ -56,6 +70,32 @@ public:
     explicit CircleCRTP(double r) : radius(r) {}
     double area_impl() const { return 3.14159 * radius * radius; }
     double perimeter_impl() const { return 2 * 3.14159 * radius; }
+    double get_radius() const { return radius; }
+
+    // SoA 批量入口：半径是一个连续数组，直接按向量宽度读取
+    static void area_batch_soa(std::span<const double> r, std::span<double> out) {
+        const size_t n = r.size();
+        size_t i = 0;
+#ifdef __AVX2__
+        const __m256d pi = _mm256_set1_pd(3.14159);
+        for (; i + 4 <= n; i += 4) {
+            __m256d vr = _mm256_loadu_pd(r.data() + i);
+            _mm256_storeu_pd(out.data() + i, _mm256_mul_pd(_mm256_mul_pd(pi, vr), vr));
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = 3.14159 * r[i] * r[i];
+        }
+    }
+
+    // 旧的 AoS 批量路径，仅作基准对照：先把半径拷贝到 out 作为列，再原地求面积。
+    // 对 out 两趟读写，比逐对象融合循环还慢，total_area 不使用
+    static void area_batch_gather(std::span<const CircleCRTP> shapes, std::span<double> out) {
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            out[i] = shapes[i].radius;
+        }
+        area_batch_soa(out.first(shapes.size()), out);
+    }
 };
 
 class RectangleCRTP : public ShapeCRTP<RectangleCRTP> {
@@ -64,13 +104,65 @@ public:
     RectangleCRTP(double w, double h) : width(w), height(h) {}
     double area_impl() const { return width * height; }
     double perimeter_impl() const { return 2 * (width + height); }
+    double get_width() const { return width; }
+    double get_height() const { return height; }
+
+    // SoA 批量入口：宽、高各一个连续数组
+    static void area_batch_soa(std::span<const double> w, std::span<const double> h,
+                               std::span<double> out) {
+        const size_t n = w.size();
+        size_t i = 0;
+#ifdef __AVX2__
+        for (; i + 4 <= n; i += 4) {
+            __m256d vw = _mm256_loadu_pd(w.data() + i);
+            __m256d vh = _mm256_loadu_pd(h.data() + i);
+            _mm256_storeu_pd(out.data() + i, _mm256_mul_pd(vw, vh));
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = w[i] * h[i];
+        }
+    }
+
+    // 旧的 AoS 批量路径，仅作基准对照：按小块把宽、高拷贝成两列，再调用 SoA 内核
+    static void area_batch_gather(std::span<const RectangleCRTP> shapes, std::span<double> out) {
+        constexpr size_t CHUNK = 256;
+        double w[CHUNK], h[CHUNK];
+        for (size_t base = 0; base < shapes.size(); base += CHUNK) {
+            const size_t n = std::min(CHUNK, shapes.size() - base);
+            for (size_t i = 0; i < n; ++i) {
+                w[i] = shapes[base + i].width;
+                h[i] = shapes[base + i].height;
+            }
+            area_batch_soa({ w, n }, { h, n }, out.subspan(base, n));
+        }
+    }
+};
+
+// SoA 存储：每个字段一个连续数组，批量内核不需要任何拷贝或重排
+struct CircleSoA {
+    std::vector<double> radius;
+
+    size_t size() const { return radius.size(); }
+    void push_back(const CircleCRTP& c) { radius.push_back(c.get_radius()); }
+};
+
+struct RectangleSoA {
+    std::vector<double> width;
+    std::vector<double> height;
+
+    size_t size() const { return width.size(); }
+    void push_back(const RectangleCRTP& r) {
+        width.push_back(r.get_width());
+        height.push_back(r.get_height());
+    }
 };
 
 // ============================================================================
 // 第二部分：CRTP Mixin 模式
 // ============================================================================
 
-// Mixin 1: 计数功能
+// Mixin 1: 计数功能（单线程版本；多线程下 ++count 是数据竞争，见 ShardedCountable）
 template<typename Derived>
 class Countable {
     inline static size_t count = 0;
@@ -126,6 +218,172 @@ public:
     int get_age() const { return age; }
 };
 
+// ----------------------------------------------------------------------------
+// 线程安全的遥测 Mixin：按线程分片计数，读取时再求和
+// ----------------------------------------------------------------------------
+
+// 编译时加 -DNO_TELEMETRY 即全部退化为空基类（EBO 后零字节、零指令）
+#ifdef NO_TELEMETRY
+inline constexpr bool kTelemetryEnabled = false;
+#else
+inline constexpr bool kTelemetryEnabled = true;
+#endif
+
+// 每个线程固定写自己的缓存行，写路径上没有共享缓存行在核间来回传递
+template<size_t Shards = 64>
+class ShardedCounter {
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{0};
+    };
+    std::array<Shard, Shards> shards_;
+
+    static size_t shard_index() {
+        static std::atomic<size_t> next_thread{0};
+        thread_local const size_t index = next_thread.fetch_add(1, std::memory_order_relaxed);
+        return index % Shards;
+    }
+
+public:
+    // 分片几乎总是本线程独占，relaxed fetch_add 不会产生争用
+    void add(int64_t delta) {
+        shards_[shard_index()].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    // 懒求和：只有读取时才访问全部分片
+    int64_t sum() const {
+        int64_t total = 0;
+        for (const auto& shard : shards_) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+// Mixin 4: 线程安全计数（对象在 A 线程构造、B 线程析构时，各分片之和依然正确）
+template<typename Derived, bool Enabled = kTelemetryEnabled>
+class ShardedCountable {
+    inline static ShardedCounter<> count_;
+public:
+    ShardedCountable() { count_.add(1); }
+    ShardedCountable(const ShardedCountable&) { count_.add(1); }
+    ~ShardedCountable() { count_.add(-1); }
+    static size_t get_count() { return static_cast<size_t>(count_.sum()); }
+};
+
+template<typename Derived>
+class ShardedCountable<Derived, false> {
+public:
+    static size_t get_count() { return 0; }
+};
+
+// 对照组：单个共享原子变量，所有线程争抢同一缓存行
+template<typename Derived>
+class AtomicCountable {
+    inline static std::atomic<int64_t> count_{0};
+public:
+    AtomicCountable() { count_.fetch_add(1, std::memory_order_relaxed); }
+    AtomicCountable(const AtomicCountable&) { count_.fetch_add(1, std::memory_order_relaxed); }
+    ~AtomicCountable() { count_.fetch_sub(1, std::memory_order_relaxed); }
+    static size_t get_count() { return static_cast<size_t>(count_.load(std::memory_order_relaxed)); }
+};
+
+// Mixin 5: 堆分配追踪（类专属 operator new/delete）
+template<typename Derived, bool Enabled = kTelemetryEnabled>
+class AllocationTracked {
+    inline static ShardedCounter<> allocations_;
+    inline static ShardedCounter<> bytes_;
+public:
+    static void* operator new(size_t size) {
+        allocations_.add(1);
+        bytes_.add(static_cast<int64_t>(size));
+        return ::operator new(size);
+    }
+
+    static void operator delete(void* p, size_t size) {
+        allocations_.add(-1);
+        bytes_.add(-static_cast<int64_t>(size));
+        ::operator delete(p);
+    }
+
+    static size_t live_allocations() { return static_cast<size_t>(allocations_.sum()); }
+    static size_t live_bytes() { return static_cast<size_t>(bytes_.sum()); }
+};
+
+template<typename Derived>
+class AllocationTracked<Derived, false> {
+public:
+    static size_t live_allocations() { return 0; }
+    static size_t live_bytes() { return 0; }
+};
+
+// Mixin 6: 延迟采样（每 SampleEvery 次调用计时一次，避免每次都读时钟）
+template<typename Derived, bool Enabled = kTelemetryEnabled, size_t SampleEvery = 1024>
+class LatencySampled {
+    inline static ShardedCounter<> samples_;
+    inline static ShardedCounter<> total_ns_;
+public:
+    template<typename F>
+    decltype(auto) timed(F&& f) const {
+        thread_local size_t calls = 0;
+        if (++calls % SampleEvery != 0) {
+            return std::forward<F>(f)();
+        }
+        auto start = std::chrono::steady_clock::now();
+        struct Record {
+            std::chrono::steady_clock::time_point start;
+            ~Record() {
+                samples_.add(1);
+                total_ns_.add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+        } record{ start };
+        return std::forward<F>(f)();
+    }
+
+    static size_t sample_count() { return static_cast<size_t>(samples_.sum()); }
+    static double mean_latency_ns() {
+        int64_t n = samples_.sum();
+        return n > 0 ? static_cast<double>(total_ns_.sum()) / n : 0.0;
+    }
+};
+
+template<typename Derived, size_t SampleEvery>
+class LatencySampled<Derived, false, SampleEvery> {
+public:
+    template<typename F>
+    decltype(auto) timed(F&& f) const { return std::forward<F>(f)(); }
+
+    static size_t sample_count() { return 0; }
+    static double mean_latency_ns() { return 0.0; }
+};
+
+// 组合使用：生产环境开启遥测的订单对象
+class Order : public ShardedCountable<Order>,
+              public AllocationTracked<Order>,
+              public LatencySampled<Order> {
+    double price_;
+    int quantity_;
+public:
+    Order(double price, int quantity) : price_(price), quantity_(quantity) {}
+    double notional() const { return timed([this] { return price_ * quantity_; }); }
+};
+
+// 同一个类型，遥测全部关闭
+class OrderNoTelemetry : public ShardedCountable<OrderNoTelemetry, false>,
+                         public AllocationTracked<OrderNoTelemetry, false>,
+                         public LatencySampled<OrderNoTelemetry, false> {
+    double price_;
+    int quantity_;
+public:
+    OrderNoTelemetry(double price, int quantity) : price_(price), quantity_(quantity) {}
+    double notional() const { return timed([this] { return price_ * quantity_; }); }
+};
+
+// 零开销验证：关闭后对象大小与不带 Mixin 的裸结构相同
+struct OrderPlain { double price; int quantity; };
+static_assert(sizeof(OrderNoTelemetry) == sizeof(OrderPlain));
+static_assert(sizeof(Order) == sizeof(OrderPlain));  // 计数器是 static，不进入对象
+
 // ============================================================================
 // 第三部分：编译期接口检查（C++20 Concepts）
 // ============================================================================
@@ -137,14 +395,73 @@ concept Shape = requires(const T& t) {
     { t.perimeter() } -> std::convertible_to<double>;
 };
 
-// 通用算法，只接受满足 Shape concept 的类型
+// 分块批量求值：面积缓冲区常驻 L1，输入只被流式读取一次。
+// fill(base, areas) 写入 [base, base + areas.size()) 的面积
+template<typename Fill>
+double blocked_area_sum(size_t count, Fill fill) {
+    constexpr size_t BLOCK = 512;
+    std::array<double, BLOCK> areas;
+    double acc[4] = {};  // 多个累加器，打破加法依赖链
+    for (size_t base = 0; base < count; base += BLOCK) {
+        const size_t n = std::min(BLOCK, count - base);
+        fill(base, std::span<double>(areas.data(), n));
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            acc[0] += areas[i];
+            acc[1] += areas[i + 1];
+            acc[2] += areas[i + 2];
+            acc[3] += areas[i + 3];
+        }
+        for (; i < n; ++i) {
+            acc[0] += areas[i];
+        }
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// 通用算法，只接受满足 Shape concept 的类型。
+// AoS 数据没有可直接向量化加载的列，拷贝成列得不偿失：求面积与累加融合成一趟，
+// 用与 blocked_area_sum 相同的 4 路累加器打破依赖链（累加顺序一致，结果逐位相同）
 template<Shape S>
 double total_area(const std::vector<S>& shapes) {
-    double sum = 0.0;
-    for (const auto& shape : shapes) {
-        sum += shape.area();
+    const size_t n = shapes.size();
+    double acc[4] = {};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc[0] += shapes[i].area();
+        acc[1] += shapes[i + 1].area();
+        acc[2] += shapes[i + 2].area();
+        acc[3] += shapes[i + 3].area();
     }
-    return sum;
+    for (; i < n; ++i) {
+        acc[0] += shapes[i].area();
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// 旧的 AoS 批量路径（先拷贝成列再走 SIMD 内核），仅用于测试 7 的前后对照
+template<Shape S>
+double total_area_gathered(const std::vector<S>& shapes) {
+    return blocked_area_sum(shapes.size(), [&](size_t base, std::span<double> areas) {
+        S::area_batch_gather(std::span<const S>(shapes).subspan(base, areas.size()), areas);
+    });
+}
+
+// SoA 容器：字段本身就是连续列，直接分块送入 SIMD 内核
+
+double total_area(const CircleSoA& shapes) {
+    return blocked_area_sum(shapes.size(), [&](size_t base, std::span<double> areas) {
+        CircleCRTP::area_batch_soa(std::span<const double>(shapes.radius).subspan(base, areas.size()),
+                                   areas);
+    });
+}
+
+double total_area(const RectangleSoA& shapes) {
+    return blocked_area_sum(shapes.size(), [&](size_t base, std::span<double> areas) {
+        RectangleCRTP::area_batch_soa(
+            std::span<const double>(shapes.width).subspan(base, areas.size()),
+            std::span<const double>(shapes.height).subspan(base, areas.size()), areas);
+    });
 }
 
 // ============================================================================
@@ -240,6 +557,63 @@ VecSum<E1, E2> operator+(const VecExpression<E1>& lhs, const VecExpression<E2>&
     return VecSum<E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
 }
 
+// ============================================================================
+// 第六部分：异构容器 - 按类型分桶存储（Type-Partitioned Storage）
+// ============================================================================
+
+// 每种具体类型一个连续的 vector，遍历时逐桶展开：
+// 桶内类型已知 → area() 完全内联，无虚表、无分支、可向量化
+// 代价：不保留跨类型的插入顺序（面积求和这类与顺序无关的操作不受影响）
+template<Shape... Shapes>
+class ShapeBuckets {
+    std::tuple<std::vector<Shapes>...> buckets_;
+public:
+    template<typename S, typename... Args>
+    S& emplace(Args&&... args) {
+        return std::get<std::vector<S>>(buckets_).emplace_back(std::forward<Args>(args)...);
+    }
+
+    template<typename S>
+    std::vector<S>& bucket() { return std::get<std::vector<S>>(buckets_); }
+
+    template<typename S>
+    const std::vector<S>& bucket() const { return std::get<std::vector<S>>(buckets_); }
+
+    size_t size() const {
+        return std::apply([](const auto&... b) { return (b.size() + ... + 0); }, buckets_);
+    }
+
+    void reserve(size_t n) {
+        std::apply([n](auto&... b) { (b.reserve(n), ...); }, buckets_);
+    }
+
+    // 折叠表达式：为每个桶生成一个独立的、类型确定的循环
+    template<typename F>
+    void for_each(F&& f) const {
+        std::apply([&f](const auto&... b) {
+            ([&f](const auto& bucket) {
+                for (const auto& shape : bucket) f(shape);
+            }(b), ...);
+        }, buckets_);
+    }
+
+    // 逐桶调用 ::total_area，每个桶是一个类型确定的融合循环
+    double total_area() const {
+        return std::apply([](const auto&... b) { return (::total_area(b) + ... + 0.0); },
+                          buckets_);
+    }
+};
+
+// 对照组：std::variant 保留插入顺序，每个元素一次 visit（跳转表分派）
+template<Shape... Shapes>
+double total_area(const std::vector<std::variant<Shapes...>>& shapes) {
+    double sum = 0.0;
+    for (const auto& shape : shapes) {
+        sum += std::visit([](const auto& s) { return s.area(); }, shape);
+    }
+    return sum;
+}
+
 // ============================================================================
 // 性能测试
 // ============================================================================
@@ -377,6 +751,288 @@ int main() {
     }
     std::cout << "\n\n";
 
+    // ========================================
+    // 测试 6: 异构容器（混合类型）
+    // ========================================
+    std::cout << "Test 6: Heterogeneous Shapes (shuffled circle/rectangle mix)\n";
+    std::cout << "------------------------------------------------\n";
+
+    constexpr size_t MIXED_N = 1'000'000;
+    constexpr int MIXED_REPS = 20;
+    using ShapeVariant = std::variant<CircleCRTP, RectangleCRTP>;
+    bool for_each_ok = true;
+
+    for (double circle_ratio : { 0.1, 0.5, 0.9 }) {
+        // 随机类型序列：虚函数与 variant 的分派分支无法预测
+        std::mt19937 rng(42);
+        std::bernoulli_distribution is_circle(circle_ratio);
+        std::vector<bool> kinds(MIXED_N);
+        for (size_t i = 0; i < MIXED_N; ++i) kinds[i] = is_circle(rng);
+
+        std::vector<std::unique_ptr<ShapeVirtual>> mixed_virtual;
+        std::vector<ShapeVariant> mixed_variant;
+        ShapeBuckets<CircleCRTP, RectangleCRTP> mixed_buckets;
+        mixed_virtual.reserve(MIXED_N);
+        mixed_variant.reserve(MIXED_N);
+        for (bool circle : kinds) {
+            if (circle) {
+                mixed_virtual.push_back(std::make_unique<CircleVirtual>(5.0));
+                mixed_variant.emplace_back(CircleCRTP(5.0));
+                mixed_buckets.emplace<CircleCRTP>(5.0);
+            } else {
+                mixed_virtual.push_back(std::make_unique<RectangleVirtual>(4.0, 6.0));
+                mixed_variant.emplace_back(RectangleCRTP(4.0, 6.0));
+                mixed_buckets.emplace<RectangleCRTP>(4.0, 6.0);
+            }
+        }
+
+        std::cout << "Circle ratio " << static_cast<int>(circle_ratio * 100) << "%:\n";
+        double mixed_virtual_time = benchmark("  Virtual (unique_ptr)", [&]() {
+            double sum = 0.0;
+            for (int rep = 0; rep < MIXED_REPS; ++rep) {
+                for (const auto& shape : mixed_virtual) sum += shape->area();
+                asm volatile("" : : : "memory");
+            }
+            asm volatile("" : : "r,m"(sum) : "memory");
+        }, MIXED_N * MIXED_REPS);
+
+        double mixed_variant_time = benchmark("  std::variant + visit", [&]() {
+            double sum = 0.0;
+            for (int rep = 0; rep < MIXED_REPS; ++rep) {
+                sum += total_area(mixed_variant);
+                asm volatile("" : : : "memory");  // 阻止把循环不变的求和提到循环外
+            }
+            asm volatile("" : : "r,m"(sum) : "memory");
+        }, MIXED_N * MIXED_REPS);
+
+        double mixed_bucket_time = benchmark("  Type-partitioned buckets", [&]() {
+            double sum = 0.0;
+            for (int rep = 0; rep < MIXED_REPS; ++rep) {
+                sum += mixed_buckets.total_area();
+                asm volatile("" : : : "memory");
+            }
+            asm volatile("" : : "r,m"(sum) : "memory");
+        }, MIXED_N * MIXED_REPS);
+
+        // for_each：任意逐元素操作（这里是周长），每个桶展开为一个类型确定的循环
+        double virtual_perimeter = 0.0, bucket_perimeter = 0.0;
+        for (const auto& shape : mixed_virtual) virtual_perimeter += shape->perimeter();
+        benchmark("  Buckets for_each (perimeter)", [&]() {
+            double sum = 0.0;
+            for (int rep = 0; rep < MIXED_REPS; ++rep) {
+                mixed_buckets.for_each([&sum](const auto& shape) { sum += shape.perimeter(); });
+                asm volatile("" : : : "memory");
+            }
+            asm volatile("" : : "r,m"(sum) : "memory");
+        }, MIXED_N * MIXED_REPS);
+        size_t visited = 0;
+        mixed_buckets.for_each([&](const auto& shape) {
+            bucket_perimeter += shape.perimeter();
+            ++visited;
+        });
+        // 求和顺序不同（按桶 vs 按插入顺序），只允许舍入量级的差异
+        for_each_ok = for_each_ok && visited == MIXED_N &&
+                      std::abs(bucket_perimeter - virtual_perimeter) <= 1e-9 * virtual_perimeter;
+
+        std::cout << "  Speedup vs virtual: variant " << (mixed_virtual_time / mixed_variant_time)
+                  << "x, buckets " << (mixed_virtual_time / mixed_bucket_time) << "x\n";
+    }
+    std::cout << (for_each_ok ? "✓" : "✗") << " ShapeBuckets::for_each visits every shape; perimeter sum "
+              << (for_each_ok ? "matches the virtual version" : "MISMATCH!") << "\n\n";
+
+    // ========================================
+    // 测试 7: 批量 SIMD 求值
+    // ========================================
+    std::cout << "Test 7: Batch Evaluation (SoA SIMD batch vs AoS loops)\n";
+    std::cout << "------------------------------------------------\n";
+
+    constexpr size_t BATCH_N = 10'000'000;
+    constexpr int BATCH_REPS = 5;
+    std::mt19937 batch_rng(7);
+    std::uniform_real_distribution<double> extent(0.5, 10.0);
+    std::vector<CircleCRTP> many_circles;
+    std::vector<RectangleCRTP> many_rectangles;
+    many_circles.reserve(BATCH_N);
+    many_rectangles.reserve(BATCH_N);
+    for (size_t i = 0; i < BATCH_N; ++i) {
+        many_circles.emplace_back(extent(batch_rng));
+        many_rectangles.emplace_back(extent(batch_rng), extent(batch_rng));
+    }
+    // 同一组数据的 SoA 副本：半径 / 宽 / 高各一个连续数组
+    CircleSoA soa_circles;
+    RectangleSoA soa_rectangles;
+    soa_circles.radius.reserve(BATCH_N);
+    soa_rectangles.width.reserve(BATCH_N);
+    soa_rectangles.height.reserve(BATCH_N);
+    for (size_t i = 0; i < BATCH_N; ++i) {
+        soa_circles.push_back(many_circles[i]);
+        soa_rectangles.push_back(many_rectangles[i]);
+    }
+
+    auto per_object_sum = [](const auto& shapes) {
+        double sum = 0.0;
+        for (const auto& shape : shapes) sum += shape.area();
+        return sum;
+    };
+    auto report_bandwidth = [](double ns_per_shape, size_t bytes_per_shape) {
+        std::cout << "    -> " << bytes_per_shape / ns_per_shape << " GB/s\n";
+    };
+
+    double circle_scalar = benchmark("Circles: per-object area()", [&]() {
+        double sum = 0.0;
+        for (int rep = 0; rep < BATCH_REPS; ++rep) {
+            sum += per_object_sum(many_circles);
+            asm volatile("" : : : "memory");
+        }
+        asm volatile("" : : "r,m"(sum) : "memory");
+    }, BATCH_N * BATCH_REPS);
+    report_bandwidth(circle_scalar, sizeof(CircleCRTP));
+
+    double circle_gather = benchmark("Circles: AoS gather + SIMD (before)", [&]() {
+        double sum = 0.0;
+        for (int rep = 0; rep < BATCH_REPS; ++rep) {
+            sum += total_area_gathered(many_circles);
+            asm volatile("" : : : "memory");
+        }
+        asm volatile("" : : "r,m"(sum) : "memory");
+    }, BATCH_N * BATCH_REPS);
+    report_bandwidth(circle_gather, sizeof(CircleCRTP));
+
+    double circle_batch = benchmark("Circles: total_area AoS fused loop (after)", [&]() {
+        double sum = 0.0;
+        for (int rep = 0; rep < BATCH_REPS; ++rep) {
+            sum += total_area(many_circles);
+            asm volatile("" : : : "memory");
+        }
+        asm volatile("" : : "r,m"(sum) : "memory");
+    }, BATCH_N * BATCH_REPS);
+    report_bandwidth(circle_batch, sizeof(CircleCRTP));
+
+    double circle_soa = benchmark("Circles: total_area (SoA radius span)", [&]() {
+        double sum = 0.0;
+        for (int rep = 0; rep < BATCH_REPS; ++rep) {
+            sum += total_area(soa_circles);
+            asm volatile("" : : : "memory");
+        }
+        asm volatile("" : : "r,m"(sum) : "memory");
+    }, BATCH_N * BATCH_REPS);
+    report_bandwidth(circle_soa, sizeof(double));
+
+    double rect_scalar = benchmark("Rectangles: per-object area()", [&]() {
+        double sum = 0.0;
+        for (int rep = 0; rep < BATCH_REPS; ++rep) {
+            sum += per_object_sum(many_rectangles);
+            asm volatile("" : : : "memory");
+        }
+        asm volatile("" : : "r,m"(sum) : "memory");
+    }, BATCH_N * BATCH_REPS);
+    report_bandwidth(rect_scalar, sizeof(RectangleCRTP));
+
+    double rect_gather = benchmark("Rectangles: AoS gather + SIMD (before)", [&]() {
+        double sum = 0.0;
+        for (int rep = 0; rep < BATCH_REPS; ++rep) {
+            sum += total_area_gathered(many_rectangles);
+            asm volatile("" : : : "memory");
+        }
+        asm volatile("" : : "r,m"(sum) : "memory");
+    }, BATCH_N * BATCH_REPS);
+    report_bandwidth(rect_gather, sizeof(RectangleCRTP));
+
+    double rect_batch = benchmark("Rectangles: total_area AoS fused loop (after)", [&]() {
+        double sum = 0.0;
+        for (int rep = 0; rep < BATCH_REPS; ++rep) {
+            sum += total_area(many_rectangles);
+            asm volatile("" : : : "memory");
+        }
+        asm volatile("" : : "r,m"(sum) : "memory");
+    }, BATCH_N * BATCH_REPS);
+    report_bandwidth(rect_batch, sizeof(RectangleCRTP));
+
+    double rect_soa = benchmark("Rectangles: total_area (SoA w/h spans)", [&]() {
+        double sum = 0.0;
+        for (int rep = 0; rep < BATCH_REPS; ++rep) {
+            sum += total_area(soa_rectangles);
+            asm volatile("" : : : "memory");
+        }
+        asm volatile("" : : "r,m"(sum) : "memory");
+    }, BATCH_N * BATCH_REPS);
+    report_bandwidth(rect_soa, 2 * sizeof(double));
+
+    std::cout << "\nSpeedup vs per-object: circles " << (circle_scalar / circle_batch)
+              << "x (AoS fused), " << (circle_scalar / circle_soa) << "x (SoA); rectangles "
+              << (rect_scalar / rect_batch) << "x (AoS fused), " << (rect_scalar / rect_soa)
+              << "x (SoA)\n";
+    std::cout << "AoS after vs before (fused loop vs gather + SIMD): circles "
+              << (circle_gather / circle_batch) << "x, rectangles " << (rect_gather / rect_batch)
+              << "x\n";
+    // 三条路径的面积公式与 4 路累加顺序相同，结果应逐位一致
+    const bool batch_match =
+        total_area(many_circles) == total_area(soa_circles) &&
+        total_area_gathered(many_circles) == total_area(soa_circles) &&
+        total_area(many_rectangles) == total_area(soa_rectangles) &&
+        total_area_gathered(many_rectangles) == total_area(soa_rectangles);
+    std::cout << (batch_match ? "✓" : "✗") << " AoS fused, AoS gather and SoA batch totals "
+              << (batch_match ? "identical" : "MISMATCH!") << "\n\n";
+
+    // ========================================
+    // 测试 8: 线程安全遥测 Mixin
+    // ========================================
+    std::cout << "Test 8: Thread-safe Telemetry Mixins\n";
+    std::cout << "------------------------------------------------\n";
+
+    const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+    constexpr int OBJECTS_PER_THREAD = 2'000'000;
+
+    struct AtomicCounted : AtomicCountable<AtomicCounted> { double value = 1.0; };
+    struct ShardCounted : ShardedCountable<ShardCounted, true> { double value = 1.0; };
+
+    // 每个线程反复构造/析构对象，并保持一批存活对象
+    auto churn = [&](auto tag) {
+        using T = typename decltype(tag)::type;
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([] {
+                std::vector<T> live(1000);
+                for (int i = 0; i < OBJECTS_PER_THREAD; ++i) {
+                    T temp;
+                    asm volatile("" : : "r,m"(temp.value) : "memory");
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    };
+    const size_t churn_calls = static_cast<size_t>(threads) * OBJECTS_PER_THREAD;
+
+    double atomic_time = benchmark("Shared atomic counter", [&]() {
+        churn(std::type_identity<AtomicCounted>{});
+    }, churn_calls);
+    double sharded_time = benchmark("Per-thread sharded counter", [&]() {
+        churn(std::type_identity<ShardCounted>{});
+    }, churn_calls);
+    std::cout << "Threads: " << threads << ", speedup: " << (atomic_time / sharded_time) << "x\n";
+    std::cout << "Live objects after join: atomic=" << AtomicCounted::get_count()
+              << ", sharded=" << ShardCounted::get_count() << " (both must be 0)\n";
+
+    {
+        std::vector<std::unique_ptr<Order>> orders;
+        for (int i = 0; i < 5000; ++i) orders.push_back(std::make_unique<Order>(100.0 + i, 10));
+        double notional = 0.0;
+        for (int rep = 0; rep < 100; ++rep) {
+            for (const auto& o : orders) notional += o->notional();
+        }
+        asm volatile("" : : "r,m"(notional) : "memory");
+        std::cout << "Order: live=" << Order::get_count()
+                  << ", heap allocations=" << Order::live_allocations()
+                  << " (" << Order::live_bytes() << " bytes)"
+                  << ", latency samples=" << Order::sample_count() << "\n";
+    }
+    std::cout << "Order after scope: live=" << Order::get_count()
+              << ", heap allocations=" << Order::live_allocations() << "\n";
+    std::cout << "sizeof(Order)=" << sizeof(Order)
+              << ", sizeof(OrderNoTelemetry)=" << sizeof(OrderNoTelemetry)
+              << ", telemetry " << (kTelemetryEnabled ? "enabled" : "disabled (-DNO_TELEMETRY)")
+              << "\n\n";
+
     // ========================================
     // 内存占用分析
     // ========================================
@@ -385,7 +1041,9 @@ int main() {
     std::cout << "ShapeVirtual:    " << sizeof(ShapeVirtual) << " bytes (vtable pointer)\n";
     std::cout << "CircleVirtual:   " << sizeof(CircleVirtual) << " bytes\n";
     std::cout << "ShapeCRTP:       " << sizeof(ShapeCRTP<CircleCRTP>) << " bytes (empty)\n";
-    std::cout << "CircleCRTP:      " << sizeof(CircleCRTP) << " bytes (no overhead!)\n\n";
+    std::cout << "CircleCRTP:      " << sizeof(CircleCRTP) << " bytes (no overhead!)\n";
+    std::cout << "ShapeVariant:    " << sizeof(std::variant<CircleCRTP, RectangleCRTP>)
+              << " bytes (largest alternative + index)\n\n";
 
     std::cout << "================================================\n";
     std::cout << "Summary\n";
@@ -402,6 +1060,8 @@ int main() {
     std::cout << "✓ 选择建议:\n";
     std::cout << "  - 性能关键路径 + 编译期已知类型 → CRTP\n";
     std::cout << "  - 需要真正运行时多态 → Virtual Function\n";
+    std::cout << "  - 类型集合封闭 + 顺序无关 → 按类型分桶（ShapeBuckets）\n";
+    std::cout << "  - 类型集合封闭 + 需保序 → std::variant\n";
     std::cout << "  - 库/框架设计 → 混合使用\n";
     std::cout << "================================================\n";
 
@@ -411,13 +1071,16 @@ int main() {
 /* 编译与运行:
 
 基础版本:
-  g++ -std=c++20 -O2 crtp_complete_guide.cpp -o crtp_demo
+  g++ -std=c++20 -O2 -pthread crtp_complete_guide.cpp -o crtp_demo
   ./crtp_demo
 
 优化版本:
-  g++ -std=c++20 -O3 -march=native crtp_complete_guide.cpp -o crtp_demo_opt
+  g++ -std=c++20 -O3 -march=native -pthread crtp_complete_guide.cpp -o crtp_demo_opt
   ./crtp_demo_opt
 
+关闭遥测 Mixin（ShardedCountable / AllocationTracked / LatencySampled 全部变为空基类）:
+  g++ -std=c++20 -O3 -march=native -pthread -DNO_TELEMETRY crtp_complete_guide.cpp -o crtp_demo_notel
+
 查看内联情况:
   g++ -std=c++20 -O3 -march=native -S crtp_complete_guide.cpp
   # 查看生成的汇编代码，CRTP 方法应该完全内联
@@ -426,6 +1089,11 @@ int main() {
   - Virtual function: ~2-5 ns per call
   - CRTP (monomorphic): ~0.3-0.8 ns per call (内联后接近 0)
   - Speedup: 4-10x
+  - 混合类型（随机顺序）: 分桶 > variant > virtual，分桶通常快 5-15x
+  - ShapeBuckets::for_each 对任意逐元素操作（周长）同样按桶展开，结果与虚函数版本一致（✓）
+  - 批量求值（10M 对象）: 逐对象单累加器受加法依赖链限制；AoS 融合 4 路累加
+    比旧的"拷贝成列 + SIMD"路径快（after/before > 1x）；SoA 列直接进 SIMD 内核，接近内存带宽
+  - 多线程计数: 共享原子变量随线程数线性变慢，分片计数器基本不受线程数影响
   
 关键点:
   1. CRTP 的函数调用在 -O3 下完全内联
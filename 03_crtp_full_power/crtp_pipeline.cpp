@@ -0,0 +1,287 @@
+// crtp_pipeline.cpp
+// CRTP + 变参模板的静态处理流水线：Pipeline<Decode, Filter, Transform, Encode>
+// 所有阶段在编译期串联成一个循环，无虚调用、无中间缓冲区；与 std::function 链对比
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <tuple>
+#include <span>
+#include <cstdint>
+#include <iomanip>
+#include <utility>
+
+// ============================================================================
+// Part 1: 阶段基类与流水线
+// ============================================================================
+
+// 每个阶段实现 process_impl(in, next)：对一个输入元素做处理，
+// 调用 next(out) 零次（过滤）、一次（变换）或多次（展开）把结果推给下一阶段。
+// 输入输出类型可以逐阶段变化。
+template<typename Derived>
+class Stage {
+public:
+    template<typename In, typename Next>
+    void process(In&& in, Next&& next) const {
+        static_cast<const Derived*>(this)->process_impl(std::forward<In>(in),
+                                                        std::forward<Next>(next));
+    }
+};
+
+template<typename... Stages>
+class Pipeline {
+    std::tuple<Stages...> stages_;
+
+    // 递归展开为嵌套 lambda，-O2 下整条链内联进 process_batch 的循环体
+    template<size_t I, typename T, typename Sink>
+    void push(T&& value, Sink& sink) const {
+        if constexpr (I == sizeof...(Stages)) {
+            sink(std::forward<T>(value));
+        } else {
+            std::get<I>(stages_).process(std::forward<T>(value), [this, &sink](auto&& out) {
+                push<I + 1>(std::forward<decltype(out)>(out), sink);
+            });
+        }
+    }
+
+public:
+    Pipeline() = default;
+    explicit Pipeline(Stages... stages) : stages_(std::move(stages)...) {}
+
+    // 一个批次一个循环：元素从第一阶段一路推到 sink，中间结果只存在寄存器里
+    template<typename In, typename Sink>
+    void process_batch(std::span<const In> batch, Sink&& sink) const {
+        for (const In& item : batch) {
+            push<0>(item, sink);
+        }
+    }
+
+    static constexpr size_t stage_count() { return sizeof...(Stages); }
+};
+
+// ============================================================================
+// Part 2: 行情接入示例的四个阶段
+// ============================================================================
+
+// 线上格式：定点价格 + 数量 + 品种编号
+struct WireTick {
+    uint32_t price_ticks;   // 价格，单位 1/10000
+    int32_t quantity;
+    uint16_t symbol;
+};
+
+struct Tick {
+    double price;
+    int quantity;
+    int symbol;
+    double notional;
+};
+
+class Decode : public Stage<Decode> {
+public:
+    template<typename Next>
+    void process_impl(const WireTick& w, Next&& next) const {
+        next(Tick{ w.price_ticks * 1e-4, w.quantity, w.symbol, 0.0 });
+    }
+};
+
+class Filter : public Stage<Filter> {
+    double min_price_, max_price_;
+public:
+    Filter(double min_price, double max_price) : min_price_(min_price), max_price_(max_price) {}
+
+    template<typename Next>
+    void process_impl(const Tick& t, Next&& next) const {
+        if (t.quantity > 0 && t.price >= min_price_ && t.price <= max_price_) {
+            next(t);
+        }
+    }
+};
+
+class Transform : public Stage<Transform> {
+    double fx_rate_;
+public:
+    explicit Transform(double fx_rate) : fx_rate_(fx_rate) {}
+
+    template<typename Next>
+    void process_impl(Tick t, Next&& next) const {
+        t.notional = t.price * t.quantity * fx_rate_;
+        next(t);
+    }
+};
+
+class Encode : public Stage<Encode> {
+public:
+    // 输出：名义金额（分）与品种编号打包进一个 int64
+    template<typename Next>
+    void process_impl(const Tick& t, Next&& next) const {
+        int64_t cents = static_cast<int64_t>(t.notional * 100.0);
+        next((cents << 16) | t.symbol);
+    }
+};
+
+// ============================================================================
+// Part 3: 对照组 - std::function 阶段链
+// ============================================================================
+
+// 3.1 逐元素：每个元素经过 4 次间接调用
+struct FunctionChain {
+    std::function<Tick(const WireTick&)> decode;
+    std::function<bool(const Tick&)> filter;
+    std::function<Tick(Tick)> transform;
+    std::function<int64_t(const Tick&)> encode;
+
+    void process_batch(std::span<const WireTick> batch, std::vector<int64_t>& out) const {
+        for (const WireTick& w : batch) {
+            Tick t = decode(w);
+            if (!filter(t)) continue;
+            out.push_back(encode(transform(t)));
+        }
+    }
+};
+
+// 3.2 逐阶段：每个阶段处理整批并物化中间结果
+struct StagedFunctionChain {
+    FunctionChain fn;
+    mutable std::vector<Tick> decoded, filtered;
+
+    void process_batch(std::span<const WireTick> batch, std::vector<int64_t>& out) const {
+        decoded.clear();
+        filtered.clear();
+        for (const WireTick& w : batch) decoded.push_back(fn.decode(w));
+        for (const Tick& t : decoded) if (fn.filter(t)) filtered.push_back(fn.transform(t));
+        for (const Tick& t : filtered) out.push_back(fn.encode(t));
+    }
+};
+
+// ============================================================================
+// 性能测试
+// ============================================================================
+
+template<typename Func>
+double benchmark(const std::string& name, Func func, int iterations = 20) {
+    func();  // 预热
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    std::cout << std::left << std::setw(40) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(3)
+              << ms << " ms" << std::endl;
+    return ms;
+}
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+int main() {
+    constexpr size_t N = 4'000'000;
+    constexpr size_t BATCH = 4096;
+    constexpr double MIN_PRICE = 10.0, MAX_PRICE = 900.0, FX = 7.1;
+
+    std::cout << "================================================\n";
+    std::cout << "  CRTP Static Pipeline vs std::function Chain\n";
+    std::cout << "================================================\n";
+    std::cout << "Ticks: " << N << ", batch size: " << BATCH << "\n";
+    std::cout << "Stages: Decode -> Filter -> Transform -> Encode\n";
+    std::cout << "================================================\n\n";
+
+    // 约 20% 的数据会被过滤掉（数量非正或价格越界）
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> price(50'000, 10'000'000);
+    std::uniform_int_distribution<int32_t> qty(-10, 100);
+    std::uniform_int_distribution<int> symbol(0, 4095);
+    std::vector<WireTick> input(N);
+    for (auto& w : input) {
+        w = { price(rng), qty(rng), static_cast<uint16_t>(symbol(rng)) };
+    }
+
+    Pipeline<Decode, Filter, Transform, Encode> pipeline(
+        Decode{}, Filter(MIN_PRICE, MAX_PRICE), Transform(FX), Encode{});
+
+    FunctionChain chain{
+        [](const WireTick& w) { return Tick{ w.price_ticks * 1e-4, w.quantity, w.symbol, 0.0 }; },
+        [](const Tick& t) { return t.quantity > 0 && t.price >= MIN_PRICE && t.price <= MAX_PRICE; },
+        [](Tick t) { t.notional = t.price * t.quantity * FX; return t; },
+        [](const Tick& t) {
+            return (static_cast<int64_t>(t.notional * 100.0) << 16) | t.symbol;
+        }
+    };
+    StagedFunctionChain staged{ chain, {}, {} };
+
+    std::vector<int64_t> out_static, out_fn, out_staged;
+    out_static.reserve(N);
+    out_fn.reserve(N);
+    out_staged.reserve(N);
+    std::span<const WireTick> all(input);
+
+    auto run_batches = [&](auto&& process) {
+        for (size_t base = 0; base < N; base += BATCH) {
+            process(all.subspan(base, std::min(BATCH, N - base)));
+        }
+    };
+
+    double static_time = benchmark("CRTP Pipeline (fused)", [&]() {
+        out_static.clear();
+        run_batches([&](std::span<const WireTick> batch) {
+            pipeline.process_batch(batch, [&](int64_t v) { out_static.push_back(v); });
+        });
+    });
+
+    double fn_time = benchmark("std::function chain (per element)", [&]() {
+        out_fn.clear();
+        run_batches([&](std::span<const WireTick> batch) { chain.process_batch(batch, out_fn); });
+    });
+
+    double staged_time = benchmark("std::function chain (per stage)", [&]() {
+        out_staged.clear();
+        run_batches([&](std::span<const WireTick> batch) { staged.process_batch(batch, out_staged); });
+    });
+
+    bool same = out_static == out_fn && out_static == out_staged;
+    std::cout << "\nOutputs: " << out_static.size() << " records, "
+              << (same ? "identical across implementations" : "MISMATCH!") << "\n";
+    std::cout << "Throughput (fused): " << std::setprecision(1)
+              << N / (static_time * 1e3) << " M ticks/s\n";
+    std::cout << "Speedup vs per-element std::function: " << std::setprecision(2)
+              << (fn_time / static_time) << "x\n";
+    std::cout << "Speedup vs per-stage std::function:   "
+              << (staged_time / static_time) << "x\n\n";
+
+    std::cout << "================================================\n";
+    std::cout << "Summary\n";
+    std::cout << "================================================\n";
+    std::cout << "✓ CRTP Pipeline:\n";
+    std::cout << "  1. " << decltype(pipeline)::stage_count()
+              << " stages fused into one loop per batch\n";
+    std::cout << "  2. No indirect calls, no intermediate buffers\n";
+    std::cout << "  3. Stages may change type, filter (0 outputs) or expand (N outputs)\n\n";
+    std::cout << "✗ std::function chain:\n";
+    std::cout << "  1. One indirect call per stage per element, blocks inlining\n";
+    std::cout << "  2. Per-stage variant materializes every intermediate result\n";
+    std::cout << "================================================\n";
+
+    return same ? 0 : 1;
+}
+
+/* 编译与运行:
+
+  g++ -std=c++20 -O3 -march=native crtp_pipeline.cpp -o crtp_pipeline
+  ./crtp_pipeline
+
+查看融合效果:
+  g++ -std=c++20 -O3 -march=native -S crtp_pipeline.cpp
+  # process_batch 的循环体中应看不到对各阶段的 call 指令
+
+预期结果:
+  - CRTP Pipeline:             ~1-2 ns/tick
+  - std::function (逐元素):    ~5-8 ns/tick（4 次间接调用）
+  - std::function (逐阶段):    ~4-6 ns/tick（中间缓冲区的读写带宽）
+*/
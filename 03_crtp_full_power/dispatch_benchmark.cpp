@@ -0,0 +1,576 @@
+// dispatch_benchmark.cpp
+// 多态分派方式横向对比：virtual / final / CRTP / variant / 函数指针表 / SBO 类型擦除 /
+// std::function / function_ref
+// 每种方式分别在可预测（按类型成段）和不可预测（随机）类型序列上测量，
+// Linux 下用 perf_event_open 读取指令数与分支预测失败次数
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <variant>
+#include <functional>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <new>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// Part 1: 硬件计数器（不可用时静默降级）
+// ============================================================================
+
+struct CounterSample {
+    uint64_t instructions = 0;
+    uint64_t branch_misses = 0;
+};
+
+class PerfCounters {
+    int leader_ = -1;
+    int misses_ = -1;
+
+#ifdef __linux__
+    static int open_counter(uint64_t config, int group) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = (group == -1);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif
+
+public:
+    PerfCounters() {
+#ifdef __linux__
+        leader_ = open_counter(PERF_COUNT_HW_INSTRUCTIONS, -1);
+        if (leader_ >= 0) {
+            misses_ = open_counter(PERF_COUNT_HW_BRANCH_MISSES, leader_);
+            if (misses_ < 0) {
+                ::close(leader_);
+                leader_ = -1;
+            }
+        }
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        if (misses_ >= 0) ::close(misses_);
+        if (leader_ >= 0) ::close(leader_);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { return leader_ >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (!available()) return;
+        ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    CounterSample stop() {
+        CounterSample sample;
+#ifdef __linux__
+        if (!available()) return sample;
+        ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t values[3] = {};  // nr, instructions, branch-misses
+        if (::read(leader_, values, sizeof(values)) == sizeof(values)) {
+            sample.instructions = values[1];
+            sample.branch_misses = values[2];
+        }
+#endif
+        return sample;
+    }
+};
+
+// ============================================================================
+// Part 2: 各种分派方式下的同一组形状（圆、矩形、三角形）
+// ============================================================================
+
+// --- 2.1 虚函数 ---
+class ShapeVirtual {
+public:
+    virtual ~ShapeVirtual() = default;
+    virtual double area() const = 0;
+};
+
+class CircleVirtual : public ShapeVirtual {
+    double r_;
+public:
+    explicit CircleVirtual(double r) : r_(r) {}
+    double area() const override { return 3.14159 * r_ * r_; }
+};
+
+class RectangleVirtual : public ShapeVirtual {
+    double w_, h_;
+public:
+    RectangleVirtual(double w, double h) : w_(w), h_(h) {}
+    double area() const override { return w_ * h_; }
+};
+
+class TriangleVirtual : public ShapeVirtual {
+    double b_, h_;
+public:
+    TriangleVirtual(double b, double h) : b_(b), h_(h) {}
+    double area() const override { return 0.5 * b_ * h_; }
+};
+
+// --- 2.2 虚函数 + final：经基类指针调用时仍要查虚表；
+//         经 CircleFinal* 等具体类型指针调用时，编译器可以直接调用（去虚化）---
+class CircleFinal final : public ShapeVirtual {
+    double r_;
+public:
+    explicit CircleFinal(double r) : r_(r) {}
+    double area() const override { return 3.14159 * r_ * r_; }
+};
+
+class RectangleFinal final : public ShapeVirtual {
+    double w_, h_;
+public:
+    RectangleFinal(double w, double h) : w_(w), h_(h) {}
+    double area() const override { return w_ * h_; }
+};
+
+class TriangleFinal final : public ShapeVirtual {
+    double b_, h_;
+public:
+    TriangleFinal(double b, double h) : b_(b), h_(h) {}
+    double area() const override { return 0.5 * b_ * h_; }
+};
+
+// --- 2.3 CRTP（只能按类型分桶，序列顺序不再起作用）---
+template<typename Derived>
+class ShapeCRTP {
+public:
+    double area() const { return static_cast<const Derived*>(this)->area_impl(); }
+};
+
+class CircleCRTP : public ShapeCRTP<CircleCRTP> {
+    double r_;
+public:
+    explicit CircleCRTP(double r) : r_(r) {}
+    double area_impl() const { return 3.14159 * r_ * r_; }
+};
+
+class RectangleCRTP : public ShapeCRTP<RectangleCRTP> {
+    double w_, h_;
+public:
+    RectangleCRTP(double w, double h) : w_(w), h_(h) {}
+    double area_impl() const { return w_ * h_; }
+};
+
+class TriangleCRTP : public ShapeCRTP<TriangleCRTP> {
+    double b_, h_;
+public:
+    TriangleCRTP(double b, double h) : b_(b), h_(h) {}
+    double area_impl() const { return 0.5 * b_ * h_; }
+};
+
+// --- 2.4 值语义形状（供 variant / 类型擦除 / std::function 使用）---
+struct Circle {
+    double r;
+    double area() const { return 3.14159 * r * r; }
+};
+
+struct Rectangle {
+    double w, h;
+    double area() const { return w * h; }
+};
+
+struct Triangle {
+    double b, h;
+    double area() const { return 0.5 * b * h; }
+};
+
+using ShapeVariant = std::variant<Circle, Rectangle, Triangle>;
+
+// 把形状包装成可调用对象，供 std::function / function_ref 直接引用
+template<typename Shape>
+struct AreaOf {
+    Shape shape;
+    double operator()() const { return shape.area(); }
+};
+
+// --- 2.5 手写函数指针表：对象内联存储参数 + 指向静态表的指针 ---
+struct ShapeVTable {
+    double (*area)(const double* params);
+};
+
+inline constexpr ShapeVTable kCircleVTable    = { [](const double* p) { return 3.14159 * p[0] * p[0]; } };
+inline constexpr ShapeVTable kRectangleVTable = { [](const double* p) { return p[0] * p[1]; } };
+inline constexpr ShapeVTable kTriangleVTable  = { [](const double* p) { return 0.5 * p[0] * p[1]; } };
+
+struct ManualShape {
+    const ShapeVTable* vtable;
+    double params[2];
+    double area() const { return vtable->area(params); }
+};
+
+// --- 2.6 小缓冲区类型擦除（SBO）：任意带 area() 的类型，放得下就不分配堆内存 ---
+class AnyShape {
+    static constexpr size_t kBufferSize = 24;
+
+    struct Ops {
+        double (*area)(const void*);
+        void (*copy)(void* dst, const void* src);
+        void (*destroy)(void*);
+    };
+
+    template<typename T>
+    static constexpr bool fits_inline = sizeof(T) <= kBufferSize &&
+        alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_copy_constructible_v<T>;
+
+    template<typename T>
+    static const T* get(const void* storage) {
+        if constexpr (fits_inline<T>) {
+            return std::launder(static_cast<const T*>(storage));
+        } else {
+            return *static_cast<T* const*>(storage);
+        }
+    }
+
+    template<typename T>
+    static inline constexpr Ops kOps = {
+        [](const void* s) { return get<T>(s)->area(); },
+        [](void* dst, const void* src) {
+            if constexpr (fits_inline<T>) new (dst) T(*get<T>(src));
+            else *static_cast<T**>(dst) = new T(*get<T>(src));
+        },
+        [](void* s) {
+            if constexpr (fits_inline<T>) std::launder(static_cast<T*>(s))->~T();
+            else delete *static_cast<T**>(s);
+        }
+    };
+
+    alignas(std::max_align_t) unsigned char storage_[kBufferSize];
+    const Ops* ops_;
+
+public:
+    template<typename T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, AnyShape>>>
+    AnyShape(T shape) : ops_(&kOps<T>) {
+        if constexpr (fits_inline<T>) new (storage_) T(std::move(shape));
+        else *reinterpret_cast<T**>(storage_) = new T(std::move(shape));
+    }
+
+    AnyShape(const AnyShape& other) : ops_(other.ops_) { ops_->copy(storage_, other.storage_); }
+
+    AnyShape& operator=(const AnyShape& other) {
+        if (this != &other) {
+            ops_->destroy(storage_);
+            ops_ = other.ops_;
+            ops_->copy(storage_, other.storage_);
+        }
+        return *this;
+    }
+
+    ~AnyShape() { ops_->destroy(storage_); }
+
+    double area() const { return ops_->area(storage_); }
+};
+
+// --- 2.7 function_ref：非拥有的 (对象指针, 跳板函数) 二元组，不分配、不拷贝 ---
+template<typename Signature>
+class FunctionRef;
+
+template<typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+    const void* obj_;
+    R (*call_)(const void*, Args...);
+public:
+    template<typename F>
+    FunctionRef(const F& f)
+        : obj_(&f), call_([](const void* o, Args... args) -> R {
+              return (*static_cast<const F*>(o))(std::forward<Args>(args)...);
+          }) {}
+
+    R operator()(Args... args) const { return call_(obj_, std::forward<Args>(args)...); }
+};
+
+// ============================================================================
+// Part 3: 测试数据与测量
+// ============================================================================
+
+enum Kind : uint8_t { kCircle, kRectangle, kTriangle, kKindCount };
+
+// 可预测：按类型成段（分支预测器几乎不会失败）；不可预测：均匀随机
+std::vector<Kind> make_sequence(size_t n, bool predictable) {
+    std::vector<Kind> kinds(n);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, kKindCount - 1);
+    for (auto& k : kinds) k = static_cast<Kind>(pick(rng));
+    if (predictable) std::sort(kinds.begin(), kinds.end());
+    return kinds;
+}
+
+struct DispatchResult {
+    double ns_per_call = 0.0;
+    double instructions_per_call = -1.0;
+    double branch_misses_per_call = -1.0;
+};
+
+template<typename Func>
+DispatchResult measure(PerfCounters& counters, Func func, size_t calls) {
+    func();  // 预热
+    counters.start();
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+    CounterSample sample = counters.stop();
+
+    DispatchResult r;
+    r.ns_per_call = std::chrono::duration<double, std::nano>(end - start).count() / calls;
+    if (counters.available()) {
+        r.instructions_per_call = static_cast<double>(sample.instructions) / calls;
+        r.branch_misses_per_call = static_cast<double>(sample.branch_misses) / calls;
+    }
+    return r;
+}
+
+// 对一个序列建立所有表示，逐一测量
+struct DispatchSuite {
+    std::vector<std::unique_ptr<ShapeVirtual>> virtual_shapes;
+    std::vector<std::unique_ptr<ShapeVirtual>> final_shapes;
+    std::vector<std::unique_ptr<CircleFinal>> final_circles;
+    std::vector<std::unique_ptr<RectangleFinal>> final_rectangles;
+    std::vector<std::unique_ptr<TriangleFinal>> final_triangles;
+    std::vector<CircleCRTP> crtp_circles;
+    std::vector<RectangleCRTP> crtp_rectangles;
+    std::vector<TriangleCRTP> crtp_triangles;
+    std::vector<ShapeVariant> variants;
+    std::vector<ManualShape> manual;
+    std::vector<AnyShape> erased;
+    std::vector<std::function<double()>> functions;
+    std::vector<AreaOf<Circle>> ref_circles;
+    std::vector<AreaOf<Rectangle>> ref_rectangles;
+    std::vector<AreaOf<Triangle>> ref_triangles;
+    std::vector<FunctionRef<double()>> function_refs;
+
+    explicit DispatchSuite(const std::vector<Kind>& kinds) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> extent(0.5, 10.0);
+        const size_t n = kinds.size();
+        virtual_shapes.reserve(n);
+        final_shapes.reserve(n);
+        variants.reserve(n);
+        manual.reserve(n);
+        erased.reserve(n);
+        functions.reserve(n);
+        // function_ref 不拥有对象，引用的可调用对象必须地址稳定：按 n 预留，插入时不会重新分配
+        ref_circles.reserve(n);
+        ref_rectangles.reserve(n);
+        ref_triangles.reserve(n);
+        function_refs.reserve(n);
+
+        for (Kind k : kinds) {
+            double a = extent(rng), b = extent(rng);
+            switch (k) {
+                case kCircle:
+                    virtual_shapes.push_back(std::make_unique<CircleVirtual>(a));
+                    final_shapes.push_back(std::make_unique<CircleFinal>(a));
+                    final_circles.push_back(std::make_unique<CircleFinal>(a));
+                    crtp_circles.emplace_back(a);
+                    variants.emplace_back(Circle{ a });
+                    manual.push_back({ &kCircleVTable, { a, 0.0 } });
+                    erased.emplace_back(Circle{ a });
+                    functions.emplace_back(AreaOf<Circle>{ { a } });
+                    function_refs.emplace_back(ref_circles.emplace_back(AreaOf<Circle>{ { a } }));
+                    break;
+                case kRectangle:
+                    virtual_shapes.push_back(std::make_unique<RectangleVirtual>(a, b));
+                    final_shapes.push_back(std::make_unique<RectangleFinal>(a, b));
+                    final_rectangles.push_back(std::make_unique<RectangleFinal>(a, b));
+                    crtp_rectangles.emplace_back(a, b);
+                    variants.emplace_back(Rectangle{ a, b });
+                    manual.push_back({ &kRectangleVTable, { a, b } });
+                    erased.emplace_back(Rectangle{ a, b });
+                    functions.emplace_back(AreaOf<Rectangle>{ { a, b } });
+                    function_refs.emplace_back(ref_rectangles.emplace_back(AreaOf<Rectangle>{ { a, b } }));
+                    break;
+                default:
+                    virtual_shapes.push_back(std::make_unique<TriangleVirtual>(a, b));
+                    final_shapes.push_back(std::make_unique<TriangleFinal>(a, b));
+                    final_triangles.push_back(std::make_unique<TriangleFinal>(a, b));
+                    crtp_triangles.emplace_back(a, b);
+                    variants.emplace_back(Triangle{ a, b });
+                    manual.push_back({ &kTriangleVTable, { a, b } });
+                    erased.emplace_back(Triangle{ a, b });
+                    functions.emplace_back(AreaOf<Triangle>{ { a, b } });
+                    function_refs.emplace_back(ref_triangles.emplace_back(AreaOf<Triangle>{ { a, b } }));
+                    break;
+            }
+        }
+    }
+};
+
+template<typename Range, typename Call>
+double sum_over(const Range& range, Call call) {
+    double sum = 0.0;
+    for (const auto& item : range) sum += call(item);
+    return sum;
+}
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+int main() {
+    constexpr size_t N = 200'000;  // 约 5 MB，主要停留在 L2/L3
+    constexpr int REPS = 50;
+    constexpr size_t CALLS = N * REPS;
+
+    std::cout << "================================================\n";
+    std::cout << "  Dispatch Benchmark: 9 Polymorphism Styles\n";
+    std::cout << "================================================\n";
+    std::cout << "Shapes: " << N << " (circle/rectangle/triangle), reps: " << REPS << "\n";
+
+    PerfCounters counters;
+    std::cout << "Hardware counters: "
+              << (counters.available() ? "instructions, branch-misses (perf_event_open)"
+                                       : "unavailable (no PMU access, showing '-')")
+              << "\n";
+    std::cout << "================================================\n\n";
+
+    using Runner = double (*)(const DispatchSuite&);
+    struct Style {
+        const char* name;
+        Runner run;
+    };
+
+    // 每种方式一个无捕获 lambda，转换为函数指针后统一调用
+    const Style styles[] = {
+        { "virtual", [](const DispatchSuite& s) {
+            return sum_over(s.virtual_shapes, [](const auto& p) { return p->area(); }); } },
+        { "final via ShapeVirtual*", [](const DispatchSuite& s) {
+            return sum_over(s.final_shapes, [](const auto& p) { return p->area(); }); } },
+        { "final via Circle/..Final*", [](const DispatchSuite& s) {
+            auto area = [](const auto& p) { return p->area(); };  // 静态类型已知：去虚化
+            return sum_over(s.final_circles, area) + sum_over(s.final_rectangles, area)
+                 + sum_over(s.final_triangles, area); } },
+        { "CRTP (type buckets)", [](const DispatchSuite& s) {
+            auto area = [](const auto& shape) { return shape.area(); };
+            return sum_over(s.crtp_circles, area) + sum_over(s.crtp_rectangles, area)
+                 + sum_over(s.crtp_triangles, area); } },
+        { "std::variant + visit", [](const DispatchSuite& s) {
+            return sum_over(s.variants, [](const ShapeVariant& v) {
+                return std::visit([](const auto& shape) { return shape.area(); }, v); }); } },
+        { "function-pointer vtable", [](const DispatchSuite& s) {
+            return sum_over(s.manual, [](const ManualShape& m) { return m.area(); }); } },
+        { "SBO type erasure", [](const DispatchSuite& s) {
+            return sum_over(s.erased, [](const AnyShape& a) { return a.area(); }); } },
+        { "std::function", [](const DispatchSuite& s) {
+            return sum_over(s.functions, [](const auto& f) { return f(); }); } },
+        { "function_ref", [](const DispatchSuite& s) {
+            return sum_over(s.function_refs, [](const auto& f) { return f(); }); } },
+    };
+
+    DispatchSuite predictable(make_sequence(N, true));
+    DispatchSuite unpredictable(make_sequence(N, false));
+
+    auto cell = [](double value, int precision) {
+        std::ostringstream out;
+        if (value < 0.0) out << "-";
+        else out << std::fixed << std::setprecision(precision) << value;
+        return out.str();
+    };
+
+    std::cout << std::left << std::setw(26) << "Style"
+              << std::right << std::setw(12) << "pred ns" << std::setw(10) << "insn"
+              << std::setw(10) << "br-miss"
+              << std::setw(12) << "rand ns" << std::setw(10) << "insn"
+              << std::setw(10) << "br-miss" << "\n";
+    std::cout << std::string(90, '-') << "\n";
+
+    for (const Style& style : styles) {
+        DispatchResult results[2];
+        const DispatchSuite* suites[2] = { &predictable, &unpredictable };
+        for (int i = 0; i < 2; ++i) {
+            const DispatchSuite& suite = *suites[i];
+            Runner run = style.run;
+            results[i] = measure(counters, [&]() {
+                double sum = 0.0;
+                for (int rep = 0; rep < REPS; ++rep) {
+                    sum += run(suite);
+                    asm volatile("" : : : "memory");
+                }
+                asm volatile("" : : "r,m"(sum) : "memory");
+            }, CALLS);
+        }
+        std::cout << std::left << std::setw(26) << style.name << std::right;
+        for (const auto& r : results) {
+            std::cout << std::setw(12) << cell(r.ns_per_call, 3)
+                      << std::setw(10) << cell(r.instructions_per_call, 1)
+                      << std::setw(10) << cell(r.branch_misses_per_call, 3);
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "\nObject sizes:\n";
+    std::cout << "  CircleVirtual:  " << sizeof(CircleVirtual) << " bytes (+ heap header)\n";
+    std::cout << "  ShapeVariant:   " << sizeof(ShapeVariant) << " bytes\n";
+    std::cout << "  ManualShape:    " << sizeof(ManualShape) << " bytes\n";
+    std::cout << "  AnyShape (SBO): " << sizeof(AnyShape) << " bytes\n";
+    std::cout << "  std::function:  " << sizeof(std::function<double()>) << " bytes\n";
+    std::cout << "  FunctionRef:    " << sizeof(FunctionRef<double()>) << " bytes\n\n";
+
+    std::cout << "================================================\n";
+    std::cout << "How to pick\n";
+    std::cout << "================================================\n";
+    std::cout << "✓ Closed type set, order irrelevant  → CRTP / type buckets\n";
+    std::cout << "✓ Closed type set, order matters     → std::variant (inline storage, jump table)\n";
+    std::cout << "✓ Open type set, hot loop            → function-pointer vtable / SBO erasure\n";
+    std::cout << "✓ Callback parameter, no ownership   → function_ref\n";
+    std::cout << "✓ final + concrete-type pointers     → devirtualized (direct call, inlinable)\n";
+    std::cout << "✗ final through a base-class pointer → same vtable call as plain virtual\n";
+    std::cout << "✗ Random type order costs ~1 branch miss per call for every indirect style\n";
+    std::cout << "================================================\n";
+
+    return 0;
+}
+
+/* 编译与运行:
+
+  g++ -std=c++20 -O3 -march=native dispatch_benchmark.cpp -o dispatch_bench
+  ./dispatch_bench
+
+  # 计数器需要 PMU 权限（虚拟机中通常不可用，表格显示 '-'）
+  sudo sysctl kernel.perf_event_paranoid=1
+
+预期结果 (ns/call, Intel Core i7):
+  Style                      predictable   random
+  virtual                    ~1.0          ~4-6
+  final via ShapeVirtual*    ~1.0          ~4-6   （经基类指针调用，与 virtual 相同）
+  final via Circle/..Final*  ~0.4          ~0.4   （具体类型指针 + 按类型分桶：去虚化，只剩指针追逐）
+  CRTP (type buckets)        ~0.3          ~0.3   （无分派，与顺序无关）
+  std::variant + visit       ~0.6          ~3-4
+  function-pointer vtable    ~0.8          ~3-5
+  SBO type erasure           ~0.8          ~3-5
+  std::function              ~1.2          ~5-7
+  function_ref               ~0.9          ~4-6   （一次间接调用：跳板内联了 area()）
+
+关键点:
+  1. 随机顺序下，所有间接分派都要付出约一次分支预测失败（~15-20 cycles）
+  2. 堆分配的对象（virtual / std::function 大闭包）还要付出指针追逐的缓存缺失
+  3. variant / SBO / 函数指针表对象内联存储，顺序扫描时预取器有效
+*/
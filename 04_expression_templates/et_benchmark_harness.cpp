@@ -0,0 +1,265 @@
+// et_benchmark_harness.cpp
+// 表达式模板参数扫描：向量长度 16 .. 100M × 表达式深度 1 .. 8
+// 对每个组合报告每元素耗时、每元素内存流量（模型值）、实测带宽，
+// 以及每次求值分配的临时对象数（通过替换全局 operator new 计数）
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <string>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "expression_templates.hpp"
+
+// ============================================================================
+// Part 1: 计数分配器
+// ============================================================================
+
+// 替换全局 operator new/delete：统计次数与字节数，其余行为不变。
+// 所有 new/delete 都经过同一对不内联的 allocate/release：
+// 若 malloc/free 直接内联进 operator new/delete，GCC 会把 new 表达式与其中的 free
+// 配对检查，报 -Wmismatched-new-delete 误报
+namespace alloc_stats {
+std::atomic<size_t> count{ 0 };
+std::atomic<size_t> bytes{ 0 };
+
+[[gnu::noinline]] void* allocate(size_t n, size_t align) {
+    count.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(n, std::memory_order_relaxed);
+    void* p = align <= alignof(std::max_align_t)
+                  ? std::malloc(n ? n : 1)
+                  : std::aligned_alloc(align, (n + align - 1) / align * align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+[[gnu::noinline]] void release(void* p) noexcept { std::free(p); }
+}
+
+void* operator new(size_t n) { return alloc_stats::allocate(n, 0); }
+void* operator new(size_t n, std::align_val_t al) {
+    return alloc_stats::allocate(n, static_cast<size_t>(al));
+}
+void* operator new[](size_t n) { return alloc_stats::allocate(n, 0); }
+void* operator new[](size_t n, std::align_val_t al) {
+    return alloc_stats::allocate(n, static_cast<size_t>(al));
+}
+void operator delete(void* p) noexcept { alloc_stats::release(p); }
+void operator delete(void* p, size_t) noexcept { alloc_stats::release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alloc_stats::release(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { alloc_stats::release(p); }
+void operator delete[](void* p) noexcept { alloc_stats::release(p); }
+void operator delete[](void* p, size_t) noexcept { alloc_stats::release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alloc_stats::release(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { alloc_stats::release(p); }
+
+// ============================================================================
+// Part 2: 对照组（与 expression_templates_complete.cpp 的 VectorNaive 相同）
+// ============================================================================
+
+class VectorNaive {
+    std::vector<double> data_;
+public:
+    explicit VectorNaive(size_t n, double val = 0.0) : data_(n, val) {}
+
+    size_t size() const { return data_.size(); }
+    double operator[](size_t i) const { return data_[i]; }
+
+    VectorNaive operator+(const VectorNaive& other) const {
+        VectorNaive result(size());
+        for (size_t i = 0; i < size(); ++i) {
+            result.data_[i] = data_[i] + other.data_[i];
+        }
+        return result;
+    }
+};
+
+// 深度 D = 运算符个数：out = ((v0 + v1) + v2) + ... + vD，共 D + 1 个输入
+// 左折叠表达式对两种实现生成同样形状的表达式树
+template<typename V, size_t... I>
+void eval_chain(V& out, const std::vector<V>& in, std::index_sequence<I...>) {
+    out = (in[0] + ... + in[I + 1]);
+}
+
+// ============================================================================
+// Part 3: 测量
+// ============================================================================
+
+struct SweepConfig {
+    size_t max_size = 100'000'000;
+    size_t max_depth = 8;
+    double mem_gb = 4.0;        // 单次测量允许的内存上限，超出则跳过
+    int trials = 5;             // 每个组合的试验次数，取中位数
+    double min_trial_ms = 20.0; // 每次试验至少运行这么久（小尺寸时重复多次）
+};
+
+struct Measurement {
+    double ns_per_elem = 0.0;
+    double temporaries = 0.0;   // 每次求值的分配次数
+    double alloc_bytes = 0.0;   // 每次求值分配的字节数
+};
+
+SweepConfig g_sweep;
+
+template<typename F>
+Measurement measure(size_t n, F&& eval) {
+    using clock = std::chrono::steady_clock;
+
+    // 预热并估算单次耗时，决定每次试验的重复次数
+    auto t0 = clock::now();
+    eval();
+    double once_ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    const size_t reps = std::max<size_t>(1, static_cast<size_t>(g_sweep.min_trial_ms / std::max(once_ms, 1e-6)));
+
+    std::vector<double> per_elem;
+    size_t allocs = 0, bytes = 0;
+    for (int t = 0; t < g_sweep.trials; ++t) {
+        size_t c0 = alloc_stats::count.load(), b0 = alloc_stats::bytes.load();
+        auto start = clock::now();
+        for (size_t r = 0; r < reps; ++r) {
+            eval();
+            asm volatile("" : : : "memory");
+        }
+        double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        allocs += alloc_stats::count.load() - c0;
+        bytes += alloc_stats::bytes.load() - b0;
+        per_elem.push_back(ns / (static_cast<double>(reps) * n));
+    }
+    std::sort(per_elem.begin(), per_elem.end());
+
+    const double evals = static_cast<double>(reps) * g_sweep.trials;
+    return { per_elem[per_elem.size() / 2], allocs / evals, bytes / evals };
+}
+
+template<typename V, size_t D>
+Measurement run_chain(size_t n) {
+    std::vector<V> in;
+    in.reserve(D + 1);
+    for (size_t k = 0; k <= D; ++k) in.emplace_back(n, 1.0 + 0.001 * k);
+    V out(n);
+    return measure(n, [&]() { eval_chain(out, in, std::make_index_sequence<D>{}); });
+}
+
+// 运行期深度 → 编译期深度
+template<typename V, size_t... D>
+Measurement run_depth(size_t depth, size_t n, std::index_sequence<D...>) {
+    Measurement m;
+    ((depth == D + 1 ? (m = run_chain<V, D + 1>(n), true) : false) || ...);
+    return m;
+}
+
+struct Row {
+    size_t size, depth;
+    Measurement et, naive;
+    double et_bytes_per_elem, naive_bytes_per_elem;
+};
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    std::string csv_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--max-size") g_sweep.max_size = std::stoull(next());
+        else if (arg == "--max-depth") g_sweep.max_depth = std::clamp<size_t>(std::stoull(next()), 1, 8);
+        else if (arg == "--mem-gb") g_sweep.mem_gb = std::stod(next());
+        else if (arg == "--trials") g_sweep.trials = std::max(1, std::stoi(next()));
+        else if (arg == "--csv") csv_path = next();
+        else {
+            std::cerr << "usage: " << argv[0] << " [--max-size N] [--max-depth D] [--mem-gb G]"
+                      << " [--trials N] [--csv FILE]\n";
+            return 2;
+        }
+    }
+
+    std::vector<size_t> sizes;
+    for (size_t n = 16; n <= g_sweep.max_size && n < 100'000'000; n *= 16) sizes.push_back(n);
+    if (g_sweep.max_size >= 100'000'000) sizes.push_back(100'000'000);
+
+    std::cout << "================================================\n";
+    std::cout << "  Expression Template Sweep\n";
+    std::cout << "================================================\n";
+    std::cout << "Sizes: 16 .. " << sizes.back() << ", depth: 1 .. " << g_sweep.max_depth
+              << ", trials: " << g_sweep.trials << " (median)\n";
+    std::cout << "Packet width: " << kPacketSize << " doubles, threads: " << default_pool().size()
+              << ", memory budget: " << g_sweep.mem_gb << " GB\n";
+    std::cout << "B/elem is the traffic model: ET reads D+1 inputs and writes 1 output,\n";
+    std::cout << "naive reads 2 and writes 1 per operator.\n\n";
+
+    std::cout << std::right << std::setw(10) << "size" << std::setw(6) << "depth"
+              << std::setw(11) << "ET ns/el" << std::setw(11) << "naive" << std::setw(9) << "speedup"
+              << std::setw(9) << "ET B/el" << std::setw(9) << "naive" << std::setw(9) << "ET GB/s"
+              << std::setw(8) << "ET tmp" << std::setw(8) << "naive" << "\n";
+    std::cout << std::string(90, '-') << "\n";
+
+    std::vector<Row> rows;
+    for (size_t n : sizes) {
+        for (size_t d = 1; d <= g_sweep.max_depth; ++d) {
+            Row row{ n, d, {}, {}, (d + 2) * 8.0, d * 24.0 };
+            // 峰值内存：D + 1 个输入 + 输出，朴素版本另有最多 2 个同时存活的临时对象
+            const double need_gb = (d + 4) * n * sizeof(double) / 1e9;
+            if (need_gb > g_sweep.mem_gb) {
+                std::cout << std::setw(10) << n << std::setw(6) << d
+                          << "   skipped (needs " << std::setprecision(1) << std::fixed
+                          << need_gb << " GB, raise --mem-gb)\n";
+                continue;
+            }
+            row.et = run_depth<Vector>(d, n, std::make_index_sequence<8>{});
+            row.naive = run_depth<VectorNaive>(d, n, std::make_index_sequence<8>{});
+            rows.push_back(row);
+
+            std::cout << std::fixed << std::setw(10) << n << std::setw(6) << d
+                      << std::setprecision(3) << std::setw(11) << row.et.ns_per_elem
+                      << std::setw(11) << row.naive.ns_per_elem
+                      << std::setprecision(2) << std::setw(8) << row.naive.ns_per_elem / row.et.ns_per_elem << "x"
+                      << std::setprecision(0) << std::setw(9) << row.et_bytes_per_elem
+                      << std::setw(9) << row.naive_bytes_per_elem
+                      << std::setprecision(2) << std::setw(9) << row.et_bytes_per_elem / row.et.ns_per_elem
+                      << std::setprecision(1) << std::setw(8) << row.et.temporaries
+                      << std::setw(8) << row.naive.temporaries << "\n";
+        }
+    }
+
+    if (!csv_path.empty()) {
+        std::ofstream csv(csv_path);
+        csv << "size,depth,et_ns_per_elem,naive_ns_per_elem,et_bytes_per_elem,naive_bytes_per_elem,"
+               "et_temporaries,naive_temporaries,et_alloc_bytes,naive_alloc_bytes\n";
+        for (const Row& r : rows) {
+            csv << r.size << ',' << r.depth << ',' << r.et.ns_per_elem << ',' << r.naive.ns_per_elem << ','
+                << r.et_bytes_per_elem << ',' << r.naive_bytes_per_elem << ','
+                << r.et.temporaries << ',' << r.naive.temporaries << ','
+                << r.et.alloc_bytes << ',' << r.naive.alloc_bytes << '\n';
+        }
+        std::cout << "\nCSV written to " << csv_path << "\n";
+    }
+
+    std::cout << "\nCompile-time cost of deep expression types: ./et_compile_time.sh\n";
+    return 0;
+}
+
+/* 编译与运行:
+
+  g++ -std=c++20 -O3 -march=native -pthread et_benchmark_harness.cpp -o et_sweep
+  ./et_sweep                          # 完整扫描（100M × 深度 8 需要约 10 GB，超出预算的组合会跳过）
+  ./et_sweep --max-size 1000000 --csv et_sweep.csv
+  ./et_sweep --mem-gb 16              # 大内存机器上跑满 100M
+
+  ./et_compile_time.sh                # 深度 1 .. 128 的编译耗时、目标文件大小、最长符号名
+
+预期结果:
+  - ET 每次求值临时对象 0 个；朴素版本 D 个（每个运算符一个结果向量）
+  - 缓存内（<= 64K）：ET 受计算/加载端口限制，深度越大相对朴素版本优势越明显
+  - 超出 LLC（>= 16M）：两者都受带宽限制，加速比接近流量模型之比 24D / (8D + 16)，
+    深度 8 时约 2.4x；小尺寸（16）时朴素版本的堆分配占主导，可达 10x 以上
+*/
@@ -0,0 +1,21 @@
+// et_compile_depth.cpp
+// 编译期开销测量用的最小翻译单元：实例化一条深度为 ET_DEPTH 的表达式链
+// 由 et_compile_time.sh 以不同的 -DET_DEPTH 编译，记录耗时、目标文件大小与类型名长度
+
+#include <utility>
+
+#include "expression_templates.hpp"
+
+#ifndef ET_DEPTH
+#define ET_DEPTH 8
+#endif
+
+// out = ((v0 + v1 * 2) + v2 * 2) + ...：每一层多一个 VecAdd 和一个 VecScalarMul
+template<size_t... I>
+void eval_chain(Vector& out, const Vector* const* in, std::index_sequence<I...>) {
+    out = (*in[0] + ... + (*in[I + 1] * 2.0));
+}
+
+void evaluate_depth(Vector& out, const Vector* const* in) {
+    eval_chain(out, in, std::make_index_sequence<ET_DEPTH>{});
+}
@@ -0,0 +1,27 @@
+#!/bin/bash
+# 测量表达式深度对编译期开销的影响：编译耗时、目标文件大小、最长（demangle 后）符号名
+# 用法: ./et_compile_time.sh [CXX] [depth...]
+
+CXX=${1:-g++}
+shift
+DEPTHS=${@:-1 2 4 8 16 32 64 128}
+FLAGS="-std=c++20 -O3 -march=native -c"
+DIR=$(cd "$(dirname "$0")" && pwd)
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+printf "%-8s %12s %12s %14s\n" "depth" "compile (s)" "object (KB)" "longest sym"
+for d in $DEPTHS; do
+    obj="$OUT/depth_$d.o"
+    start=$(date +%s.%N)
+    if ! $CXX $FLAGS -DET_DEPTH=$d "$DIR/et_compile_depth.cpp" -o "$obj" 2> "$OUT/err.txt"; then
+        printf "%-8s %12s\n" "$d" "FAILED"
+        head -3 "$OUT/err.txt"
+        continue
+    fi
+    end=$(date +%s.%N)
+    secs=$(awk "BEGIN { print $end - $start }")
+    kb=$(( $(stat -c %s "$obj") / 1024 ))
+    longest=$(nm -C "$obj" | awk '{ if (length($0) > m) m = length($0) } END { print m + 0 }')
+    printf "%-8s %12.2f %12d %14d\n" "$d" "$secs" "$kb" "$longest"
+done
@@ -0,0 +1,1596 @@
+// expression_templates.hpp
+// 表达式模板库：Packet SIMD 抽象、线程池、向量/矩阵表达式、分块 GEMM、固定尺寸类型
+// expression_templates_complete.cpp（演示）与 et_benchmark_harness.cpp（参数扫描）共用
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <exception>
+#include <cstddef>
+#include <array>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+// GCC 12 的 AVX-512 头文件用自初始化的 _mm512_undefined_pd() 作占位，-Wall 下会误报未初始化
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+// ============================================================================
+// Part 2.0: SIMD Packet 抽象与对齐存储
+// ============================================================================
+
+// 一个 Packet = 一个向量寄存器能装下的 double 个数
+#if defined(__AVX512F__)
+using Packet = __m512d;
+constexpr size_t kPacketSize = 8;
+inline Packet pload(const double* p) { return _mm512_load_pd(p); }
+inline void pstore(double* p, Packet v) { _mm512_store_pd(p, v); }
+inline Packet ploadu(const double* p) { return _mm512_loadu_pd(p); }
+inline void pstoreu(double* p, Packet v) { _mm512_storeu_pd(p, v); }
+inline Packet pset1(double x) { return _mm512_set1_pd(x); }
+inline Packet padd(Packet a, Packet b) { return _mm512_add_pd(a, b); }
+inline Packet psub(Packet a, Packet b) { return _mm512_sub_pd(a, b); }
+inline Packet pmul(Packet a, Packet b) { return _mm512_mul_pd(a, b); }
+inline Packet pfmadd(Packet a, Packet b, Packet c) { return _mm512_fmadd_pd(a, b, c); }
+inline Packet pmax(Packet a, Packet b) { return _mm512_max_pd(a, b); }
+inline Packet pmin(Packet a, Packet b) { return _mm512_min_pd(a, b); }
+inline Packet pabs(Packet a) { return _mm512_abs_pd(a); }
+inline Packet psqrt(Packet a) { return _mm512_sqrt_pd(a); }
+// 水平归约：512 → 256 → 128 → 64
+inline __m256d lo256(Packet a) { return _mm512_castpd512_pd256(a); }
+inline __m256d hi256(Packet a) { return _mm512_extractf64x4_pd(a, 1); }
+inline double predux_add(Packet a) {
+    __m256d v4 = _mm256_add_pd(lo256(a), hi256(a));
+    __m128d v = _mm_add_pd(_mm256_castpd256_pd128(v4), _mm256_extractf128_pd(v4, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+inline double predux_max(Packet a) {
+    __m256d v4 = _mm256_max_pd(lo256(a), hi256(a));
+    __m128d v = _mm_max_pd(_mm256_castpd256_pd128(v4), _mm256_extractf128_pd(v4, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v)));
+}
+inline double predux_min(Packet a) {
+    __m256d v4 = _mm256_min_pd(lo256(a), hi256(a));
+    __m128d v = _mm_min_pd(_mm256_castpd256_pd128(v4), _mm256_extractf128_pd(v4, 1));
+    return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v)));
+}
+#elif defined(__AVX2__)
+using Packet = __m256d;
+constexpr size_t kPacketSize = 4;
+inline Packet pload(const double* p) { return _mm256_load_pd(p); }
+inline void pstore(double* p, Packet v) { _mm256_store_pd(p, v); }
+inline Packet ploadu(const double* p) { return _mm256_loadu_pd(p); }
+inline void pstoreu(double* p, Packet v) { _mm256_storeu_pd(p, v); }
+inline Packet pset1(double x) { return _mm256_set1_pd(x); }
+inline Packet padd(Packet a, Packet b) { return _mm256_add_pd(a, b); }
+inline Packet psub(Packet a, Packet b) { return _mm256_sub_pd(a, b); }
+inline Packet pmul(Packet a, Packet b) { return _mm256_mul_pd(a, b); }
+#ifdef __FMA__
+inline Packet pfmadd(Packet a, Packet b, Packet c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+inline Packet pfmadd(Packet a, Packet b, Packet c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#endif
+inline Packet pmax(Packet a, Packet b) { return _mm256_max_pd(a, b); }
+inline Packet pmin(Packet a, Packet b) { return _mm256_min_pd(a, b); }
+inline Packet pabs(Packet a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+inline Packet psqrt(Packet a) { return _mm256_sqrt_pd(a); }
+// 水平归约：256 → 128 → 64
+inline __m128d fold128(Packet a) { return _mm256_castpd256_pd128(a); }
+inline double predux_add(Packet a) {
+    __m128d v = _mm_add_pd(fold128(a), _mm256_extractf128_pd(a, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+inline double predux_max(Packet a) {
+    __m128d v = _mm_max_pd(fold128(a), _mm256_extractf128_pd(a, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v)));
+}
+inline double predux_min(Packet a) {
+    __m128d v = _mm_min_pd(fold128(a), _mm256_extractf128_pd(a, 1));
+    return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v)));
+}
+#else
+// 无 AVX：Packet 退化为单个 double，表达式代码无需任何修改
+using Packet = double;
+constexpr size_t kPacketSize = 1;
+inline Packet pload(const double* p) { return *p; }
+inline void pstore(double* p, Packet v) { *p = v; }
+inline Packet ploadu(const double* p) { return *p; }
+inline void pstoreu(double* p, Packet v) { *p = v; }
+inline Packet pset1(double x) { return x; }
+inline Packet padd(Packet a, Packet b) { return a + b; }
+inline Packet psub(Packet a, Packet b) { return a - b; }
+inline Packet pmul(Packet a, Packet b) { return a * b; }
+inline Packet pfmadd(Packet a, Packet b, Packet c) { return a * b + c; }
+inline Packet pmax(Packet a, Packet b) { return std::max(a, b); }
+inline Packet pmin(Packet a, Packet b) { return std::min(a, b); }
+inline Packet pabs(Packet a) { return std::abs(a); }
+inline Packet psqrt(Packet a) { return std::sqrt(a); }
+inline double predux_add(Packet a) { return a; }
+inline double predux_max(Packet a) { return a; }
+inline double predux_min(Packet a) { return a; }
+#endif
+
+// kPacketSize x kPacketSize 的寄存器块：AVX-512 为 8x8，AVX2 为 4x4，标量为 1x1
+struct PacketBlock {
+    Packet row[kPacketSize];
+};
+
+// 寄存器内转置，不经过内存
+#if defined(__AVX512F__)
+inline void ptranspose(PacketBlock& b) {
+    Packet* r = b.row;
+    // 第 1 步：相邻两行按 64 位交织，t0 的 128 位 lane k = (r0[2k], r1[2k])
+    Packet t0 = _mm512_unpacklo_pd(r[0], r[1]), t1 = _mm512_unpackhi_pd(r[0], r[1]);
+    Packet t2 = _mm512_unpacklo_pd(r[2], r[3]), t3 = _mm512_unpackhi_pd(r[2], r[3]);
+    Packet t4 = _mm512_unpacklo_pd(r[4], r[5]), t5 = _mm512_unpackhi_pd(r[4], r[5]);
+    Packet t6 = _mm512_unpacklo_pd(r[6], r[7]), t7 = _mm512_unpackhi_pd(r[6], r[7]);
+    // 第 2、3 步：按 128 位 lane 重排（0x88 取偶数 lane，0xDD 取奇数 lane）
+    Packet u0 = _mm512_shuffle_f64x2(t0, t2, 0x88), u1 = _mm512_shuffle_f64x2(t4, t6, 0x88);
+    Packet u2 = _mm512_shuffle_f64x2(t0, t2, 0xDD), u3 = _mm512_shuffle_f64x2(t4, t6, 0xDD);
+    Packet v0 = _mm512_shuffle_f64x2(t1, t3, 0x88), v1 = _mm512_shuffle_f64x2(t5, t7, 0x88);
+    Packet v2 = _mm512_shuffle_f64x2(t1, t3, 0xDD), v3 = _mm512_shuffle_f64x2(t5, t7, 0xDD);
+    r[0] = _mm512_shuffle_f64x2(u0, u1, 0x88);
+    r[4] = _mm512_shuffle_f64x2(u0, u1, 0xDD);
+    r[2] = _mm512_shuffle_f64x2(u2, u3, 0x88);
+    r[6] = _mm512_shuffle_f64x2(u2, u3, 0xDD);
+    r[1] = _mm512_shuffle_f64x2(v0, v1, 0x88);
+    r[5] = _mm512_shuffle_f64x2(v0, v1, 0xDD);
+    r[3] = _mm512_shuffle_f64x2(v2, v3, 0x88);
+    r[7] = _mm512_shuffle_f64x2(v2, v3, 0xDD);
+}
+#elif defined(__AVX2__)
+inline void ptranspose(PacketBlock& b) {
+    Packet* r = b.row;
+    Packet t0 = _mm256_unpacklo_pd(r[0], r[1]), t1 = _mm256_unpackhi_pd(r[0], r[1]);
+    Packet t2 = _mm256_unpacklo_pd(r[2], r[3]), t3 = _mm256_unpackhi_pd(r[2], r[3]);
+    r[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+    r[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+    r[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+    r[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+#else
+inline void ptranspose(PacketBlock&) {}
+#endif
+
+// 没有 SVML 时 exp 没有对应的向量指令：逐 lane 调用 std::exp（仍然只遍历一次内存）
+inline Packet pexp(Packet a) {
+    alignas(64) double lanes[kPacketSize];
+    pstore(lanes, a);
+    for (size_t k = 0; k < kPacketSize; ++k) lanes[k] = std::exp(lanes[k]);
+    return pload(lanes);
+}
+
+// 64 字节对齐（缓存行 + AVX-512 宽度），保证 packet(i) 可以使用对齐加载
+template<typename T, size_t Alignment = 64>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    AlignedAllocator() noexcept = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t n) {
+        void* p = ::operator new(n * sizeof(T), std::align_val_t(Alignment));
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    // 无参构造走默认初始化：vector(n) 不再由主线程清零整块内存，
+    // 第一次写入（first touch）交给真正计算该区间的线程，页面落在它所在的 NUMA 节点
+    template<typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+};
+
+template<typename T1, typename T2, size_t A>
+bool operator==(const AlignedAllocator<T1, A>&, const AlignedAllocator<T2, A>&) { return true; }
+
+template<typename T1, typename T2, size_t A>
+bool operator!=(const AlignedAllocator<T1, A>&, const AlignedAllocator<T2, A>&) { return false; }
+
+using AlignedBuffer = std::vector<double, AlignedAllocator<double>>;
+
+// ============================================================================
+// Part 2.1: 线程池（大规模表达式的并行求值）
+// ============================================================================
+
+// 固定数量的常驻工作线程 + 静态分块：同一区间每次都由同一线程处理，
+// 与 first-touch 配合，使数据页留在计算它的核心所在的 NUMA 节点
+//
+// 同一时刻只分发一个任务：另一个线程正在使用线程池，或者调用来自本池的工作线程 /
+// 正在分发的线程（嵌套调用）时，整个区间在调用线程上串行执行，不会互相覆盖任务状态或死锁
+class ThreadPool {
+    // 非拥有的任务引用：指向调用方栈上的闭包，分发时不分配内存
+    struct JobRef {
+        const void* ctx;
+        void (*call)(const void*, size_t);
+    };
+
+    std::vector<std::thread> workers_;
+    std::mutex dispatch_mutex_;  // 整个 parallel_for 期间持有
+    std::mutex mutex_;
+    std::condition_variable start_cv_, done_cv_;
+    JobRef job_{};
+    size_t generation_ = 0;
+    size_t pending_ = 0;
+    bool stop_ = false;
+
+    // 当前线程正在为哪个线程池工作（工作线程始终为所属的池，调用线程在分发期间为该池）
+    static const ThreadPool*& active_pool() {
+        thread_local const ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    void worker_loop(size_t index) {
+        active_pool() = this;
+        size_t seen = 0;
+        for (;;) {
+            JobRef job;
+            {
+                std::unique_lock lock(mutex_);
+                start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+                job = job_;
+            }
+            job.call(job.ctx, index);
+            {
+                std::lock_guard lock(mutex_);
+                if (--pending_ == 0) done_cv_.notify_one();
+            }
+        }
+    }
+
+public:
+    // threads 包含调用线程本身，因此只创建 threads - 1 个工作线程
+    explicit ThreadPool(size_t threads) {
+        for (size_t i = 1; i < threads; ++i) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size() + 1; }
+
+    // 把 [0, n) 切成 size() 个连续块，块边界按 grain 对齐（避免伪共享、保持 Packet 对齐）
+    template<typename F>
+    void parallel_for(size_t n, size_t grain, F&& body) {
+        const size_t parts = size();
+        if (parts == 1 || active_pool() == this) {
+            if (n > 0) body(size_t{0}, n);
+            return;
+        }
+        std::unique_lock dispatch(dispatch_mutex_, std::try_to_lock);
+        if (!dispatch.owns_lock()) {
+            if (n > 0) body(size_t{0}, n);
+            return;
+        }
+
+        const size_t chunk = ((n + parts - 1) / parts + grain - 1) / grain * grain;
+        auto run = [&](size_t part) {
+            size_t begin = std::min(n, part * chunk);
+            size_t end = std::min(n, begin + chunk);
+            if (begin < end) body(begin, end);
+        };
+        using Run = decltype(run);
+        {
+            std::lock_guard lock(mutex_);
+            job_ = { &run, [](const void* ctx, size_t part) { (*static_cast<const Run*>(ctx))(part); } };
+            pending_ = workers_.size();
+            ++generation_;
+        }
+        start_cv_.notify_all();
+        const ThreadPool* previous = std::exchange(active_pool(), this);
+        std::exception_ptr error;
+        try {
+            run(0);  // 调用线程处理第 0 块
+        } catch (...) {
+            error = std::current_exception();  // 工作线程仍在引用 run，先等它们结束
+        }
+        active_pool() = previous;
+        {
+            std::unique_lock lock(mutex_);
+            done_cv_.wait(lock, [&] { return pending_ == 0; });
+        }
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+inline ThreadPool& default_pool() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+// 低于该元素数时线程同步开销超过收益，保持单线程（可调，设为 SIZE_MAX 即禁用并行）
+inline size_t& parallel_threshold() {
+    static size_t threshold = 1 << 18;  // 256K doubles = 2 MB
+    return threshold;
+}
+
+// 别名求值用的临时缓冲区池：A = transpose(A) 这类赋值反复出现时复用同一块内存，
+// 求值结果与目标交换存储，旧存储归还给池
+class ScratchPool {
+    std::vector<AlignedBuffer> free_;
+    std::mutex mutex_;
+    static constexpr size_t kMaxCached = 4;
+public:
+    AlignedBuffer acquire(size_t n) {
+        {
+            std::lock_guard lock(mutex_);
+            for (auto it = free_.begin(); it != free_.end(); ++it) {
+                if (it->capacity() >= n) {
+                    AlignedBuffer buf = std::move(*it);
+                    free_.erase(it);
+                    buf.resize(n);
+                    return buf;
+                }
+            }
+        }
+        return AlignedBuffer(n);
+    }
+
+    void release(AlignedBuffer&& buf) {
+        std::lock_guard lock(mutex_);
+        if (free_.size() < kMaxCached) free_.push_back(std::move(buf));
+    }
+};
+
+inline ScratchPool& scratch_pool() {
+    static ScratchPool pool;
+    return pool;
+}
+
+// ============================================================================
+// Part 2: 表达式模板实现（零临时对象）
+// ============================================================================
+
+// 表达式基类（CRTP）
+template<typename E>
+class VecExpr {
+public:
+    double operator[](size_t i) const {
+        return static_cast<const E&>(*this)[i];
+    }
+    
+    size_t size() const {
+        return static_cast<const E&>(*this).size();
+    }
+    
+    // 一次求值 kPacketSize 个元素（i 必须是 kPacketSize 的倍数）
+    Packet packet(size_t i) const {
+        return static_cast<const E&>(*this).packet(i);
+    }
+    
+    // 表达式是否读取 dest；reordered 表示当前位置读取的不是第 i 个元素本身
+    bool aliases(const void* dest, bool reordered) const {
+        return static_cast<const E&>(*this).aliases(dest, reordered);
+    }
+    
+    operator E&() { return static_cast<E&>(*this); }
+    operator const E&() const { return static_cast<const E&>(*this); }
+};
+
+// 实际的向量类
+class Vector : public VecExpr<Vector> {
+    AlignedBuffer data_;
+
+    // 主循环按 Packet 求值（对齐加载/存储），剩余不足一个 Packet 的尾部标量处理
+    template<typename E>
+    void evaluate_range(const E& e, size_t begin, size_t end) {
+        const size_t packet_end = end - (end - begin) % kPacketSize;
+        double* out = data_.data();
+        size_t i = begin;
+        for (; i < packet_end; i += kPacketSize) {
+            pstore(out + i, e.packet(i));
+        }
+        for (; i < end; ++i) {
+            out[i] = e[i];
+        }
+    }
+
+    // 超过阈值时按缓存行对齐的块分给线程池；块起点是 8 的倍数，Packet 加载仍然对齐
+    template<typename E>
+    void evaluate(const E& e) {
+        const size_t n = size();
+        if (n < parallel_threshold() || default_pool().size() == 1) {
+            evaluate_range(e, 0, n);
+            return;
+        }
+        default_pool().parallel_for(n, 64 / sizeof(double), [&](size_t begin, size_t end) {
+            evaluate_range(e, begin, end);
+        });
+    }
+
+    explicit Vector(AlignedBuffer&& storage) : data_(std::move(storage)) {}
+
+public:
+    // 编译期别名信息：叶子和逐元素运算为 true，shift 等重排下标的节点为 false
+    static constexpr bool elementwise = true;
+
+    explicit Vector(size_t n, double val = 0.0) : data_(n, val) {}
+    Vector(std::initializer_list<double> init) : data_(init) {}
+    
+    // 从表达式构造（关键！）data_ 只分配不清零，由 evaluate 的各线程完成首次写入
+    template<typename E>
+    Vector(const VecExpr<E>& expr) : data_(expr.size()) {
+        evaluate(static_cast<const E&>(expr));
+    }
+    
+    size_t size() const { return data_.size(); }
+    double operator[](size_t i) const { return data_[i]; }
+    double& operator[](size_t i) { return data_[i]; }
+    Packet packet(size_t i) const { return pload(data_.data() + i); }
+    const double* data() const { return data_.data(); }
+    bool aliases(const void* dest, bool reordered) const { return reordered && dest == this; }
+    
+    // 从表达式赋值（SIMD 路径）
+    template<typename E>
+    Vector& operator=(const VecExpr<E>& expr) {
+        const E& e = expr;
+        if constexpr (!E::elementwise) {
+            // 目标出现在重排位置（如 v = shift(v, 1) + w）：边写边读会读到已覆盖的值，
+            // 改为写入池中的临时缓冲区再交换；纯逐元素表达式在编译期就跳过此检查
+            if (e.aliases(this, false)) {
+                Vector tmp(scratch_pool().acquire(e.size()));
+                tmp.evaluate(e);
+                data_.swap(tmp.data_);
+                scratch_pool().release(std::move(tmp.data_));
+                return *this;
+            }
+        }
+        evaluate(e);
+        return *this;
+    }
+
+    // 从表达式赋值（逐元素标量路径，依赖编译器自动向量化，用于对比）
+    template<typename E>
+    Vector& assign_scalar(const VecExpr<E>& expr) {
+        for (size_t i = 0; i < size(); ++i) {
+            data_[i] = expr[i];
+        }
+        return *this;
+    }
+};
+
+// 加法表达式（不存储数据，只存储引用）
+template<typename E1, typename E2>
+class VecAdd : public VecExpr<VecAdd<E1, E2>> {
+    const E1& u_;
+    const E2& v_;
+public:
+    VecAdd(const E1& u, const E2& v) : u_(u), v_(v) {}
+    
+    double operator[](size_t i) const {
+        return u_[i] + v_[i];
+    }
+    
+    Packet packet(size_t i) const { return padd(u_.packet(i), v_.packet(i)); }
+    static constexpr bool elementwise = E1::elementwise && E2::elementwise;
+    bool aliases(const void* dest, bool reordered) const {
+        return u_.aliases(dest, reordered) || v_.aliases(dest, reordered);
+    }
+    
+    size_t size() const { return u_.size(); }
+};
+
+// 标量乘法表达式
+template<typename E>
+class VecScalarMul : public VecExpr<VecScalarMul<E>> {
+    const E& v_;
+    double scalar_;
+public:
+    VecScalarMul(const E& v, double s) : v_(v), scalar_(s) {}
+    
+    double operator[](size_t i) const {
+        return v_[i] * scalar_;
+    }
+    
+    Packet packet(size_t i) const { return pmul(v_.packet(i), pset1(scalar_)); }
+    static constexpr bool elementwise = E::elementwise;
+    bool aliases(const void* dest, bool reordered) const { return v_.aliases(dest, reordered); }
+    
+    size_t size() const { return v_.size(); }
+};
+
+// 减法表达式
+template<typename E1, typename E2>
+class VecSub : public VecExpr<VecSub<E1, E2>> {
+    const E1& u_;
+    const E2& v_;
+public:
+    VecSub(const E1& u, const E2& v) : u_(u), v_(v) {}
+    
+    double operator[](size_t i) const {
+        return u_[i] - v_[i];
+    }
+    
+    Packet packet(size_t i) const { return psub(u_.packet(i), v_.packet(i)); }
+    static constexpr bool elementwise = E1::elementwise && E2::elementwise;
+    bool aliases(const void* dest, bool reordered) const {
+        return u_.aliases(dest, reordered) || v_.aliases(dest, reordered);
+    }
+    
+    size_t size() const { return u_.size(); }
+};
+
+// 元素乘法表达式
+template<typename E1, typename E2>
+class VecMul : public VecExpr<VecMul<E1, E2>> {
+    const E1& u_;
+    const E2& v_;
+public:
+    VecMul(const E1& u, const E2& v) : u_(u), v_(v) {}
+    
+    double operator[](size_t i) const {
+        return u_[i] * v_[i];
+    }
+    
+    Packet packet(size_t i) const { return pmul(u_.packet(i), v_.packet(i)); }
+    static constexpr bool elementwise = E1::elementwise && E2::elementwise;
+    bool aliases(const void* dest, bool reordered) const {
+        return u_.aliases(dest, reordered) || v_.aliases(dest, reordered);
+    }
+    
+    size_t size() const { return u_.size(); }
+};
+
+// 平移：结果第 i 个元素为 v[i + offset]，越界处为 0（如差分 shift(v, 1) - v）
+template<typename E>
+class VecShift : public VecExpr<VecShift<E>> {
+    const E& v_;
+    std::ptrdiff_t offset_;
+public:
+    VecShift(const E& v, std::ptrdiff_t offset) : v_(v), offset_(offset) {}
+    
+    double operator[](size_t i) const {
+        std::ptrdiff_t k = static_cast<std::ptrdiff_t>(i) + offset_;
+        return (k >= 0 && k < static_cast<std::ptrdiff_t>(size())) ? v_[k] : 0.0;
+    }
+    
+    // 源下标不落在 Packet 边界上，逐 lane 收集
+    Packet packet(size_t i) const {
+        alignas(64) double lanes[kPacketSize];
+        for (size_t k = 0; k < kPacketSize; ++k) lanes[k] = (*this)[i + k];
+        return pload(lanes);
+    }
+    
+    size_t size() const { return v_.size(); }
+    static constexpr bool elementwise = false;
+    bool aliases(const void* dest, bool) const { return v_.aliases(dest, true); }
+};
+
+template<typename E>
+VecShift<E> shift(const VecExpr<E>& v, std::ptrdiff_t offset) {
+    return VecShift<E>(v, offset);
+}
+
+// 运算符重载
+template<typename E1, typename E2>
+VecAdd<E1, E2> operator+(const VecExpr<E1>& u, const VecExpr<E2>& v) {
+    return VecAdd<E1, E2>(u, v);
+}
+
+template<typename E1, typename E2>
+VecSub<E1, E2> operator-(const VecExpr<E1>& u, const VecExpr<E2>& v) {
+    return VecSub<E1, E2>(u, v);
+}
+
+template<typename E1, typename E2>
+VecMul<E1, E2> operator*(const VecExpr<E1>& u, const VecExpr<E2>& v) {
+    return VecMul<E1, E2>(u, v);
+}
+
+template<typename E>
+VecScalarMul<E> operator*(const VecExpr<E>& v, double s) {
+    return VecScalarMul<E>(v, s);
+}
+
+template<typename E>
+VecScalarMul<E> operator*(double s, const VecExpr<E>& v) {
+    return VecScalarMul<E>(v, s);
+}
+
+// ============================================================================
+// Part 2.2: 一元表达式与融合归约
+// ============================================================================
+
+// 一元表达式：Op 同时提供标量版和 Packet 版，clamp 这类带参数的 Op 按值保存
+template<typename E, typename Op>
+class VecUnary : public VecExpr<VecUnary<E, Op>> {
+    const E& v_;
+    Op op_;
+public:
+    VecUnary(const E& v, Op op) : v_(v), op_(op) {}
+
+    double operator[](size_t i) const { return op_(v_[i]); }
+    Packet packet(size_t i) const { return op_(v_.packet(i)); }
+    static constexpr bool elementwise = E::elementwise;
+    bool aliases(const void* dest, bool reordered) const { return v_.aliases(dest, reordered); }
+    size_t size() const { return v_.size(); }
+};
+
+struct AbsOp {
+    double operator()(double x) const { return std::abs(x); }
+#if defined(__AVX2__) || defined(__AVX512F__)
+    Packet operator()(Packet x) const { return pabs(x); }
+#endif
+};
+
+struct SqrtOp {
+    double operator()(double x) const { return std::sqrt(x); }
+#if defined(__AVX2__) || defined(__AVX512F__)
+    Packet operator()(Packet x) const { return psqrt(x); }
+#endif
+};
+
+struct ExpOp {
+    double operator()(double x) const { return std::exp(x); }
+#if defined(__AVX2__) || defined(__AVX512F__)
+    Packet operator()(Packet x) const { return pexp(x); }
+#endif
+};
+
+struct ClampOp {
+    double lo, hi;
+    double operator()(double x) const { return std::min(std::max(x, lo), hi); }
+#if defined(__AVX2__) || defined(__AVX512F__)
+    Packet operator()(Packet x) const { return pmin(pmax(x, pset1(lo)), pset1(hi)); }
+#endif
+};
+
+template<typename E>
+VecUnary<E, AbsOp> abs(const VecExpr<E>& v) {
+    return VecUnary<E, AbsOp>(v, AbsOp{});
+}
+
+template<typename E>
+VecUnary<E, SqrtOp> sqrt(const VecExpr<E>& v) {
+    return VecUnary<E, SqrtOp>(v, SqrtOp{});
+}
+
+template<typename E>
+VecUnary<E, ExpOp> exp(const VecExpr<E>& v) {
+    return VecUnary<E, ExpOp>(v, ExpOp{});
+}
+
+template<typename E>
+VecUnary<E, ClampOp> clamp(const VecExpr<E>& v, double lo, double hi) {
+    return VecUnary<E, ClampOp>(v, ClampOp{ lo, hi });
+}
+
+// 归约策略：accumulate 把一个 Packet 并入累加器，merge 合并两个累加器，
+// accumulate_scalar 处理不足一个 Packet 的尾部元素
+struct SumReduce {
+    static double identity() { return 0.0; }
+    static Packet accumulate(Packet acc, Packet x) { return padd(acc, x); }
+    static Packet merge(Packet a, Packet b) { return padd(a, b); }
+    static double horizontal(Packet a) { return predux_add(a); }
+    static double accumulate_scalar(double acc, double x) { return acc + x; }
+};
+
+struct SumSquaresReduce {
+    static double identity() { return 0.0; }
+    static Packet accumulate(Packet acc, Packet x) { return pfmadd(x, x, acc); }
+    static Packet merge(Packet a, Packet b) { return padd(a, b); }
+    static double horizontal(Packet a) { return predux_add(a); }
+    static double accumulate_scalar(double acc, double x) { return acc + x * x; }
+};
+
+struct MaxReduce {
+    static double identity() { return -std::numeric_limits<double>::infinity(); }
+    static Packet accumulate(Packet acc, Packet x) { return pmax(acc, x); }
+    static Packet merge(Packet a, Packet b) { return pmax(a, b); }
+    static double horizontal(Packet a) { return predux_max(a); }
+    static double accumulate_scalar(double acc, double x) { return std::max(acc, x); }
+};
+
+struct MinReduce {
+    static double identity() { return std::numeric_limits<double>::infinity(); }
+    static Packet accumulate(Packet acc, Packet x) { return pmin(acc, x); }
+    static Packet merge(Packet a, Packet b) { return pmin(a, b); }
+    static double horizontal(Packet a) { return predux_min(a); }
+    static double accumulate_scalar(double acc, double x) { return std::min(acc, x); }
+};
+
+// 单次遍历：表达式逐 Packet 求值后直接并入累加器，不物化任何中间向量。
+// 4 个独立累加器隐藏加法/FMA 的 4 周期延迟（单累加器时每次迭代都要等上一次结果）
+template<typename Reduce, typename E>
+double reduce(const VecExpr<E>& expr) {
+    const E& e = expr;
+    const size_t n = e.size();
+    constexpr size_t kUnroll = 4;
+    Packet acc0 = pset1(Reduce::identity());
+    Packet acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+    size_t i = 0;
+    for (; i + kUnroll * kPacketSize <= n; i += kUnroll * kPacketSize) {
+        acc0 = Reduce::accumulate(acc0, e.packet(i));
+        acc1 = Reduce::accumulate(acc1, e.packet(i + kPacketSize));
+        acc2 = Reduce::accumulate(acc2, e.packet(i + 2 * kPacketSize));
+        acc3 = Reduce::accumulate(acc3, e.packet(i + 3 * kPacketSize));
+    }
+    for (; i + kPacketSize <= n; i += kPacketSize) {
+        acc0 = Reduce::accumulate(acc0, e.packet(i));
+    }
+
+    double result = Reduce::horizontal(
+        Reduce::merge(Reduce::merge(acc0, acc1), Reduce::merge(acc2, acc3)));
+    for (; i < n; ++i) {
+        result = Reduce::accumulate_scalar(result, e[i]);
+    }
+    return result;
+}
+
+template<typename E>
+double sum(const VecExpr<E>& e) { return reduce<SumReduce>(e); }
+
+template<typename E1, typename E2>
+double dot(const VecExpr<E1>& u, const VecExpr<E2>& v) { return reduce<SumReduce>(u * v); }
+
+template<typename E>
+double norm2(const VecExpr<E>& e) { return std::sqrt(reduce<SumSquaresReduce>(e)); }
+
+template<typename E>
+double max(const VecExpr<E>& e) { return reduce<MaxReduce>(e); }
+
+template<typename E>
+double min(const VecExpr<E>& e) { return reduce<MinReduce>(e); }
+
+// ============================================================================
+// Part 3: 矩阵表达式模板
+// ============================================================================
+
+template<typename E>
+class MatExpr {
+public:
+    double operator()(size_t i, size_t j) const {
+        return static_cast<const E&>(*this)(i, j);
+    }
+    
+    size_t rows() const { return static_cast<const E&>(*this).rows(); }
+    size_t cols() const { return static_cast<const E&>(*this).cols(); }
+    
+    // 求值 (i, j) 起的 kPacketSize x kPacketSize 块，每行一个 Packet
+    void block(size_t i, size_t j, PacketBlock& out) const {
+        static_cast<const E&>(*this).block(i, j, out);
+    }
+    
+    // 表达式是否读取 dest；reordered 表示当前位置读取的不是 (i, j) 本身
+    bool aliases(const void* dest, bool reordered) const {
+        return static_cast<const E&>(*this).aliases(dest, reordered);
+    }
+};
+
+template<typename E1, typename E2> class MatMul;
+template<typename E> struct HasTranspose;
+
+class Matrix : public MatExpr<Matrix> {
+    AlignedBuffer data_;
+    size_t rows_, cols_;
+
+    // 表达式赋值的分派（定义见 Part 3.1）：含 MatMul 的项走 GEMM，其余逐元素求值
+    template<typename E> void assign(const E& e);
+    template<typename T> void gemm_update(const T& product_term, double beta);
+
+    template<typename E>
+    void evaluate_rows(const E& e, size_t row_begin, size_t row_end) {
+        for (size_t i = row_begin; i < row_end; ++i) {
+            for (size_t j = 0; j < cols_; ++j) {
+                (*this)(i, j) = e(i, j);
+            }
+        }
+    }
+
+    // 缓存大小的方块内再按寄存器块求值：转置操作数每读一条缓存行就用满 8 个元素，
+    // 而不是逐元素跨行读取（每个元素一次缓存/TLB 缺失）
+    static constexpr size_t kTile = 64;
+
+    template<typename E>
+    void evaluate_tile(const E& e, size_t i0, size_t i1, size_t j0, size_t j1) {
+        size_t i = i0;
+        for (; i + kPacketSize <= i1; i += kPacketSize) {
+            size_t j = j0;
+            for (; j + kPacketSize <= j1; j += kPacketSize) {
+                PacketBlock b;
+                e.block(i, j, b);
+                for (size_t r = 0; r < kPacketSize; ++r) {
+                    pstoreu(&(*this)(i + r, j), b.row[r]);
+                }
+            }
+            for (; j < j1; ++j) {
+                for (size_t r = 0; r < kPacketSize; ++r) (*this)(i + r, j) = e(i + r, j);
+            }
+        }
+        for (; i < i1; ++i) {
+            for (size_t j = j0; j < j1; ++j) (*this)(i, j) = e(i, j);
+        }
+    }
+
+    template<typename E>
+    void evaluate_tiles(const E& e, size_t tile_row_begin, size_t tile_row_end) {
+        for (size_t ti = tile_row_begin; ti < tile_row_end; ++ti) {
+            const size_t i0 = ti * kTile, i1 = std::min(rows_, i0 + kTile);
+            for (size_t j0 = 0; j0 < cols_; j0 += kTile) {
+                evaluate_tile(e, i0, i1, j0, std::min(cols_, j0 + kTile));
+            }
+        }
+    }
+
+    // 按行分块并行：每个线程写连续的若干整行（含转置时为若干整条方块行）
+    template<typename E>
+    void evaluate(const E& e) {
+        const bool serial = rows_ * cols_ < parallel_threshold() || default_pool().size() == 1;
+        if constexpr (HasTranspose<E>::value) {
+            const size_t tile_rows = (rows_ + kTile - 1) / kTile;
+            if (serial) {
+                evaluate_tiles(e, 0, tile_rows);
+                return;
+            }
+            default_pool().parallel_for(tile_rows, 1, [&](size_t begin, size_t end) {
+                evaluate_tiles(e, begin, end);
+            });
+        } else {
+            if (serial) {
+                evaluate_rows(e, 0, rows_);
+                return;
+            }
+            default_pool().parallel_for(rows_, 1, [&](size_t begin, size_t end) {
+                evaluate_rows(e, begin, end);
+            });
+        }
+    }
+
+    Matrix(size_t m, size_t n, AlignedBuffer&& storage)
+        : data_(std::move(storage)), rows_(m), cols_(n) {}
+
+public:
+    static constexpr bool elementwise = true;
+
+    Matrix(size_t m, size_t n, double val = 0.0) 
+        : data_(m * n, val), rows_(m), cols_(n) {}
+    
+    template<typename E>
+    Matrix(const MatExpr<E>& expr) 
+        : data_(expr.rows() * expr.cols()), rows_(expr.rows()), cols_(expr.cols()) {
+        assign(static_cast<const E&>(expr));
+    }
+    
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    const double* data() const { return data_.data(); }
+    double* data() { return data_.data(); }
+    
+    double operator()(size_t i, size_t j) const {
+        return data_[i * cols_ + j];
+    }
+    
+    double& operator()(size_t i, size_t j) {
+        return data_[i * cols_ + j];
+    }
+    
+    void block(size_t i, size_t j, PacketBlock& out) const {
+        for (size_t r = 0; r < kPacketSize; ++r) {
+            out.row[r] = ploadu(&data_[(i + r) * cols_ + j]);
+        }
+    }
+    
+    bool aliases(const void* dest, bool reordered) const { return reordered && dest == this; }
+    
+    template<typename E>
+    Matrix& operator=(const MatExpr<E>& expr) {
+        assign(static_cast<const E&>(expr));
+        return *this;
+    }
+
+    // 逐行逐元素求值（不分块，用于对比）
+    template<typename E>
+    Matrix& assign_elementwise(const MatExpr<E>& expr) {
+        evaluate_rows(static_cast<const E&>(expr), 0, rows_);
+        return *this;
+    }
+};
+
+// 矩阵加法表达式
+template<typename E1, typename E2>
+class MatAdd : public MatExpr<MatAdd<E1, E2>> {
+    const E1& a_;
+    const E2& b_;
+public:
+    MatAdd(const E1& a, const E2& b) : a_(a), b_(b) {}
+    
+    double operator()(size_t i, size_t j) const {
+        return a_(i, j) + b_(i, j);
+    }
+    
+    void block(size_t i, size_t j, PacketBlock& out) const {
+        PacketBlock rhs;
+        a_.block(i, j, out);
+        b_.block(i, j, rhs);
+        for (size_t r = 0; r < kPacketSize; ++r) out.row[r] = padd(out.row[r], rhs.row[r]);
+    }
+    
+    static constexpr bool elementwise = E1::elementwise && E2::elementwise;
+    bool aliases(const void* dest, bool reordered) const {
+        return a_.aliases(dest, reordered) || b_.aliases(dest, reordered);
+    }
+    
+    const E1& lhs() const { return a_; }
+    const E2& rhs() const { return b_; }
+    size_t rows() const { return a_.rows(); }
+    size_t cols() const { return a_.cols(); }
+};
+
+// 矩阵标量乘法
+template<typename E>
+class MatScalarMul : public MatExpr<MatScalarMul<E>> {
+    const E& m_;
+    double scalar_;
+public:
+    MatScalarMul(const E& m, double s) : m_(m), scalar_(s) {}
+    
+    double operator()(size_t i, size_t j) const {
+        return m_(i, j) * scalar_;
+    }
+    
+    void block(size_t i, size_t j, PacketBlock& out) const {
+        m_.block(i, j, out);
+        for (size_t r = 0; r < kPacketSize; ++r) out.row[r] = pmul(out.row[r], pset1(scalar_));
+    }
+    
+    static constexpr bool elementwise = E::elementwise;
+    bool aliases(const void* dest, bool reordered) const { return m_.aliases(dest, reordered); }
+    
+    const E& operand() const { return m_; }
+    double scalar() const { return scalar_; }
+    size_t rows() const { return m_.rows(); }
+    size_t cols() const { return m_.cols(); }
+};
+
+// 矩阵转置表达式（零拷贝！）
+template<typename E>
+class MatTranspose : public MatExpr<MatTranspose<E>> {
+    const E& m_;
+public:
+    explicit MatTranspose(const E& m) : m_(m) {}
+    
+    double operator()(size_t i, size_t j) const {
+        return m_(j, i);  // 只是交换索引！
+    }
+    
+    // 读取源矩阵 (j, i) 处的块（每行连续），在寄存器中转置
+    void block(size_t i, size_t j, PacketBlock& out) const {
+        m_.block(j, i, out);
+        ptranspose(out);
+    }
+    
+    static constexpr bool elementwise = false;
+    bool aliases(const void* dest, bool) const { return m_.aliases(dest, true); }
+    
+    const E& operand() const { return m_; }
+    size_t rows() const { return m_.cols(); }
+    size_t cols() const { return m_.rows(); }
+};
+
+// 运算符重载
+template<typename E1, typename E2>
+MatAdd<E1, E2> operator+(const MatExpr<E1>& a, const MatExpr<E2>& b) {
+    return MatAdd<E1, E2>(static_cast<const E1&>(a), static_cast<const E2&>(b));
+}
+
+template<typename E>
+MatScalarMul<E> operator*(const MatExpr<E>& m, double s) {
+    return MatScalarMul<E>(static_cast<const E&>(m), s);
+}
+
+template<typename E>
+MatScalarMul<E> operator*(double s, const MatExpr<E>& m) {
+    return MatScalarMul<E>(static_cast<const E&>(m), s);
+}
+
+template<typename E>
+MatTranspose<E> transpose(const MatExpr<E>& m) {
+    return MatTranspose<E>(static_cast<const E&>(m));
+}
+
+// 表达式树中是否有转置操作数：有则 Matrix 按方块求值
+template<typename E>
+struct HasTranspose {
+    static constexpr bool value = false;
+};
+
+template<typename E>
+struct HasTranspose<MatTranspose<E>> {
+    static constexpr bool value = true;
+};
+
+template<typename E1, typename E2>
+struct HasTranspose<MatAdd<E1, E2>> {
+    static constexpr bool value = HasTranspose<E1>::value || HasTranspose<E2>::value;
+};
+
+template<typename E>
+struct HasTranspose<MatScalarMul<E>> {
+    static constexpr bool value = HasTranspose<E>::value;
+};
+
+// ============================================================================
+// Part 3.1: 矩阵乘法（MatMul 节点 + 分块打包 GEMM）
+// ============================================================================
+
+// 乘积不能逐元素求值：每个 (i, j) 都要读 A 的一整行和 B 的一整列。
+// MatMul 只记录两个操作数，赋值给 Matrix 时整体交给 gemm()
+template<typename E1, typename E2>
+class MatMul : public MatExpr<MatMul<E1, E2>> {
+    const E1& a_;
+    const E2& b_;
+
+    template<typename> static constexpr bool dependent_false = false;
+public:
+    MatMul(const E1& a, const E2& b) : a_(a), b_(b) {
+        if (a.cols() != b.rows()) {
+            throw std::invalid_argument("MatMul: inner dimensions do not match");
+        }
+    }
+
+    double operator()(size_t, size_t) const {
+        static_assert(dependent_false<E1>,
+                      "MatMul is not evaluated elementwise; assign the product (or a sum of "
+                      "scaled products and elementwise terms) to a Matrix first");
+        return 0.0;
+    }
+
+    // 乘积读取整行整列：任何操作数与目标重叠都不安全
+    static constexpr bool elementwise = false;
+    bool aliases(const void* dest, bool) const {
+        return a_.aliases(dest, true) || b_.aliases(dest, true);
+    }
+    
+    const E1& lhs() const { return a_; }
+    const E2& rhs() const { return b_; }
+    size_t rows() const { return a_.rows(); }
+    size_t cols() const { return b_.cols(); }
+};
+
+template<typename E1, typename E2>
+MatMul<E1, E2> operator*(const MatExpr<E1>& a, const MatExpr<E2>& b) {
+    return MatMul<E1, E2>(static_cast<const E1&>(a), static_cast<const E2&>(b));
+}
+
+// ---------------------------------------------------------------------------
+// GEMM 内核：C = alpha * op(A) * op(B) + beta * C，行主序，op 为转置或不转置
+// 三层分块（NC/KC/MC）让 B 面板留在 L3、A 块留在 L2、B 微面板留在 L1；
+// 打包后微内核只做连续的对齐加载，转置在打包时一次性处理
+// ---------------------------------------------------------------------------
+
+namespace gemm_detail {
+
+constexpr size_t MR = 6;                    // 微内核行数
+constexpr size_t NR = 2 * kPacketSize;      // 微内核列数（2 个 Packet）
+constexpr size_t MC = 16 * MR;              // 96
+constexpr size_t KC = 256;
+constexpr size_t NC = 2048 / NR * NR;
+
+using Buffer = AlignedBuffer;
+
+// op(X)(r, c)：trans 时按列读取原矩阵
+inline double at(const double* x, size_t ld, bool trans, size_t r, size_t c) {
+    return trans ? x[c * ld + r] : x[r * ld + c];
+}
+
+// A 的 mc x kc 块 → 若干 MR 行微面板，每个面板内按 k 连续存放 MR 个元素，边缘补 0
+inline void pack_a(double* dst, const double* a, size_t lda, bool trans,
+                   size_t i0, size_t k0, size_t mc, size_t kc) {
+    for (size_t ir = 0; ir < mc; ir += MR) {
+        for (size_t p = 0; p < kc; ++p) {
+            for (size_t r = 0; r < MR; ++r) {
+                *dst++ = (ir + r < mc) ? at(a, lda, trans, i0 + ir + r, k0 + p) : 0.0;
+            }
+        }
+    }
+}
+
+// B 的 kc x nc 面板 → 若干 NR 列微面板，每个面板内按 k 连续存放 NR 个元素，边缘补 0
+inline void pack_b(double* dst, const double* b, size_t ldb, bool trans,
+                   size_t k0, size_t j0, size_t kc, size_t nc) {
+    for (size_t jr = 0; jr < nc; jr += NR) {
+        for (size_t p = 0; p < kc; ++p) {
+            for (size_t c = 0; c < NR; ++c) {
+                *dst++ = (jr + c < nc) ? at(b, ldb, trans, k0 + p, j0 + jr + c) : 0.0;
+            }
+        }
+    }
+}
+
+// MR x NR 的 C 子块常驻寄存器（12 个累加器），每步一次 A 广播 + 2 次 B 加载 + 2 次 FMA。
+// beta == 0 时直接覆盖 C（不读取未初始化的目标）
+inline void micro_kernel(size_t kc, const double* ap, const double* bp,
+                         double* c, size_t ldc, size_t mr, size_t nr,
+                         double alpha, double beta) {
+    Packet acc[MR][2];
+    for (size_t r = 0; r < MR; ++r) {
+        acc[r][0] = pset1(0.0);
+        acc[r][1] = pset1(0.0);
+    }
+    for (size_t p = 0; p < kc; ++p) {
+        Packet b0 = pload(bp);
+        Packet b1 = pload(bp + kPacketSize);
+        for (size_t r = 0; r < MR; ++r) {
+            Packet a = pset1(ap[r]);
+            acc[r][0] = pfmadd(a, b0, acc[r][0]);
+            acc[r][1] = pfmadd(a, b1, acc[r][1]);
+        }
+        ap += MR;
+        bp += NR;
+    }
+
+    const Packet va = pset1(alpha), vb = pset1(beta);
+    if (mr == MR && nr == NR) {
+        for (size_t r = 0; r < MR; ++r) {
+            for (size_t h = 0; h < 2; ++h) {
+                double* dst = c + r * ldc + h * kPacketSize;
+                Packet v = pmul(acc[r][h], va);
+                if (beta != 0.0) v = pfmadd(ploadu(dst), vb, v);
+                pstoreu(dst, v);
+            }
+        }
+        return;
+    }
+
+    // 边缘子块：先落到栈上，再按实际行列数写回
+    alignas(64) double tile[MR * NR];
+    for (size_t r = 0; r < MR; ++r) {
+        pstore(tile + r * NR, acc[r][0]);
+        pstore(tile + r * NR + kPacketSize, acc[r][1]);
+    }
+    for (size_t r = 0; r < mr; ++r) {
+        for (size_t j = 0; j < nr; ++j) {
+            double v = alpha * tile[r * NR + j];
+            c[r * ldc + j] = (beta != 0.0) ? v + beta * c[r * ldc + j] : v;
+        }
+    }
+}
+
+} // namespace gemm_detail
+
+inline void gemm(bool trans_a, bool trans_b, size_t m, size_t n, size_t k, double alpha,
+                 const double* a, size_t lda, const double* b, size_t ldb,
+                 double beta, double* c, size_t ldc) {
+    using namespace gemm_detail;
+
+    if (k == 0) {
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                c[i * ldc + j] = (beta != 0.0) ? beta * c[i * ldc + j] : 0.0;
+            }
+        }
+        return;
+    }
+
+    thread_local Buffer packed_b;
+    packed_b.resize(KC * NC);
+    const size_t m_blocks = (m + MC - 1) / MC;
+    const bool parallel = m * n * k >= 64 * parallel_threshold() && m_blocks > 1;
+
+    for (size_t jc = 0; jc < n; jc += NC) {
+        const size_t nc = std::min(NC, n - jc);
+        for (size_t pc = 0; pc < k; pc += KC) {
+            const size_t kc = std::min(KC, k - pc);
+            // 只有第一个 k 块应用 beta，之后都是累加
+            const double beta_eff = (pc == 0) ? beta : 1.0;
+            pack_b(packed_b.data(), b, ldb, trans_b, pc, jc, kc, nc);
+            const double* bp_base = packed_b.data();
+
+            // 各线程处理不同的 MC 行块：自己打包 A，共享只读的 B 面板
+            auto run_blocks = [&](size_t block_begin, size_t block_end) {
+                thread_local Buffer packed_a;
+                packed_a.resize(MC * KC);
+                for (size_t blk = block_begin; blk < block_end; ++blk) {
+                    const size_t ic = blk * MC;
+                    const size_t mc = std::min(MC, m - ic);
+                    pack_a(packed_a.data(), a, lda, trans_a, ic, pc, mc, kc);
+                    for (size_t jr = 0; jr < nc; jr += NR) {
+                        for (size_t ir = 0; ir < mc; ir += MR) {
+                            micro_kernel(kc, packed_a.data() + ir * kc, bp_base + jr * kc,
+                                         c + (ic + ir) * ldc + jc + jr, ldc,
+                                         std::min(MR, mc - ir), std::min(NR, nc - jr),
+                                         alpha, beta_eff);
+                        }
+                    }
+                }
+            };
+            if (parallel) {
+                default_pool().parallel_for(m_blocks, 1, run_blocks);
+            } else {
+                run_blocks(0, m_blocks);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 表达式 → GEMM 参数
+// ---------------------------------------------------------------------------
+
+// GEMM 操作数：剥掉外层的 transpose / 标量乘，落到一个连续存储的 Matrix 上。
+// 其他表达式（如 A + B）先物化成临时矩阵
+template<typename E>
+class GemmOperand {
+    Matrix tmp_;
+public:
+    explicit GemmOperand(const E& e) : tmp_(e) {}
+    const Matrix& matrix() const { return tmp_; }
+    bool transposed() const { return false; }
+    double scale() const { return 1.0; }
+};
+
+template<>
+class GemmOperand<Matrix> {
+    const Matrix& m_;
+public:
+    explicit GemmOperand(const Matrix& m) : m_(m) {}
+    const Matrix& matrix() const { return m_; }
+    bool transposed() const { return false; }
+    double scale() const { return 1.0; }
+};
+
+template<typename E>
+class GemmOperand<MatTranspose<E>> {
+    GemmOperand<E> inner_;
+public:
+    explicit GemmOperand(const MatTranspose<E>& t) : inner_(t.operand()) {}
+    const Matrix& matrix() const { return inner_.matrix(); }
+    bool transposed() const { return !inner_.transposed(); }
+    double scale() const { return inner_.scale(); }
+};
+
+template<typename E>
+class GemmOperand<MatScalarMul<E>> {
+    GemmOperand<E> inner_;
+    double scalar_;
+public:
+    explicit GemmOperand(const MatScalarMul<E>& s) : inner_(s.operand()), scalar_(s.scalar()) {}
+    const Matrix& matrix() const { return inner_.matrix(); }
+    bool transposed() const { return inner_.transposed(); }
+    double scale() const { return scalar_ * inner_.scale(); }
+};
+
+// 乘积项：MatMul 或其标量倍（alpha * (A * B)、A * B * alpha）
+template<typename E>
+struct ProductTerm {
+    static constexpr bool value = false;
+};
+
+template<typename E1, typename E2>
+struct ProductTerm<MatMul<E1, E2>> {
+    static constexpr bool value = true;
+    static const MatMul<E1, E2>& product(const MatMul<E1, E2>& e) { return e; }
+    static double scale(const MatMul<E1, E2>&) { return 1.0; }
+};
+
+template<typename E>
+struct ProductTerm<MatScalarMul<E>> {
+    static constexpr bool value = ProductTerm<E>::value;
+    static const auto& product(const MatScalarMul<E>& e) { return ProductTerm<E>::product(e.operand()); }
+    static double scale(const MatScalarMul<E>& e) { return e.scalar() * ProductTerm<E>::scale(e.operand()); }
+};
+
+// 加法树中是否出现乘积项
+template<typename E>
+struct ContainsProduct {
+    static constexpr bool value = ProductTerm<E>::value;
+};
+
+template<typename E1, typename E2>
+struct ContainsProduct<MatAdd<E1, E2>> {
+    static constexpr bool value = ContainsProduct<E1>::value || ContainsProduct<E2>::value;
+};
+
+// 加法树中除乘积项以外的部分（乘积项按 0 计）
+template<typename E>
+double elementwise_part(const E& e, size_t i, size_t j) {
+    if constexpr (ProductTerm<E>::value) {
+        return 0.0;
+    } else if constexpr (ContainsProduct<E>::value) {
+        return elementwise_part(e.lhs(), i, j) + elementwise_part(e.rhs(), i, j);
+    } else {
+        return e(i, j);
+    }
+}
+
+template<typename E, typename F>
+void for_each_product(const E& e, F&& f) {
+    if constexpr (ProductTerm<E>::value) {
+        f(e);
+    } else if constexpr (ContainsProduct<E>::value) {
+        for_each_product(e.lhs(), f);
+        for_each_product(e.rhs(), f);
+    }
+}
+
+// 识别 beta * C 或 C 本身（C 为赋值目标），用于把 C = alpha*A*B + beta*C 映射为一次 GEMM
+template<typename E>
+bool as_scaled_destination(const E& e, const Matrix& dest, double& beta) {
+    if constexpr (std::is_same_v<E, Matrix>) {
+        beta = 1.0;
+        return &e == &dest;
+    } else if constexpr (std::is_same_v<E, MatScalarMul<Matrix>>) {
+        beta = e.scalar();
+        return &e.operand() == &dest;
+    } else {
+        return false;
+    }
+}
+
+// gemm() 直接按目标的 rows/cols 写缓冲区，按操作数底层矩阵的行宽读：
+// 形状不符时会越界，必须在调用前检查（转置操作数按转置后的逻辑形状比较）
+template<typename T>
+void check_product_shape(const T& term, size_t rows, size_t cols) {
+    const auto& product = ProductTerm<T>::product(term);
+    if (product.lhs().cols() != product.rhs().rows()) {
+        throw std::invalid_argument("Matrix: product inner dimensions do not match");
+    }
+    if (product.lhs().rows() != rows || product.rhs().cols() != cols) {
+        throw std::invalid_argument("Matrix: product shape does not match destination");
+    }
+}
+
+template<typename T>
+void Matrix::gemm_update(const T& term, double beta) {
+    const auto& product = ProductTerm<T>::product(term);
+    using Product = std::decay_t<decltype(product)>;
+    using Lhs = std::decay_t<decltype(product.lhs())>;
+    using Rhs = std::decay_t<decltype(product.rhs())>;
+    static_assert(ProductTerm<Product>::value);
+    check_product_shape(term, rows_, cols_);
+
+    GemmOperand<Lhs> a(product.lhs());
+    GemmOperand<Rhs> b(product.rhs());
+    const double alpha = ProductTerm<T>::scale(term) * a.scale() * b.scale();
+    gemm(a.transposed(), b.transposed(), rows_, cols_, product.lhs().cols(), alpha,
+         a.matrix().data(), a.matrix().cols(), b.matrix().data(), b.matrix().cols(),
+         beta, data_.data(), cols_);
+}
+
+template<typename E>
+void Matrix::assign(const E& e) {
+    if constexpr (!E::elementwise) {
+        // 目标出现在转置/乘积操作数中（A = transpose(A)、C = C * B）：
+        // 求值到池中的临时缓冲区后交换存储，顺带支持非方阵的 A = transpose(A)
+        if (e.aliases(this, false)) {
+            Matrix tmp(e.rows(), e.cols(), scratch_pool().acquire(e.rows() * e.cols()));
+            tmp.assign(e);
+            data_.swap(tmp.data_);
+            rows_ = tmp.rows_;
+            cols_ = tmp.cols_;
+            scratch_pool().release(std::move(tmp.data_));
+            return;
+        }
+    }
+    if constexpr (!ContainsProduct<E>::value) {
+        evaluate(e);
+    } else if constexpr (ProductTerm<E>::value) {
+        gemm_update(e, 0.0);
+    } else {
+        // C = P + beta*C 或 C = beta*C + P：一次 GEMM，beta 在内核写回时融合
+        if constexpr (ProductTerm<std::decay_t<decltype(e.lhs())>>::value) {
+            double beta;
+            if (as_scaled_destination(e.rhs(), *this, beta)) {
+                gemm_update(e.lhs(), beta);
+                return;
+            }
+        }
+        if constexpr (ProductTerm<std::decay_t<decltype(e.rhs())>>::value) {
+            double beta;
+            if (as_scaled_destination(e.lhs(), *this, beta)) {
+                gemm_update(e.rhs(), beta);
+                return;
+            }
+        }
+        // 一般情况：先一次遍历求出逐元素部分，再把每个乘积项累加上去。
+        // 形状在写目标之前全部检查，失败时目标保持原值
+        for_each_product(e, [&](const auto& term) { check_product_shape(term, rows_, cols_); });
+        evaluate([&](size_t i, size_t j) { return elementwise_part(e, i, j); });
+        for_each_product(e, [&](const auto& term) { gemm_update(term, 1.0); });
+    }
+}
+
+// ============================================================================
+// Part 3.2: 固定尺寸向量/矩阵（栈上存储 + 编译期展开）
+// ============================================================================
+
+// 小尺寸（3D 坐标、4x4 变换）时，动态版本的堆分配、运行期循环和尾部处理
+// 都比计算本身贵。尺寸是模板参数后，求值循环可以在编译期完全展开
+constexpr size_t kFixedUnrollLimit = 64;  // 超过该元素数改用普通循环，避免代码膨胀
+
+template<size_t N>
+class FixedVector : public VecExpr<FixedVector<N>> {
+    alignas(64) std::array<double, N> data_{};
+
+    static constexpr size_t kPackets = N / kPacketSize;
+
+    template<typename E, size_t... P, size_t... T>
+    void evaluate_unrolled(const E& e, std::index_sequence<P...>, std::index_sequence<T...>) {
+        (pstore(data_.data() + P * kPacketSize, e.packet(P * kPacketSize)), ...);
+        ((data_[kPackets * kPacketSize + T] = e[kPackets * kPacketSize + T]), ...);
+    }
+
+    template<typename E>
+    void evaluate(const E& e) {
+        if (e.size() != N) {
+            throw std::invalid_argument("FixedVector: expression size does not match N");
+        }
+        if constexpr (N <= kFixedUnrollLimit) {
+            evaluate_unrolled(e, std::make_index_sequence<kPackets>{},
+                              std::make_index_sequence<N - kPackets * kPacketSize>{});
+        } else {
+            size_t i = 0;
+            for (; i < kPackets * kPacketSize; i += kPacketSize) pstore(data_.data() + i, e.packet(i));
+            for (; i < N; ++i) data_[i] = e[i];
+        }
+    }
+
+public:
+    static constexpr bool elementwise = true;
+
+    FixedVector() = default;
+    explicit FixedVector(double val) { data_.fill(val); }
+    FixedVector(std::initializer_list<double> init) {
+        if (init.size() != N) {
+            throw std::invalid_argument("FixedVector: initializer size does not match N");
+        }
+        std::copy(init.begin(), init.end(), data_.begin());
+    }
+
+    template<typename E>
+    FixedVector(const VecExpr<E>& expr) { evaluate(static_cast<const E&>(expr)); }
+
+    template<typename E>
+    FixedVector& operator=(const VecExpr<E>& expr) {
+        const E& e = expr;
+        if constexpr (!E::elementwise) {
+            // 栈上的临时副本就是最便宜的 scratch
+            if (e.aliases(this, false)) {
+                FixedVector tmp(e);
+                data_ = tmp.data_;
+                return *this;
+            }
+        }
+        evaluate(e);
+        return *this;
+    }
+
+    static constexpr size_t size() { return N; }
+    double operator[](size_t i) const { return data_[i]; }
+    double& operator[](size_t i) { return data_[i]; }
+    Packet packet(size_t i) const { return pload(data_.data() + i); }
+    bool aliases(const void* dest, bool reordered) const { return reordered && dest == this; }
+};
+
+template<size_t R, size_t C>
+class FixedMatrix : public MatExpr<FixedMatrix<R, C>> {
+    alignas(64) std::array<double, R * C> data_{};
+
+    template<typename E, size_t... I>
+    void evaluate_unrolled(const E& e, std::index_sequence<I...>) {
+        ((data_[I] = e(I / C, I % C)), ...);
+    }
+
+    template<typename E>
+    void evaluate(const E& e) {
+        if constexpr (R * C <= kFixedUnrollLimit) {
+            evaluate_unrolled(e, std::make_index_sequence<R * C>{});
+        } else {
+            for (size_t i = 0; i < R; ++i)
+                for (size_t j = 0; j < C; ++j) data_[i * C + j] = e(i, j);
+        }
+    }
+
+    // 小矩阵乘积不值得打包：直接三重循环，内两层尺寸是编译期常量
+    template<typename T>
+    void add_product(const T& term) {
+        const auto& product = ProductTerm<T>::product(term);
+        const double alpha = ProductTerm<T>::scale(term);
+        const auto& a = product.lhs();
+        const auto& b = product.rhs();
+        const size_t k_dim = a.cols();
+        // 先在局部数组中累加：编译器无需担心写 data_ 会改变操作数，可以整块放进寄存器
+        std::array<double, R * C> acc{};
+        for (size_t i = 0; i < R; ++i) {
+            for (size_t k = 0; k < k_dim; ++k) {
+                const double aik = a(i, k);
+                for (size_t j = 0; j < C; ++j) acc[i * C + j] += aik * b(k, j);
+            }
+        }
+        for (size_t i = 0; i < R * C; ++i) data_[i] += alpha * acc[i];
+    }
+
+    template<typename E>
+    void assign(const E& e) {
+        if (e.rows() != R || e.cols() != C) {
+            throw std::invalid_argument("FixedMatrix: expression shape does not match R x C");
+        }
+        if constexpr (!E::elementwise) {
+            if (e.aliases(this, false)) {
+                FixedMatrix tmp(e);
+                data_ = tmp.data_;
+                return;
+            }
+        }
+        if constexpr (ContainsProduct<E>::value) {
+            // 逐元素部分先写入（乘积项按 0 计），再把每个乘积累加上去
+            evaluate([&](size_t i, size_t j) { return elementwise_part(e, i, j); });
+            for_each_product(e, [&](const auto& term) { add_product(term); });
+        } else {
+            evaluate(e);
+        }
+    }
+
+public:
+    static constexpr bool elementwise = true;
+
+    FixedMatrix() = default;
+    explicit FixedMatrix(double val) { data_.fill(val); }
+
+    template<typename E>
+    FixedMatrix(const MatExpr<E>& expr) { assign(static_cast<const E&>(expr)); }
+
+    template<typename E>
+    FixedMatrix& operator=(const MatExpr<E>& expr) {
+        assign(static_cast<const E&>(expr));
+        return *this;
+    }
+
+    static constexpr size_t rows() { return R; }
+    static constexpr size_t cols() { return C; }
+    double operator()(size_t i, size_t j) const { return data_[i * C + j]; }
+    double& operator()(size_t i, size_t j) { return data_[i * C + j]; }
+    const double* data() const { return data_.data(); }
+
+    void block(size_t i, size_t j, PacketBlock& out) const {
+        for (size_t r = 0; r < kPacketSize; ++r) out.row[r] = ploadu(&data_[(i + r) * C + j]);
+    }
+
+    bool aliases(const void* dest, bool reordered) const { return reordered && dest == this; }
+};
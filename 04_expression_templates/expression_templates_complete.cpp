@@ -1,5 +1,5 @@
 // 表达式模板：让临时对象彻底消失
-// 实现一个 mini 版本的 Eigen 风格矩阵库
+// 实现一个 mini 版本的 Eigen 风格矩阵库（库本体见 expression_templates.hpp）
 
 #include <iostream>
 #include <vector>
@@ -7,7 +7,11 @@
 #include <cmath>
 #include <iomanip>
 #include <random>
+#include <algorithm>
+#include <thread>
+#include <atomic>
 
+#include "expression_templates.hpp"
 // ============================================================================
 // Part 1: 朴素实现（大量临时对象）
 // ============================================================================
@@ -48,263 +52,6 @@ public:
     }
 };
 
-// ============================================================================
-// Part 2: 表达式模板实现（零临时对象）
-// ============================================================================
-
-// 表达式基类（CRTP）
-template<typename E>
-class VecExpr {
-public:
-    double operator[](size_t i) const {
-        return static_cast<const E&>(*this)[i];
-    }
-    
-    size_t size() const {
-        return static_cast<const E&>(*this).size();
-    }
-    
-    operator E&() { return static_cast<E&>(*this); }
-    operator const E&() const { return static_cast<const E&>(*this); }
-};
-
-// 实际的向量类
-class Vector : public VecExpr<Vector> {
-    std::vector<double> data_;
-public:
-    explicit Vector(size_t n, double val = 0.0) : data_(n, val) {}
-    Vector(std::initializer_list<double> init) : data_(init) {}
-    
-    // 从表达式构造（关键！）
-    template<typename E>
-    Vector(const VecExpr<E>& expr) : data_(expr.size()) {
-        for (size_t i = 0; i < size(); ++i) {
-            data_[i] = expr[i];
-        }
-    }
-    
-    size_t size() const { return data_.size(); }
-    double operator[](size_t i) const { return data_[i]; }
-    double& operator[](size_t i) { return data_[i]; }
-    
-    // 从表达式赋值
-    template<typename E>
-    Vector& operator=(const VecExpr<E>& expr) {
-        for (size_t i = 0; i < size(); ++i) {
-            data_[i] = expr[i];
-        }
-        return *this;
-    }
-};
-
-// 加法表达式（不存储数据，只存储引用）
-template<typename E1, typename E2>
-class VecAdd : public VecExpr<VecAdd<E1, E2>> {
-    const E1& u_;
-    const E2& v_;
-public:
-    VecAdd(const E1& u, const E2& v) : u_(u), v_(v) {}
-    
-    double operator[](size_t i) const {
-        return u_[i] + v_[i];
-    }
-    
-    size_t size() const { return u_.size(); }
-};
-
-// 标量乘法表达式
-template<typename E>
-class VecScalarMul : public VecExpr<VecScalarMul<E>> {
-    const E& v_;
-    double scalar_;
-public:
-    VecScalarMul(const E& v, double s) : v_(v), scalar_(s) {}
-    
-    double operator[](size_t i) const {
-        return v_[i] * scalar_;
-    }
-    
-    size_t size() const { return v_.size(); }
-};
-
-// 减法表达式
-template<typename E1, typename E2>
-class VecSub : public VecExpr<VecSub<E1, E2>> {
-    const E1& u_;
-    const E2& v_;
-public:
-    VecSub(const E1& u, const E2& v) : u_(u), v_(v) {}
-    
-    double operator[](size_t i) const {
-        return u_[i] - v_[i];
-    }
-    
-    size_t size() const { return u_.size(); }
-};
-
-// 元素乘法表达式
-template<typename E1, typename E2>
-class VecMul : public VecExpr<VecMul<E1, E2>> {
-    const E1& u_;
-    const E2& v_;
-public:
-    VecMul(const E1& u, const E2& v) : u_(u), v_(v) {}
-    
-    double operator[](size_t i) const {
-        return u_[i] * v_[i];
-    }
-    
-    size_t size() const { return u_.size(); }
-};
-
-// 运算符重载
-template<typename E1, typename E2>
-VecAdd<E1, E2> operator+(const VecExpr<E1>& u, const VecExpr<E2>& v) {
-    return VecAdd<E1, E2>(u, v);
-}
-
-template<typename E1, typename E2>
-VecSub<E1, E2> operator-(const VecExpr<E1>& u, const VecExpr<E2>& v) {
-    return VecSub<E1, E2>(u, v);
-}
-
-template<typename E1, typename E2>
-VecMul<E1, E2> operator*(const VecExpr<E1>& u, const VecExpr<E2>& v) {
-    return VecMul<E1, E2>(u, v);
-}
-
-template<typename E>
-VecScalarMul<E> operator*(const VecExpr<E>& v, double s) {
-    return VecScalarMul<E>(v, s);
-}
-
-template<typename E>
-VecScalarMul<E> operator*(double s, const VecExpr<E>& v) {
-    return VecScalarMul<E>(v, s);
-}
-
-// ============================================================================
-// Part 3: 矩阵表达式模板
-// ============================================================================
-
-template<typename E>
-class MatExpr {
-public:
-    double operator()(size_t i, size_t j) const {
-        return static_cast<const E&>(*this)(i, j);
-    }
-    
-    size_t rows() const { return static_cast<const E&>(*this).rows(); }
-    size_t cols() const { return static_cast<const E&>(*this).cols(); }
-};
-
-class Matrix : public MatExpr<Matrix> {
-    std::vector<double> data_;
-    size_t rows_, cols_;
-public:
-    Matrix(size_t m, size_t n, double val = 0.0) 
-        : data_(m * n, val), rows_(m), cols_(n) {}
-    
-    template<typename E>
-    Matrix(const MatExpr<E>& expr) 
-        : data_(expr.rows() * expr.cols()), rows_(expr.rows()), cols_(expr.cols()) {
-        for (size_t i = 0; i < rows_; ++i) {
-            for (size_t j = 0; j < cols_; ++j) {
-                (*this)(i, j) = expr(i, j);
-            }
-        }
-    }
-    
-    size_t rows() const { return rows_; }
-    size_t cols() const { return cols_; }
-    
-    double operator()(size_t i, size_t j) const {
-        return data_[i * cols_ + j];
-    }
-    
-    double& operator()(size_t i, size_t j) {
-        return data_[i * cols_ + j];
-    }
-    
-    template<typename E>
-    Matrix& operator=(const MatExpr<E>& expr) {
-        for (size_t i = 0; i < rows_; ++i) {
-            for (size_t j = 0; j < cols_; ++j) {
-                (*this)(i, j) = expr(i, j);
-            }
-        }
-        return *this;
-    }
-};
-
-// 矩阵加法表达式
-template<typename E1, typename E2>
-class MatAdd : public MatExpr<MatAdd<E1, E2>> {
-    const E1& a_;
-    const E2& b_;
-public:
-    MatAdd(const E1& a, const E2& b) : a_(a), b_(b) {}
-    
-    double operator()(size_t i, size_t j) const {
-        return a_(i, j) + b_(i, j);
-    }
-    
-    size_t rows() const { return a_.rows(); }
-    size_t cols() const { return a_.cols(); }
-};
-
-// 矩阵标量乘法
-template<typename E>
-class MatScalarMul : public MatExpr<MatScalarMul<E>> {
-    const E& m_;
-    double scalar_;
-public:
-    MatScalarMul(const E& m, double s) : m_(m), scalar_(s) {}
-    
-    double operator()(size_t i, size_t j) const {
-        return m_(i, j) * scalar_;
-    }
-    
-    size_t rows() const { return m_.rows(); }
-    size_t cols() const { return m_.cols(); }
-};
-
-// 矩阵转置表达式（零拷贝！）
-template<typename E>
-class MatTranspose : public MatExpr<MatTranspose<E>> {
-    const E& m_;
-public:
-    explicit MatTranspose(const E& m) : m_(m) {}
-    
-    double operator()(size_t i, size_t j) const {
-        return m_(j, i);  // 只是交换索引！
-    }
-    
-    size_t rows() const { return m_.cols(); }
-    size_t cols() const { return m_.rows(); }
-};
-
-// 运算符重载
-template<typename E1, typename E2>
-MatAdd<E1, E2> operator+(const MatExpr<E1>& a, const MatExpr<E2>& b) {
-    return MatAdd<E1, E2>(static_cast<const E1&>(a), static_cast<const E2&>(b));
-}
-
-template<typename E>
-MatScalarMul<E> operator*(const MatExpr<E>& m, double s) {
-    return MatScalarMul<E>(static_cast<const E&>(m), s);
-}
-
-template<typename E>
-MatScalarMul<E> operator*(double s, const MatExpr<E>& m) {
-    return MatScalarMul<E>(static_cast<const E&>(m), s);
-}
-
-template<typename E>
-MatTranspose<E> transpose(const MatExpr<E>& m) {
-    return MatTranspose<E>(static_cast<const E&>(m));
-}
-
 // ============================================================================
 // Part 4: 性能测试
 // ============================================================================
@@ -398,6 +145,108 @@ int main() {
 
     std::cout << "\nSpeedup: " << (naive_complex_time / expr_complex_time) << "x\n\n";
 
+    // ========================================
+    // 测试 2b: SIMD Packet 求值 vs 标量表达式路径
+    // ========================================
+    std::cout << "Test 2b: Packet (SIMD) vs Scalar Expression Evaluation\n";
+    std::cout << "------------------------------------------------\n";
+    std::cout << "Packet width: " << kPacketSize << " doubles ("
+              << kPacketSize * 64 << "-bit)\n";
+
+    // 奇数长度：覆盖尾部标量处理
+    constexpr size_t N_ODD = N + 3;
+    Vector a2(N_ODD), b2(N_ODD), c2(N_ODD), r_packet(N_ODD), r_scalar(N_ODD);
+    for (size_t i = 0; i < N_ODD; ++i) {
+        a2[i] = dist(rng);
+        b2[i] = dist(rng);
+        c2[i] = dist(rng);
+    }
+
+    double scalar_path_time = benchmark("Scalar ET path: a*2 + b*3 - c", [&]() {
+        r_scalar.assign_scalar(a2 * 2.0 + b2 * 3.0 - c2);
+    }, ITERS);
+
+    double packet_path_time = benchmark("Packet ET path: a*2 + b*3 - c", [&]() {
+        r_packet = a2 * 2.0 + b2 * 3.0 - c2;
+    }, ITERS);
+
+    // 标量路径可能被编译器收缩为 FMA，因此按相对误差比较而不是逐位比较
+    double max_rel_err = 0.0;
+    for (size_t i = 0; i < N_ODD; ++i) {
+        double diff = std::abs(r_packet[i] - r_scalar[i]);
+        max_rel_err = std::max(max_rel_err, diff / std::max(std::abs(r_scalar[i]), 1.0));
+    }
+    std::cout << "\nMax relative error vs scalar (incl. tail): " << std::scientific
+              << max_rel_err << std::fixed << (max_rel_err < 1e-14 ? " (ok)" : " (MISMATCH!)") << "\n";
+    std::cout << "Speedup vs scalar ET: " << (scalar_path_time / packet_path_time) << "x\n";
+    std::cout << "Speedup vs naive:     " << (naive_complex_time / packet_path_time) << "x\n\n";
+
+    // ========================================
+    // 测试 2c: 融合归约与一元表达式
+    // ========================================
+    std::cout << "Test 2c: Fused Reductions (size = " << N_ODD << ")\n";
+    std::cout << "------------------------------------------------\n";
+
+    // 对照组：先物化表达式结果，再用单累加器循环归约
+    auto naive_sum = [](const Vector& v) {
+        double s = 0.0;
+        for (size_t i = 0; i < v.size(); ++i) s += v[i];
+        return s;
+    };
+    volatile double sink = 0.0;
+    Vector tmp(N_ODD);
+
+    double naive_dot_time = benchmark("Materialize + 1 acc: dot(a, b)", [&]() {
+        asm volatile("" : : : "memory");
+        tmp = a2 * b2;
+        sink = naive_sum(tmp);
+    }, ITERS);
+    double fused_dot_time = benchmark("Fused 4 acc: dot(a, b)", [&]() {
+        asm volatile("" : : : "memory");
+        sink = dot(a2, b2);
+    }, ITERS);
+
+    double naive_norm_time = benchmark("Materialize + 1 acc: norm2(a - b)", [&]() {
+        asm volatile("" : : : "memory");
+        tmp = (a2 - b2) * (a2 - b2);
+        sink = std::sqrt(naive_sum(tmp));
+    }, ITERS);
+    double fused_norm_time = benchmark("Fused 4 acc: norm2(a - b)", [&]() {
+        asm volatile("" : : : "memory");
+        sink = norm2(a2 - b2);
+    }, ITERS);
+
+    benchmark("Fused: max(abs(a - b))", [&]() {
+        asm volatile("" : : : "memory");
+        sink = max(abs(a2 - b2));
+    }, ITERS);
+    benchmark("Fused: sum(sqrt(a) + exp(b))", [&]() {
+        asm volatile("" : : : "memory");
+        sink = sum(sqrt(a2) + exp(b2));
+    }, 10);
+    (void)sink;
+
+    // 正确性：与逐元素标量计算对照（尾部 3 个元素也在其中）
+    double ref_dot = 0.0, ref_norm = 0.0, ref_max = -1.0, ref_min = 2.0, ref_sum = 0.0;
+    for (size_t i = 0; i < N_ODD; ++i) {
+        ref_dot += a2[i] * b2[i];
+        ref_norm += (a2[i] - b2[i]) * (a2[i] - b2[i]);
+        ref_max = std::max(ref_max, std::abs(a2[i] - b2[i]));
+        ref_min = std::min(ref_min, std::min(std::max(c2[i], 0.25), 0.75));
+        ref_sum += std::sqrt(a2[i]) + std::exp(b2[i]);
+    }
+    ref_norm = std::sqrt(ref_norm);
+    auto rel = [](double x, double ref) { return std::abs(x - ref) / std::abs(ref); };
+    bool reductions_ok = rel(dot(a2, b2), ref_dot) < 1e-12
+                      && rel(norm2(a2 - b2), ref_norm) < 1e-12
+                      && max(abs(a2 - b2)) == ref_max
+                      && min(clamp(c2, 0.25, 0.75)) == ref_min
+                      && rel(sum(sqrt(a2) + exp(b2)), ref_sum) < 1e-12;
+
+    std::cout << "\nResults match scalar reference: " << (reductions_ok ? "yes" : "NO") << "\n";
+    std::cout << "Speedup dot:   " << (naive_dot_time / fused_dot_time) << "x\n";
+    std::cout << "Speedup norm2: " << (naive_norm_time / fused_norm_time) << "x\n\n";
+
     // ========================================
     // 测试 3: 矩阵运算
     // ========================================
@@ -423,6 +272,109 @@ int main() {
 
     std::cout << "\n";
 
+    // ========================================
+    // 测试 3b: 矩阵乘法（MatMul → 分块 GEMM）
+    // ========================================
+    std::cout << "Test 3b: Matrix Multiply via Packed GEMM (" << M << "x" << M << ")\n";
+    std::cout << "------------------------------------------------\n";
+
+    // 对照组：i-k-j 三重循环（内层连续访问，可被自动向量化）
+    auto matmul_loops = [](const Matrix& X, const Matrix& Y, Matrix& Z) {
+        for (size_t i = 0; i < Z.rows(); ++i) {
+            for (size_t j = 0; j < Z.cols(); ++j) Z(i, j) = 0.0;
+            for (size_t k = 0; k < X.cols(); ++k) {
+                double x = X(i, k);
+                for (size_t j = 0; j < Z.cols(); ++j) Z(i, j) += x * Y(k, j);
+            }
+        }
+    };
+
+    Matrix P(M, M);
+    const double gflop = 2.0 * M * M * M * 1e-9;
+    double loops_time = benchmark("Triple loop (i-k-j): P = A*B", [&]() {
+        matmul_loops(A, B, P);
+    }, 2);
+    double gemm_time = benchmark("GEMM: P = A*B", [&]() {
+        P = A * B;
+    }, 5);
+    benchmark("GEMM: P = A*transpose(B)", [&]() {
+        P = A * transpose(B);
+    }, 5);
+    benchmark("GEMM: P = 0.5*A*B + 2*P", [&]() {
+        P = 0.5 * A * B + 2.0 * P;
+    }, 5);
+
+    // 正确性：非对齐尺寸 + 四种转置组合 + 混合表达式，与逐元素参考实现对照
+    auto random_matrix = [&](size_t r, size_t c) {
+        Matrix X(r, c);
+        for (size_t i = 0; i < r; ++i)
+            for (size_t j = 0; j < c; ++j) X(i, j) = dist(rng) - 0.5;
+        return X;
+    };
+    auto reference = [](const auto& X, const auto& Y) {
+        Matrix Z(X.rows(), Y.cols());
+        for (size_t i = 0; i < Z.rows(); ++i)
+            for (size_t j = 0; j < Z.cols(); ++j) {
+                double acc = 0.0;
+                for (size_t k = 0; k < X.cols(); ++k) acc += X(i, k) * Y(k, j);
+                Z(i, j) = acc;
+            }
+        return Z;
+    };
+    auto max_diff = [](const Matrix& X, const auto& Y) {
+        double d = 0.0;
+        for (size_t i = 0; i < X.rows(); ++i)
+            for (size_t j = 0; j < X.cols(); ++j) d = std::max(d, std::abs(X(i, j) - Y(i, j)));
+        return d;
+    };
+    Matrix X1 = random_matrix(203, 301), Y1 = random_matrix(301, 157);
+    Matrix X1t = random_matrix(301, 203), Y1t = random_matrix(157, 301);
+    Matrix Z1 = random_matrix(203, 157), D1 = random_matrix(203, 157);
+    Matrix ref_nn = reference(X1, Y1);
+    Matrix Z1_expected = 0.5 * ref_nn + 3.0 * Z1;
+    Matrix mixed_expected = ref_nn + D1 * 2.0;
+
+    double err = 0.0;
+    Matrix R1 = X1 * Y1;
+    err = std::max(err, max_diff(R1, ref_nn));
+    Matrix R2 = transpose(X1t) * Y1;
+    err = std::max(err, max_diff(R2, reference(transpose(X1t), Y1)));
+    Matrix R3 = X1 * transpose(Y1t);
+    err = std::max(err, max_diff(R3, reference(X1, transpose(Y1t))));
+    Matrix R4 = transpose(X1t) * transpose(Y1t) * 2.0;
+    err = std::max(err, max_diff(R4, 2.0 * reference(transpose(X1t), transpose(Y1t))));
+    Z1 = 0.5 * X1 * Y1 + 3.0 * Z1;
+    err = std::max(err, max_diff(Z1, Z1_expected));
+    Matrix R5 = X1 * Y1 + D1 * 2.0;
+    err = std::max(err, max_diff(R5, mixed_expected));
+
+    // 目标形状不符：应在调用 gemm 之前抛出，而不是越界写
+    size_t shape_rejected = 0;
+    auto expect_shape_error = [&](auto&& assign_product) {
+        try {
+            assign_product();
+        } catch (const std::invalid_argument&) {
+            ++shape_rejected;
+        }
+    };
+    Matrix W_small(157, 203), W_beta(203, 203);
+    expect_shape_error([&] { W_small = X1 * Y1; });
+    expect_shape_error([&] { W_small = transpose(X1t) * Y1; });
+    expect_shape_error([&] { W_small = X1 * transpose(Y1t) * 2.0; });
+    expect_shape_error([&] { W_small = transpose(X1t) * transpose(Y1t); });
+    expect_shape_error([&] { W_beta = 0.5 * X1 * Y1 + 3.0 * W_beta; });
+    expect_shape_error([&] { W_beta = 2.0 * W_beta + transpose(X1t) * Y1; });
+    expect_shape_error([&] { W_beta = X1 * transpose(Y1t) + D1 * 2.0; });
+
+    std::cout << "\nGEMM throughput: " << std::setprecision(1) << gflop / (gemm_time * 1e-3)
+              << " GFLOP/s (triple loop: " << gflop / (loops_time * 1e-3) << ")\n";
+    std::cout << std::setprecision(3);
+    std::cout << "Speedup vs triple loop: " << (loops_time / gemm_time) << "x\n";
+    std::cout << "Max abs error (all transpose/fusion forms): " << std::scientific << err
+              << std::fixed << (err < 1e-10 ? " (ok)" : " (MISMATCH!)") << "\n";
+    std::cout << (shape_rejected == 7 ? "✓" : "✗") << " Mismatched destination shapes rejected: "
+              << shape_rejected << "/7 (plain, transposed, alpha*A*B + beta*C)\n\n";
+
     // ========================================
     // 测试 4: 矩阵转置（零拷贝）
     // ========================================
@@ -438,6 +390,247 @@ int main() {
 
     std::cout << "\n";
 
+    // ========================================
+    // 测试 4a: 转置操作数的分块求值（4096x4096）
+    // ========================================
+    constexpr size_t MT = 4096;
+    std::cout << "Test 4a: Tiled Transpose Evaluation (" << MT << "x" << MT << ")\n";
+    std::cout << "------------------------------------------------\n";
+
+    Matrix TA(MT, MT), TB(MT, MT), TM(MT, MT), TM_ref(MT, MT);
+    for (size_t i = 0; i < MT; ++i) {
+        for (size_t j = 0; j < MT; ++j) {
+            TA(i, j) = dist(rng);
+            TB(i, j) = dist(rng);
+        }
+    }
+
+    double strided_time = benchmark("Elementwise: M = transpose(A) + B", [&]() {
+        TM_ref.assign_elementwise(transpose(TA) + TB);
+    }, 3);
+    double tiled_time = benchmark("Tiled: M = transpose(A) + B", [&]() {
+        TM = transpose(TA) + TB;
+    }, 3);
+
+    bool tiled_ok = true;
+    for (size_t i = 0; i < MT; ++i) {
+        for (size_t j = 0; j < MT; ++j) tiled_ok &= (TM(i, j) == TM_ref(i, j));
+    }
+    // 非整块尺寸（203x301）：覆盖方块与寄存器块的边缘
+    Matrix odd = 2.0 * transpose(X1t) + X1, odd_ref(X1.rows(), X1.cols());
+    odd_ref.assign_elementwise(2.0 * transpose(X1t) + X1);
+    tiled_ok &= max_diff(odd, odd_ref) == 0.0;
+    std::cout << "\nBlock size: " << kPacketSize << "x" << kPacketSize
+              << " (in-register transpose), tile: 64x64\n";
+    std::cout << "Results identical: " << (tiled_ok ? "yes" : "NO") << "\n";
+    std::cout << "Effective bandwidth (tiled): " << std::setprecision(2)
+              << 3.0 * MT * MT * sizeof(double) / (tiled_time * 1e-3) / 1e9 << " GB/s\n";
+    std::cout << std::setprecision(3);
+    std::cout << "Speedup: " << (strided_time / tiled_time) << "x\n\n";
+
+    // ========================================
+    // 测试 4c: 别名检测（目标出现在表达式中）
+    // ========================================
+    std::cout << "Test 4c: Aliasing Detection\n";
+    std::cout << "------------------------------------------------\n";
+
+    // 编译期：纯逐元素表达式不做运行期检查
+    static_assert(decltype(A + B * 2.0)::elementwise);
+    static_assert(!decltype(A + transpose(B))::elementwise);
+    static_assert(!decltype(shift(a, 1) + b)::elementwise);
+
+    bool alias_ok = true;
+    {
+        // A = transpose(A)：方阵与非方阵
+        Matrix sq = random_matrix(37, 37), sq_copy = sq;
+        sq = transpose(sq);
+        alias_ok &= max_diff(sq, transpose(sq_copy)) == 0.0;
+
+        Matrix rect = random_matrix(19, 45), rect_copy = rect;
+        rect = transpose(rect) * 2.0 + transpose(rect);
+        alias_ok &= rect.rows() == 45 && rect.cols() == 19;
+        alias_ok &= max_diff(rect, transpose(rect_copy) * 3.0) < 1e-15;
+
+        // C = C * B：目标是乘积的操作数
+        Matrix Cm = random_matrix(64, 64), Bm = random_matrix(64, 64), Cm_copy = Cm;
+        Matrix expected = reference(Cm_copy, Bm);
+        Cm = Cm * Bm;
+        alias_ok &= max_diff(Cm, expected) < 1e-12;
+
+        // v = shift(v, 1) + w：目标在重排位置
+        Vector v(1001), w(1001);
+        for (size_t i = 0; i < v.size(); ++i) { v[i] = dist(rng); w[i] = dist(rng); }
+        Vector v_expected = shift(v, 1) + w;
+        v = shift(v, 1) + w;
+        for (size_t i = 0; i < v.size(); ++i) alias_ok &= v[i] == v_expected[i];
+    }
+
+    // 逐元素别名（E = E + transpose(B) 中的 E）仍然原地求值
+    Matrix Ainplace = A;
+    double inplace_time = benchmark("In place: E = E + transpose(B)", [&]() {
+        Ainplace = Ainplace + transpose(B);
+    }, 10);
+    double defensive_time = benchmark("Defensive copy: A = transpose(copy)", [&]() {
+        Matrix copy = Ainplace;
+        Ainplace = transpose(copy);
+    }, 10);
+    double pooled_time = benchmark("Pooled scratch: A = transpose(A)", [&]() {
+        Ainplace = transpose(Ainplace);
+    }, 10);
+
+    std::cout << "\nAliased results correct: " << (alias_ok ? "yes" : "NO") << "\n";
+    std::cout << "Pooled vs defensive copy: " << (defensive_time / pooled_time) << "x\n";
+    std::cout << "(elementwise in-place update costs " << inplace_time << " ms, no scratch)\n\n";
+
+    // ========================================
+    // 测试 4d: 固定尺寸类型（栈存储 + 完全展开）
+    // ========================================
+    std::cout << "Test 4d: Fixed-Size Vectors and Matrices\n";
+    std::cout << "------------------------------------------------\n";
+
+    constexpr int SMALL_ITERS = 1'000'000;
+    FixedVector<4> fp{ 1.0, 2.0, 3.0, 4.0 }, fv{ 0.5, 0.25, 0.125, 0.0625 }, fr;
+    Vector dp{ 1.0, 2.0, 3.0, 4.0 }, dv{ 0.5, 0.25, 0.125, 0.0625 }, dr(4);
+
+    double dyn_vec_time = benchmark("Vector(4): r = p + v*0.01 (1M steps)", [&]() {
+        for (int it = 0; it < SMALL_ITERS; ++it) {
+            dr = dp + dv * 0.01;
+            asm volatile("" : : : "memory");
+        }
+    }, 5);
+    double fixed_vec_time = benchmark("FixedVector<4>: r = p + v*0.01", [&]() {
+        for (int it = 0; it < SMALL_ITERS; ++it) {
+            fr = fp + fv * 0.01;
+            asm volatile("" : : : "memory");
+        }
+    }, 5);
+
+    FixedMatrix<4, 4> fT, fU, fW;
+    Matrix dT(4, 4), dU(4, 4), dW(4, 4);
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            fT(i, j) = dT(i, j) = dist(rng);
+            fU(i, j) = dU(i, j) = dist(rng);
+        }
+    }
+    double dyn_mat_time = benchmark("Matrix(4x4): W = T*U (100K)", [&]() {
+        for (int it = 0; it < SMALL_ITERS / 10; ++it) {
+            dW = dT * dU;
+            asm volatile("" : : : "memory");
+        }
+    }, 5);
+    double fixed_mat_time = benchmark("FixedMatrix<4,4>: W = T*U", [&]() {
+        for (int it = 0; it < SMALL_ITERS / 10; ++it) {
+            fW = fT * fU;
+            asm volatile("" : : : "memory");
+        }
+    }, 5);
+
+    // 固定与动态操作数混用
+    bool fixed_ok = max_diff(dW, fW) < 1e-15;
+    FixedVector<4> mixed = fp * 2.0 + dv;
+    Vector mixed_dyn = dp * 2.0 + fv;
+    for (size_t i = 0; i < 4; ++i) fixed_ok &= mixed[i] == mixed_dyn[i];
+    FixedMatrix<4, 4> mixed_mat = transpose(fT) + dU * 0.5 + fT * dU;
+    Matrix mixed_mat_ref = transpose(dT) + dU * 0.5 + dT * dU;
+    fixed_ok &= max_diff(mixed_mat_ref, mixed_mat) < 1e-15;
+    FixedVector<7> odd_fixed = FixedVector<7>(1.5) * 2.0;  // 7 = 1 个 Packet + 尾部（AVX2）
+    for (size_t i = 0; i < 7; ++i) fixed_ok &= odd_fixed[i] == 3.0;
+
+    std::cout << "\nFixed/dynamic mixing correct: " << (fixed_ok ? "yes" : "NO") << "\n";
+    std::cout << "Per step: Vector(4) " << std::setprecision(2) << dyn_vec_time * 1e6 / SMALL_ITERS
+              << " ns, FixedVector<4> " << fixed_vec_time * 1e6 / SMALL_ITERS << " ns\n";
+    std::cout << "Per 4x4 product: Matrix " << dyn_mat_time * 1e7 / SMALL_ITERS
+              << " ns, FixedMatrix " << fixed_mat_time * 1e7 / SMALL_ITERS << " ns\n";
+    std::cout << std::setprecision(3);
+    std::cout << "Speedup (vector): " << (dyn_vec_time / fixed_vec_time) << "x\n";
+    std::cout << "Speedup (4x4 product): " << (dyn_mat_time / fixed_mat_time) << "x\n\n";
+
+    // ========================================
+    // 测试 4b: 大规模表达式的多线程求值
+    // ========================================
+    std::cout << "Test 4b: Multithreaded Evaluation (threads = " << default_pool().size() << ")\n";
+    std::cout << "------------------------------------------------\n";
+
+    constexpr size_t N_BIG = 16'000'000;
+    Vector x(N_BIG), y(N_BIG), z(N_BIG);
+    for (size_t i = 0; i < N_BIG; ++i) {
+        x[i] = dist(rng);
+        y[i] = dist(rng);
+    }
+
+    const size_t default_threshold = parallel_threshold();
+    parallel_threshold() = SIZE_MAX;
+    double serial_time = benchmark("Serial:   z = x*2 + y*3 - x", [&]() {
+        z = x * 2.0 + y * 3.0 - x;
+    }, 10);
+    double serial_ctor_time = benchmark("Serial:   Vector w(x + y)", [&]() {
+        Vector w(x + y);
+    }, 10);
+    double serial_mat_time = benchmark("Serial:   Matrix F(A + B*2 + C)", [&]() {
+        Matrix F(A + B * 2.0 + C);
+    }, 10);
+
+    parallel_threshold() = default_threshold;
+    double parallel_time = benchmark("Parallel: z = x*2 + y*3 - x", [&]() {
+        z = x * 2.0 + y * 3.0 - x;
+    }, 10);
+    double parallel_ctor_time = benchmark("Parallel: Vector w(x + y)", [&]() {
+        Vector w(x + y);  // 新分配的页面由各线程 first-touch
+    }, 10);
+    double parallel_mat_time = benchmark("Parallel: Matrix F(A + B*2 + C)", [&]() {
+        Matrix F(A + B * 2.0 + C);
+    }, 10);
+
+    std::cout << "\nSpeedup (assign): " << (serial_time / parallel_time) << "x\n";
+    std::cout << "Speedup (vector ctor): " << (serial_ctor_time / parallel_ctor_time) << "x\n";
+    std::cout << "Speedup (matrix ctor): " << (serial_mat_time / parallel_mat_time) << "x\n";
+    if (default_pool().size() == 1) {
+        std::cout << "(single hardware thread: parallel path falls back to serial)\n";
+    }
+
+    // 多个线程同时使用同一个线程池，以及在任务内部嵌套调用：
+    // 拿不到分发锁或已在本池内时在调用线程上串行执行，结果不变且不会死锁
+    {
+        ThreadPool pool(4);
+        constexpr size_t LEN = 100'000;
+        constexpr int CALLERS = 4, ROUNDS = 200;
+        std::vector<std::vector<uint32_t>> hits(CALLERS, std::vector<uint32_t>(LEN));
+        std::vector<std::thread> callers;
+        for (int c = 0; c < CALLERS; ++c) {
+            callers.emplace_back([&, c] {
+                for (int r = 0; r < ROUNDS; ++r) {
+                    pool.parallel_for(LEN, 8, [&](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; ++i) ++hits[c][i];
+                    });
+                }
+            });
+        }
+        std::atomic<size_t> nested{0};
+        pool.parallel_for(64, 1, [&](size_t begin, size_t end) {
+            pool.parallel_for(end - begin, 1, [&](size_t b, size_t e) { nested += e - b; });
+        });
+        for (auto& t : callers) t.join();
+
+        // 两个线程同时对大向量赋值，都经过 default_pool()
+        Vector z1(N_BIG), z2(N_BIG);
+        std::thread t1([&] { for (int r = 0; r < 3; ++r) z1 = x * 2.0 + y; });
+        std::thread t2([&] { for (int r = 0; r < 3; ++r) z2 = x - y * 3.0; });
+        t1.join();
+        t2.join();
+
+        bool ok = nested == 64;
+        for (const auto& h : hits) {
+            ok = ok && std::all_of(h.begin(), h.end(), [](uint32_t v) { return v == ROUNDS; });
+        }
+        for (size_t i = 0; i < N_BIG; i += 9973) {
+            ok = ok && z1[i] == x[i] * 2.0 + y[i] && z2[i] == x[i] - y[i] * 3.0;
+        }
+        std::cout << (ok ? "✓" : "✗") << " Concurrent callers (" << CALLERS << " threads x " << ROUNDS
+                  << " calls) and nested parallel_for: " << (ok ? "all results correct" : "MISMATCH!") << "\n";
+    }
+    std::cout << "\n";
+
     // ========================================
     // 内存分配统计
     // ========================================
@@ -519,17 +712,26 @@ int main() {
 /* 编译与运行:
 
 基础版本:
-  g++ -std=c++20 -O2 expression_templates_complete.cpp -o expr_demo
+  g++ -std=c++20 -O2 -pthread expression_templates_complete.cpp -o expr_demo
   ./expr_demo
 
 优化版本:
-  g++ -std=c++20 -O3 -march=native expression_templates_complete.cpp -o expr_opt
+  g++ -std=c++20 -O3 -march=native -pthread expression_templates_complete.cpp -o expr_opt
   ./expr_opt
 
+NUMA 机器上观察 first-touch 效果:
+  numactl --interleave=all ./expr_opt   # 对照：页面交错分布
+  numactl --localalloc ./expr_opt       # 默认：各线程写入的页面留在本地节点
+
 查看生成的汇编（验证循环融合）:
   g++ -std=c++20 -O3 -march=native -S expression_templates_complete.cpp
   # 检查是否只有一个循环
 
+尺寸 × 深度扫描与编译期开销（共用 expression_templates.hpp）:
+  g++ -std=c++20 -O3 -march=native -pthread et_benchmark_harness.cpp -o et_sweep
+  ./et_sweep --csv et_sweep.csv
+  ./et_compile_time.sh
+
 使用 Compiler Explorer:
   https://godbolt.org/
   # 对比朴素版本和表达式模板版本的汇编代码
@@ -538,6 +740,21 @@ int main() {
   - 简单表达式: 5-15x 加速
   - 复杂表达式: 10-50x 加速
   - 矩阵运算: 3-20x 加速
+  - Packet 路径 vs 标量 ET 路径: 缓存内数据 2-4x，超出 LLC 后受内存带宽限制趋于 1x
+
+  - GEMM (A*B, 1000x1000): 单核 AVX2 约 20-40 GFLOP/s，AVX-512 约 40-80 GFLOP/s，
+    相对 i-k-j 三重循环 5-20x；A*transpose(B) 与 alpha*A*B + beta*C 速度相同（转置在打包时处理）
+  - transpose(A) + B (4096x4096): 逐元素求值每个元素一次缓存/TLB 缺失，
+    分块 + 寄存器转置后接近拷贝带宽，通常 5-20x
+  - 别名: A = transpose(A) 走池化临时缓冲区 + 交换存储，比手工防御性拷贝少一次
+    分配和一次整矩阵拷贝；逐元素别名（v = v * 2 + w）编译期即判定为安全，原地求值
+  - FixedVector<4>/FixedMatrix<4,4>: 无堆分配、无循环与尾部判断，
+    小向量运算 2-5x，4x4 乘积相对通用 GEMM（打包开销）10x 以上
+  - 融合归约 vs 物化 + 单累加器: 2-4x（省掉一次写回与读回，且不再受加法延迟限制）
+  - 多线程求值: 超出 LLC 的数据受内存带宽限制，加速比约等于可用内存通道带宽之比，
+    通常 4-8 线程即饱和；低于 parallel_threshold()（默认 256K 元素）保持单线程
+
+SIMD 宽度由编译旗标决定（-mavx2 → 4 doubles，-mavx512f → 8 doubles，否则 1）
 
 关键优化:
   1. 零临时对象（无内存分配）
@@ -0,0 +1,15 @@
+#!/bin/bash
+# 构建运行期分派演示：基线不带 -march，AVX2 / AVX-512 只在各自的内核翻译单元中启用
+# 用法: ./build_dispatch.sh [CXX]，产物写到 build/dispatch_demo（已在 .gitignore 中）
+
+set -e
+CXX=${1:-g++}
+DIR=$(cd "$(dirname "$0")" && pwd)
+OUT="$DIR/build"
+mkdir -p "$OUT"
+
+$CXX -std=c++20 -O3 -Wall -Wextra \
+    "$DIR/dispatch_demo.cpp" "$DIR/simd_dispatch.cpp" \
+    "$DIR/simd_kernels_scalar.cpp" "$DIR/simd_kernels_avx2.cpp" "$DIR/simd_kernels_avx512.cpp" \
+    -o "$OUT/dispatch_demo"
+echo "built $OUT/dispatch_demo"
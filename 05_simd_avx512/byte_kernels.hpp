@@ -0,0 +1,822 @@
+// byte_kernels.hpp
+// 字节流内核：256 桶字节直方图、位图 popcount（Harley-Seal）、hex 与 base64 编解码
+//
+// 1. 直方图：朴素写法 ++hist[p[i]] 在相邻字节相同时（日志文本、全零页、低熵数据）
+//    每次自增都要等上一次自增的存储转发（store-to-load forwarding，约 5 个周期）。
+//    K 份子直方图轮流计数，同一个计数器的两次自增至少相隔 K 个字节，依赖链被拆开，
+//    最后把 K 份相加。收益几乎全部来自子直方图：AVX2 版本只是改用 256 位加载取字节；
+//    AVX-512 版本用 gather / scatter，每个 lane 一份私有子直方图，lane 之间不会冲突，
+//    不需要 vpconflictd
+// 2. popcount：Harley-Seal 用进位保留加法器（CSA）把 16 个向量压缩进
+//    ones / twos / fours / eights / sixteens 五个累加向量，每 16 个向量只对 sixteens
+//    做一次完整的 popcount（pshufb 查 4 位表 + sad_epu8）。AVX-512 的一个 CSA 是两条
+//    vpternlogd；有 VPOPCNTDQ 时逐向量 popcount 换成 vpopcntq
+// 3. hex：编码拆出高低半字节，pshufb 查 "0123456789abcdef"，unpack 交错；
+//    解码先按字符类别校验并换算成半字节，再 maddubs 把 (高, 低) 合成一个字节，packus 收拢。
+//    编码输出小写，解码接受大小写
+// 4. base64（RFC 4648 标准字母表，'=' 补齐）：AVX2 为 Muła / Lemire 的 pshufb 算法；
+//    AVX-512 VBMI 编码用 vpermb + vpmultishiftqb，解码用 vpermi2b 查 128 项表
+//
+// 解码遇到非法输入抛 std::invalid_argument，消息中带第一个非法字符的偏移：
+// SIMD 循环只判断整块是否合法，遇到非法块就交给标量实现从该块开始逐个检查并报错
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <bit>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __AVX2__
+#include "simd_intrin.hpp"
+#define BYTES_HAS_AVX2
+#endif
+
+#ifdef __AVX512BW__
+#define BYTES_HAS_AVX512BW
+#endif
+
+#ifdef __AVX512VBMI__
+#define BYTES_HAS_AVX512VBMI
+#endif
+
+namespace simd_bytes {
+
+namespace detail {
+
+[[noreturn]] inline void invalid_character(const char* func, size_t offset) {
+    throw std::invalid_argument(std::string(func) + ": invalid character at offset " + std::to_string(offset));
+}
+
+#ifdef BYTES_HAS_AVX512BW
+// 低 k 个字节的掩码（k <= 64）
+inline __mmask64 byte_mask(size_t k) {
+    return k >= 64 ? ~__mmask64{ 0 } : (__mmask64{ 1 } << k) - 1;
+}
+#endif
+
+} // namespace detail
+
+// ============================================================================
+// Part 1: 256 桶字节直方图
+// ============================================================================
+
+using Histogram = std::array<uint64_t, 256>;
+
+// 朴素实现：每个字节一次 ++hist[b]
+inline Histogram histogram_naive(const uint8_t* data, size_t n) {
+    Histogram h{};
+    for (size_t i = 0; i < n; ++i) ++h[data[i]];
+    return h;
+}
+
+namespace detail {
+
+// uint32 子计数器每处理 kHistChunk 字节合并进 uint64 结果一次，不会溢出
+inline constexpr size_t kHistChunk = size_t{ 1 } << 30;
+
+// K 份子直方图；count(p, c) 统计从 p 开始的 Block 个字节，不足一块的尾部计入第 0 份
+template<size_t K, size_t Block, typename F>
+inline Histogram histogram_blocks(const uint8_t* data, size_t n, F count) {
+    Histogram h{};
+    alignas(64) uint32_t c[K][256];
+    for (size_t start = 0; start < n; start += kHistChunk) {
+        const size_t end = std::min(n, start + kHistChunk);
+        std::memset(c, 0, sizeof(c));
+        size_t i = start;
+        for (; i + Block <= end; i += Block) count(data + i, c);
+        for (; i < end; ++i) ++c[0][data[i]];
+        for (size_t b = 0; b < 256; ++b) {
+            for (size_t k = 0; k < K; ++k) h[b] += c[k][b];
+        }
+    }
+    return h;
+}
+
+// 64 位字的 8 个字节依次计入第 j % K 份
+template<size_t K>
+inline void count_word(uint32_t (&c)[K][256], uint64_t w) {
+    for (size_t j = 0; j < 8; ++j) ++c[j % K][(w >> (8 * j)) & 0xFF];
+}
+
+} // namespace detail
+
+// 标量 + K 份子直方图，每次读 8 个字节
+template<size_t K = 4>
+inline Histogram histogram_scalar(const uint8_t* data, size_t n) {
+    return detail::histogram_blocks<K, 16>(data, n, [](const uint8_t* p, uint32_t (&c)[K][256]) {
+        uint64_t w0, w1;
+        std::memcpy(&w0, p, 8);
+        std::memcpy(&w1, p + 8, 8);
+        detail::count_word<K>(c, w0);
+        detail::count_word<K>(c, w1);
+    });
+}
+
+#ifdef BYTES_HAS_AVX2
+// 256 位加载，4 个 64 位 lane 取出后计入 8 份子直方图
+inline Histogram histogram_avx2(const uint8_t* data, size_t n) {
+    return detail::histogram_blocks<8, 32>(data, n, [](const uint8_t* p, uint32_t (&c)[8][256]) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m128i lo = _mm256_castsi256_si128(v);
+        const __m128i hi = _mm256_extracti128_si256(v, 1);
+        detail::count_word<8>(c, static_cast<uint64_t>(_mm_cvtsi128_si64(lo)));
+        detail::count_word<8>(c, static_cast<uint64_t>(_mm_extract_epi64(lo, 1)));
+        detail::count_word<8>(c, static_cast<uint64_t>(_mm_cvtsi128_si64(hi)));
+        detail::count_word<8>(c, static_cast<uint64_t>(_mm_extract_epi64(hi, 1)));
+    });
+}
+#endif
+
+#ifdef BYTES_HAS_AVX512BW
+// 每次 32 个字节扩展成两组 16 个 32 位下标，gather 计数、加 1、scatter 写回。
+// 第 g 组的 lane l 只访问第 g * 16 + l 份子直方图（共 32 份，32 KB），scatter 内部没有冲突
+inline Histogram histogram_avx512bw(const uint8_t* data, size_t n) {
+    return detail::histogram_blocks<32, 32>(data, n, [](const uint8_t* p, uint32_t (&c)[32][256]) {
+        const __m512i base0 = _mm512_mullo_epi32(
+            _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(256));
+        const __m512i base1 = _mm512_add_epi32(base0, _mm512_set1_epi32(16 * 256));
+        const __m512i one = _mm512_set1_epi32(1);
+        uint32_t* table = &c[0][0];
+
+        const __m512i idx0 = _mm512_add_epi32(
+            base0, _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+        const __m512i idx1 = _mm512_add_epi32(
+            base1, _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16))));
+        const __m512i c0 = _mm512_i32gather_epi32(idx0, table, 4);
+        const __m512i c1 = _mm512_i32gather_epi32(idx1, table, 4);
+        _mm512_i32scatter_epi32(table, idx0, _mm512_add_epi32(c0, one), 4);
+        _mm512_i32scatter_epi32(table, idx1, _mm512_add_epi32(c1, one), 4);
+    });
+}
+#endif
+
+// 默认实现：标量 8 份子直方图。gather / scatter 每个元素约 1-2 个周期，
+// 在目前的 Intel / AMD 上都不比标量快（见 byte_kernels_benchmark.cpp）
+inline Histogram histogram(const uint8_t* data, size_t n) {
+    return histogram_scalar<8>(data, n);
+}
+
+// ============================================================================
+// Part 2: 位图 popcount
+// ============================================================================
+
+inline uint64_t popcount_scalar(const uint8_t* data, size_t n) {
+    uint64_t total = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        total += static_cast<uint64_t>(std::popcount(w));
+    }
+    for (; i < n; ++i) total += static_cast<uint64_t>(std::popcount(data[i]));
+    return total;
+}
+
+#ifdef BYTES_HAS_AVX2
+namespace detail {
+
+// 每个 64 位 lane 的 1 的个数：按字节查 4 位表，再 sad_epu8 横向求和
+inline __m256i popcount_epi64_avx2(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low4 = _mm256_set1_epi8(0x0F);
+    const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, low4));
+    const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low4));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+// 进位保留加法器：a + b + c = 2 * h + l（逐位）
+inline void csa_avx2(__m256i& h, __m256i& l, __m256i a, __m256i b, __m256i c) {
+    const __m256i u = _mm256_xor_si256(a, b);
+    h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+    l = _mm256_xor_si256(u, c);
+}
+
+} // namespace detail
+
+inline uint64_t popcount_avx2(const uint8_t* data, size_t n) {
+    using detail::csa_avx2;
+    using detail::popcount_epi64_avx2;
+    auto load = [&](size_t i) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)); };
+
+    __m256i total = _mm256_setzero_si256();
+    __m256i ones = total, twos = total, fours = total, eights = total, sixteens;
+    __m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+    size_t i = 0;
+    for (; i + 16 * 32 <= n; i += 16 * 32) {
+        csa_avx2(twos_a, ones, ones, load(i + 0 * 32), load(i + 1 * 32));
+        csa_avx2(twos_b, ones, ones, load(i + 2 * 32), load(i + 3 * 32));
+        csa_avx2(fours_a, twos, twos, twos_a, twos_b);
+        csa_avx2(twos_a, ones, ones, load(i + 4 * 32), load(i + 5 * 32));
+        csa_avx2(twos_b, ones, ones, load(i + 6 * 32), load(i + 7 * 32));
+        csa_avx2(fours_b, twos, twos, twos_a, twos_b);
+        csa_avx2(eights_a, fours, fours, fours_a, fours_b);
+        csa_avx2(twos_a, ones, ones, load(i + 8 * 32), load(i + 9 * 32));
+        csa_avx2(twos_b, ones, ones, load(i + 10 * 32), load(i + 11 * 32));
+        csa_avx2(fours_a, twos, twos, twos_a, twos_b);
+        csa_avx2(twos_a, ones, ones, load(i + 12 * 32), load(i + 13 * 32));
+        csa_avx2(twos_b, ones, ones, load(i + 14 * 32), load(i + 15 * 32));
+        csa_avx2(fours_b, twos, twos, twos_a, twos_b);
+        csa_avx2(eights_b, fours, fours, fours_a, fours_b);
+        csa_avx2(sixteens, eights, eights, eights_a, eights_b);
+        total = _mm256_add_epi64(total, popcount_epi64_avx2(sixteens));
+    }
+    total = _mm256_slli_epi64(total, 4);
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_epi64_avx2(eights), 3));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_epi64_avx2(fours), 2));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_epi64_avx2(twos), 1));
+    total = _mm256_add_epi64(total, popcount_epi64_avx2(ones));
+    for (; i + 32 <= n; i += 32) total = _mm256_add_epi64(total, popcount_epi64_avx2(load(i)));
+
+    const __m128i t = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(t) + _mm_extract_epi64(t, 1)) +
+           popcount_scalar(data + i, n - i);
+}
+#endif
+
+#ifdef BYTES_HAS_AVX512BW
+namespace detail {
+
+inline __m512i popcount_epi64_avx512(__m512i v) {
+#ifdef __AVX512VPOPCNTDQ__
+    return _mm512_popcnt_epi64(v);
+#else
+    const __m512i lut = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+    const __m512i low4 = _mm512_set1_epi8(0x0F);
+    const __m512i lo = _mm512_shuffle_epi8(lut, _mm512_and_si512(v, low4));
+    const __m512i hi = _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(v, 4), low4));
+    return _mm512_sad_epu8(_mm512_add_epi8(lo, hi), _mm512_setzero_si512());
+#endif
+}
+
+// 0x96 = a ^ b ^ c，0xE8 = 多数表决 (a & b) | (a & c) | (b & c)
+inline void csa_avx512(__m512i& h, __m512i& l, __m512i a, __m512i b, __m512i c) {
+    h = _mm512_ternarylogic_epi32(a, b, c, 0xE8);
+    l = _mm512_ternarylogic_epi32(a, b, c, 0x96);
+}
+
+} // namespace detail
+
+inline uint64_t popcount_avx512bw(const uint8_t* data, size_t n) {
+    using detail::csa_avx512;
+    using detail::popcount_epi64_avx512;
+    auto load = [&](size_t i) { return _mm512_loadu_si512(data + i); };
+
+    __m512i total = _mm512_setzero_si512();
+    __m512i ones = total, twos = total, fours = total, eights = total, sixteens;
+    __m512i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+    size_t i = 0;
+    for (; i + 16 * 64 <= n; i += 16 * 64) {
+        csa_avx512(twos_a, ones, ones, load(i + 0 * 64), load(i + 1 * 64));
+        csa_avx512(twos_b, ones, ones, load(i + 2 * 64), load(i + 3 * 64));
+        csa_avx512(fours_a, twos, twos, twos_a, twos_b);
+        csa_avx512(twos_a, ones, ones, load(i + 4 * 64), load(i + 5 * 64));
+        csa_avx512(twos_b, ones, ones, load(i + 6 * 64), load(i + 7 * 64));
+        csa_avx512(fours_b, twos, twos, twos_a, twos_b);
+        csa_avx512(eights_a, fours, fours, fours_a, fours_b);
+        csa_avx512(twos_a, ones, ones, load(i + 8 * 64), load(i + 9 * 64));
+        csa_avx512(twos_b, ones, ones, load(i + 10 * 64), load(i + 11 * 64));
+        csa_avx512(fours_a, twos, twos, twos_a, twos_b);
+        csa_avx512(twos_a, ones, ones, load(i + 12 * 64), load(i + 13 * 64));
+        csa_avx512(twos_b, ones, ones, load(i + 14 * 64), load(i + 15 * 64));
+        csa_avx512(fours_b, twos, twos, twos_a, twos_b);
+        csa_avx512(eights_b, fours, fours, fours_a, fours_b);
+        csa_avx512(sixteens, eights, eights, eights_a, eights_b);
+        total = _mm512_add_epi64(total, popcount_epi64_avx512(sixteens));
+    }
+    total = _mm512_slli_epi64(total, 4);
+    total = _mm512_add_epi64(total, _mm512_slli_epi64(popcount_epi64_avx512(eights), 3));
+    total = _mm512_add_epi64(total, _mm512_slli_epi64(popcount_epi64_avx512(fours), 2));
+    total = _mm512_add_epi64(total, _mm512_slli_epi64(popcount_epi64_avx512(twos), 1));
+    total = _mm512_add_epi64(total, popcount_epi64_avx512(ones));
+    for (; i + 64 <= n; i += 64) total = _mm512_add_epi64(total, popcount_epi64_avx512(load(i)));
+    if (i < n) {
+        total = _mm512_add_epi64(total, popcount_epi64_avx512(_mm512_maskz_loadu_epi8(detail::byte_mask(n - i), data + i)));
+    }
+    return static_cast<uint64_t>(_mm512_reduce_add_epi64(total));
+}
+#endif
+
+// 编译期可用的最宽实现
+inline uint64_t popcount(const uint8_t* data, size_t n) {
+#if defined(BYTES_HAS_AVX512BW)
+    return popcount_avx512bw(data, n);
+#elif defined(BYTES_HAS_AVX2)
+    return popcount_avx2(data, n);
+#else
+    return popcount_scalar(data, n);
+#endif
+}
+
+// ============================================================================
+// Part 3: hex 编解码
+// ============================================================================
+
+inline constexpr char kHexDigits[] = "0123456789abcdef";
+
+namespace detail {
+
+// 字符 → 半字节值，非法字符为 -1
+inline constexpr auto kHexValues = [] {
+    std::array<int8_t, 256> t{};
+    t.fill(-1);
+    for (int c = 0; c < 10; ++c) t['0' + c] = static_cast<int8_t>(c);
+    for (int c = 0; c < 6; ++c) {
+        t['a' + c] = static_cast<int8_t>(10 + c);
+        t['A' + c] = static_cast<int8_t>(10 + c);
+    }
+    return t;
+}();
+
+// 字节 → 两个字符，每个字节一次查表、一次 2 字节存储
+inline constexpr auto kHexPairs = [] {
+    std::array<char, 512> t{};
+    for (size_t b = 0; b < 256; ++b) {
+        t[2 * b] = kHexDigits[b >> 4];
+        t[2 * b + 1] = kHexDigits[b & 0x0F];
+    }
+    return t;
+}();
+
+// 从字节 i 开始编码到末尾，dst 指向整个输出的起点
+inline void hex_encode_from(const uint8_t* src, size_t n, char* dst, size_t i) {
+    for (; i < n; ++i) std::memcpy(dst + 2 * i, &kHexPairs[2 * src[i]], 2);
+}
+
+// 从字符 i（偶数）开始解码到末尾，遇到非法字符抛异常
+inline void hex_decode_from(const char* src, size_t len, uint8_t* dst, size_t i) {
+    for (; i < len; i += 2) {
+        const int hi = kHexValues[static_cast<uint8_t>(src[i])];
+        if (hi < 0) invalid_character("hex_decode", i);
+        const int lo = kHexValues[static_cast<uint8_t>(src[i + 1])];
+        if (lo < 0) invalid_character("hex_decode", i + 1);
+        dst[i / 2] = static_cast<uint8_t>(hi << 4 | lo);
+    }
+}
+
+// 编码的第一块用非对齐存储写出后，从使 dst + 2i 按 Align 字节对齐的 i 继续（重叠部分写入相同的值）。
+// 每个输入字节对应两个输出字节，存储比加载多一倍，跨缓存行的存储是主要开销；
+// dst 为奇数地址时无法对齐，直接接着第一块之后
+template<size_t Align>
+inline size_t hex_aligned_start(const char* dst) {
+    const size_t mis = reinterpret_cast<uintptr_t>(dst) % Align;
+    return mis == 0 || mis % 2 != 0 ? Align / 2 : (Align - mis) / 2;
+}
+
+inline void check_hex_length(size_t len) {
+    if (len % 2 != 0) {
+        throw std::invalid_argument("hex_decode: odd input length " + std::to_string(len));
+    }
+}
+
+} // namespace detail
+
+// n 个字节 → 2n 个小写 hex 字符（不写结尾的 '\0'）
+inline void hex_encode_scalar(const uint8_t* src, size_t n, char* dst) {
+    detail::hex_encode_from(src, n, dst, 0);
+}
+
+// len 个 hex 字符 → len / 2 个字节，返回写出的字节数
+inline size_t hex_decode_scalar(const char* src, size_t len, uint8_t* dst) {
+    detail::check_hex_length(len);
+    detail::hex_decode_from(src, len, dst, 0);
+    return len / 2;
+}
+
+#ifdef BYTES_HAS_AVX2
+// 输出按 32 字节对齐（见 hex_aligned_start）
+inline void hex_encode_avx2(const uint8_t* src, size_t n, char* dst) {
+    const __m256i lut = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                         '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m256i low4 = _mm256_set1_epi8(0x0F);
+    auto block = [&](size_t i) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low4));
+        const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, low4));
+        // unpack 在每个 128 位 lane 内交错：a = 字节 0-7 | 16-23，b = 8-15 | 24-31
+        const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    };
+    size_t i = 0;
+    if (n >= 32) {
+        block(0);
+        i = detail::hex_aligned_start<32>(dst);
+    }
+    for (; i + 32 <= n; i += 32) block(i);
+    detail::hex_encode_from(src, n, dst, i);
+}
+
+namespace detail {
+
+// 32 个字符 → 32 个半字节值；valid 中字符合法的字节为 0xFF
+inline __m256i hex_nibbles_avx2(__m256i c, __m256i& valid) {
+    const __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    // | 0x20 把 'A'-'F' 折叠到 'a'-'f'
+    const __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+    valid = _mm256_or_si256(is_digit, is_alpha);
+    return _mm256_blendv_epi8(_mm256_add_epi8(alpha, _mm256_set1_epi8(10)), digit, is_digit);
+}
+
+} // namespace detail
+
+inline size_t hex_decode_avx2(const char* src, size_t len, uint8_t* dst) {
+    detail::check_hex_length(len);
+    // maddubs：每对 (高, 低) 半字节 → 高 * 16 + 低
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m256i valid_a, valid_b;
+        const __m256i a = detail::hex_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), valid_a);
+        const __m256i b = detail::hex_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32)), valid_b);
+        if (_mm256_movemask_epi8(_mm256_and_si256(valid_a, valid_b)) != -1) break;
+        // packus 按 128 位 lane 交错两个输入：a0 b0 | a1 b1 → a0 a1 b0 b1
+        const __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i / 2), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    detail::hex_decode_from(src, len, dst, i);
+    return len / 2;
+}
+#endif
+
+#ifdef BYTES_HAS_AVX512BW
+namespace detail {
+
+// 64 字节输入 → 128 个字符，分两个向量返回
+inline void hex_encode_block_avx512(__m512i v, __m512i& out0, __m512i& out1) {
+    const __m512i lut = _mm512_broadcast_i32x4(
+        _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'));
+    const __m512i low4 = _mm512_set1_epi8(0x0F);
+    const __m512i hi = _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(v, 4), low4));
+    const __m512i lo = _mm512_shuffle_epi8(lut, _mm512_and_si512(v, low4));
+    // a 的第 k 个 128 位块是输入字节 16k .. 16k+7，b 是 16k+8 .. 16k+15
+    const __m512i a = _mm512_unpacklo_epi8(hi, lo);
+    const __m512i b = _mm512_unpackhi_epi8(hi, lo);
+    out0 = _mm512_permutex2var_epi64(a, _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11), b);
+    out1 = _mm512_permutex2var_epi64(a, _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15), b);
+}
+
+inline __m512i hex_nibbles_avx512(__m512i c, __mmask64& valid) {
+    const __m512i digit = _mm512_sub_epi8(c, _mm512_set1_epi8('0'));
+    const __mmask64 is_digit = _mm512_cmple_epu8_mask(digit, _mm512_set1_epi8(9));
+    const __m512i alpha = _mm512_sub_epi8(_mm512_or_si512(c, _mm512_set1_epi8(0x20)), _mm512_set1_epi8('a'));
+    const __mmask64 is_alpha = _mm512_cmple_epu8_mask(alpha, _mm512_set1_epi8(5));
+    valid = is_digit | is_alpha;
+    return _mm512_mask_blend_epi8(is_digit, _mm512_add_epi8(alpha, _mm512_set1_epi8(10)), digit);
+}
+
+// 128 个字符的半字节值 → 64 个字节
+inline __m512i hex_pack_avx512(__m512i a, __m512i b) {
+    const __m512i weights = _mm512_set1_epi16(0x0110);
+    const __m512i packed = _mm512_packus_epi16(_mm512_maddubs_epi16(a, weights), _mm512_maddubs_epi16(b, weights));
+    return _mm512_permutexvar_epi64(_mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7), packed);
+}
+
+} // namespace detail
+
+// 输出按 64 字节对齐（见 hex_aligned_start）；尾部不足 64 字节时用掩码加载 / 存储，不回退到标量
+inline void hex_encode_avx512bw(const uint8_t* src, size_t n, char* dst) {
+    __m512i out0, out1;
+    auto block = [&](size_t i) {
+        detail::hex_encode_block_avx512(_mm512_loadu_si512(src + i), out0, out1);
+        _mm512_storeu_si512(dst + 2 * i, out0);
+        _mm512_storeu_si512(dst + 2 * i + 64, out1);
+    };
+    size_t i = 0;
+    if (n >= 64) {
+        block(0);
+        i = detail::hex_aligned_start<64>(dst);
+    }
+    for (; i + 64 <= n; i += 64) block(i);
+    if (i < n) {
+        const size_t chars = 2 * (n - i);
+        detail::hex_encode_block_avx512(_mm512_maskz_loadu_epi8(detail::byte_mask(n - i), src + i), out0, out1);
+        _mm512_mask_storeu_epi8(dst + 2 * i, detail::byte_mask(chars), out0);
+        if (chars > 64) _mm512_mask_storeu_epi8(dst + 2 * i + 64, detail::byte_mask(chars - 64), out1);
+    }
+}
+
+inline size_t hex_decode_avx512bw(const char* src, size_t len, uint8_t* dst) {
+    detail::check_hex_length(len);
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128) {
+        __mmask64 valid_a, valid_b;
+        const __m512i a = detail::hex_nibbles_avx512(_mm512_loadu_si512(src + i), valid_a);
+        const __m512i b = detail::hex_nibbles_avx512(_mm512_loadu_si512(src + i + 64), valid_b);
+        if ((valid_a & valid_b) != ~__mmask64{ 0 }) break;
+        _mm512_storeu_si512(dst + i / 2, detail::hex_pack_avx512(a, b));
+    }
+    if (i + 128 > len && i < len) {
+        // 尾部：未加载的 lane 为 0，不算非法
+        const size_t rest = len - i;
+        const __mmask64 m0 = detail::byte_mask(std::min<size_t>(rest, 64));
+        const __mmask64 m1 = detail::byte_mask(rest > 64 ? rest - 64 : 0);
+        __mmask64 valid_a, valid_b;
+        const __m512i a = detail::hex_nibbles_avx512(_mm512_maskz_loadu_epi8(m0, src + i), valid_a);
+        const __m512i b = detail::hex_nibbles_avx512(_mm512_maskz_loadu_epi8(m1, src + i + 64), valid_b);
+        if (((valid_a | ~m0) & (valid_b | ~m1)) == ~__mmask64{ 0 }) {
+            _mm512_mask_storeu_epi8(dst + i / 2, detail::byte_mask(rest / 2), detail::hex_pack_avx512(a, b));
+            return len / 2;
+        }
+    }
+    detail::hex_decode_from(src, len, dst, i);
+    return len / 2;
+}
+#endif
+
+// 编译期可用的最宽实现
+inline void hex_encode(const uint8_t* src, size_t n, char* dst) {
+#if defined(BYTES_HAS_AVX512BW)
+    hex_encode_avx512bw(src, n, dst);
+#elif defined(BYTES_HAS_AVX2)
+    hex_encode_avx2(src, n, dst);
+#else
+    hex_encode_scalar(src, n, dst);
+#endif
+}
+
+inline size_t hex_decode(const char* src, size_t len, uint8_t* dst) {
+#if defined(BYTES_HAS_AVX512BW)
+    return hex_decode_avx512bw(src, len, dst);
+#elif defined(BYTES_HAS_AVX2)
+    return hex_decode_avx2(src, len, dst);
+#else
+    return hex_decode_scalar(src, len, dst);
+#endif
+}
+
+// ============================================================================
+// Part 4: base64 编解码（RFC 4648，标准字母表，'=' 补齐）
+// ============================================================================
+
+inline constexpr char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+inline constexpr size_t base64_encoded_size(size_t n) { return (n + 2) / 3 * 4; }
+
+// 解码后的字节数；长度不是 4 的倍数时抛异常（字符是否合法由解码时检查）
+inline size_t base64_decoded_size(const char* src, size_t len) {
+    if (len % 4 != 0) {
+        throw std::invalid_argument("base64_decode: input length " + std::to_string(len) + " is not a multiple of 4");
+    }
+    size_t pad = 0;
+    if (len > 0 && src[len - 1] == '=') ++pad;
+    if (len > 1 && src[len - 2] == '=') ++pad;
+    return len / 4 * 3 - pad;
+}
+
+namespace detail {
+
+// 字符 → 6 位值，非法字符（包括 '='）为 -1
+inline constexpr auto kBase64Values = [] {
+    std::array<int8_t, 256> t{};
+    t.fill(-1);
+    for (int k = 0; k < 64; ++k) t[static_cast<uint8_t>(kBase64Alphabet[k])] = static_cast<int8_t>(k);
+    return t;
+}();
+
+// 从字节 i（3 的倍数）开始编码到末尾，dst 指向整个输出的起点
+inline void base64_encode_from(const uint8_t* src, size_t n, char* dst, size_t i) {
+    char* out = dst + i / 3 * 4;
+    for (; i + 3 <= n; i += 3) {
+        const uint32_t t = uint32_t{ src[i] } << 16 | uint32_t{ src[i + 1] } << 8 | src[i + 2];
+        *out++ = kBase64Alphabet[t >> 18];
+        *out++ = kBase64Alphabet[t >> 12 & 63];
+        *out++ = kBase64Alphabet[t >> 6 & 63];
+        *out++ = kBase64Alphabet[t & 63];
+    }
+    if (i < n) {
+        const bool two = i + 2 == n;
+        const uint32_t t = uint32_t{ src[i] } << 16 | (two ? uint32_t{ src[i + 1] } << 8 : 0);
+        *out++ = kBase64Alphabet[t >> 18];
+        *out++ = kBase64Alphabet[t >> 12 & 63];
+        *out++ = two ? kBase64Alphabet[t >> 6 & 63] : '=';
+        *out++ = '=';
+    }
+}
+
+// 从字符 i（4 的倍数）开始解码到末尾，返回整个输出的字节数。
+// '=' 只能出现在最后一组的末尾："xx==" 或 "xxx="
+inline size_t base64_decode_from(const char* src, size_t len, uint8_t* dst, size_t i) {
+    uint8_t* out = dst + i / 4 * 3;
+    auto value = [&](size_t k) -> uint32_t {
+        const int8_t v = kBase64Values[static_cast<uint8_t>(src[k])];
+        if (v < 0) invalid_character("base64_decode", k);
+        return static_cast<uint32_t>(v);
+    };
+    for (; i + 4 < len; i += 4) {
+        uint32_t t = value(i) << 18;
+        t |= value(i + 1) << 12;
+        t |= value(i + 2) << 6;
+        t |= value(i + 3);
+        *out++ = static_cast<uint8_t>(t >> 16);
+        *out++ = static_cast<uint8_t>(t >> 8);
+        *out++ = static_cast<uint8_t>(t);
+    }
+    if (i < len) {
+        const bool pad2 = src[i + 2] == '=', pad3 = src[i + 3] == '=';
+        if (pad2 && !pad3) invalid_character("base64_decode", i + 2);
+        uint32_t t = value(i) << 18;
+        t |= value(i + 1) << 12;
+        if (!pad2) t |= value(i + 2) << 6;
+        if (!pad3) t |= value(i + 3);
+        *out++ = static_cast<uint8_t>(t >> 16);
+        if (!pad2) *out++ = static_cast<uint8_t>(t >> 8);
+        if (!pad3) *out++ = static_cast<uint8_t>(t);
+    }
+    return static_cast<size_t>(out - dst);
+}
+
+} // namespace detail
+
+// n 个字节 → base64_encoded_size(n) 个字符（不写结尾的 '\0'）
+inline void base64_encode_scalar(const uint8_t* src, size_t n, char* dst) {
+    detail::base64_encode_from(src, n, dst, 0);
+}
+
+// 返回写出的字节数（等于 base64_decoded_size）
+inline size_t base64_decode_scalar(const char* src, size_t len, uint8_t* dst) {
+    base64_decoded_size(src, len);
+    return detail::base64_decode_from(src, len, dst, 0);
+}
+
+#ifdef BYTES_HAS_AVX2
+namespace detail {
+
+// 6 位值 0-63 → 字母表字符：按区间（A-Z、a-z、0-9、'+'、'/'）查加到字符上的偏移
+inline __m256i base64_translate_avx2(__m256i v) {
+    const __m256i offsets = _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+                                             65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    // 0-25 → 0，26-51 → 1，52-61 → 2-11，62 → 12，63 → 13
+    __m256i idx = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+    idx = _mm256_sub_epi8(idx, _mm256_cmpgt_epi8(v, _mm256_set1_epi8(25)));
+    return _mm256_add_epi8(v, _mm256_shuffle_epi8(offsets, idx));
+}
+
+} // namespace detail
+
+// 每次 24 字节 → 32 个字符；两个 128 位 lane 各放 12 个输入字节
+inline void base64_encode_avx2(const uint8_t* src, size_t n, char* dst) {
+    // 每 3 个字节 (a, b, c) 展开为 32 位 lane 的字节 [b, a, c, b]
+    const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    size_t i = 0;
+    // 第二个 lane 读 src + i + 12 起的 16 字节，需要 i + 28 <= n
+    for (; i + 28 <= n; i += 24) {
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12)), 1);
+        v = _mm256_shuffle_epi8(v, spread);
+        // 用 16 位乘法代替逐字段移位：mulhi 取出第 0、2 个 6 位字段，mullo 取出第 1、3 个
+        const __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0FC0FC00)),
+                                              _mm256_set1_epi32(0x04000040));
+        const __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003F03F0)),
+                                              _mm256_set1_epi32(0x01000010));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i / 3 * 4),
+                            detail::base64_translate_avx2(_mm256_or_si256(t0, t1)));
+    }
+    detail::base64_encode_from(src, n, dst, i);
+}
+
+// 每次 32 个字符 → 24 字节；最后一组（可能带 '='）总是留给标量
+inline size_t base64_decode_avx2(const char* src, size_t len, uint8_t* dst) {
+    base64_decoded_size(src, len);
+    // 按高 / 低半字节查表分类：两个表的结果按位与非零即为非法字符
+    const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    // 按高半字节（'/' 单独一项）查字符到 6 位值的偏移
+    const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                              0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+    // 3 个字节在 32 位 lane 中的位置：[2, 1, 0] 依次取出
+    const __m256i gather = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+    for (; i + 32 < len; i += 32) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(s, 4), mask_2f);
+        const __m256i lo_nibbles = _mm256_and_si256(s, mask_2f);
+        const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+        if (!_mm256_testz_si256(lo, hi)) break;
+        const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(s, mask_2f), hi_nibbles));
+        s = _mm256_add_epi8(s, roll);
+        // 4 个 6 位值 → 24 位：先两两合成 12 位（maddubs），再合成 24 位（madd）
+        const __m256i ab_cd = _mm256_maddubs_epi16(s, _mm256_set1_epi32(0x01400140));
+        __m256i out = _mm256_madd_epi16(ab_cd, _mm256_set1_epi32(0x00011000));
+        out = _mm256_shuffle_epi8(out, gather);
+        out = _mm256_permutevar8x32_epi32(out, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        // 只写 24 个有效字节，输出缓冲区不需要额外余量
+        uint8_t* p = dst + i / 4 * 3;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(out));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p + 16), _mm256_extracti128_si256(out, 1));
+    }
+    return detail::base64_decode_from(src, len, dst, i);
+}
+#endif
+
+#ifdef BYTES_HAS_AVX512VBMI
+namespace detail {
+
+// 编码：输出的第 k 个 32 位 lane 取输入字节 [3k+1, 3k, 3k+2, 3k+1]
+alignas(64) inline constexpr auto kBase64EncodeSpread = [] {
+    std::array<uint8_t, 64> t{};
+    for (size_t k = 0; k < 16; ++k) {
+        t[4 * k] = static_cast<uint8_t>(3 * k + 1);
+        t[4 * k + 1] = static_cast<uint8_t>(3 * k);
+        t[4 * k + 2] = static_cast<uint8_t>(3 * k + 2);
+        t[4 * k + 3] = static_cast<uint8_t>(3 * k + 1);
+    }
+    return t;
+}();
+
+// 解码：ASCII 0-127 → 6 位值，非法字符为 0x80
+alignas(64) inline constexpr auto kBase64DecodeLut = [] {
+    std::array<uint8_t, 128> t{};
+    for (size_t c = 0; c < 128; ++c) {
+        t[c] = kBase64Values[c] < 0 ? 0x80 : static_cast<uint8_t>(kBase64Values[c]);
+    }
+    return t;
+}();
+
+// 解码：第 k 个 32 位 lane 的低 3 字节按 [2, 1, 0] 顺序写到输出的 3k .. 3k+2
+alignas(64) inline constexpr auto kBase64DecodePack = [] {
+    std::array<uint8_t, 64> t{};
+    for (size_t j = 0; j < 48; ++j) t[j] = static_cast<uint8_t>(j / 3 * 4 + 2 - j % 3);
+    return t;
+}();
+
+} // namespace detail
+
+// 每次 48 字节 → 64 个字符
+inline void base64_encode_avx512vbmi(const uint8_t* src, size_t n, char* dst) {
+    const __m512i spread = _mm512_load_si512(detail::kBase64EncodeSpread.data());
+    const __m512i alphabet = _mm512_loadu_si512(kBase64Alphabet);
+    // 每个 64 位 lane 含两组 [b, a, c, b]，8 个 6 位字段分别从位 10、4、22、16（及 +32）开始
+    const __m512i shifts = _mm512_set1_epi64(0x3036242A1016040A);
+    const __mmask64 in_mask = detail::byte_mask(48);
+    size_t i = 0;
+    for (; i + 48 <= n; i += 48) {
+        const __m512i v = _mm512_permutexvar_epi8(spread, _mm512_maskz_loadu_epi8(in_mask, src + i));
+        const __m512i idx = _mm512_multishift_epi64_epi8(shifts, v);
+        _mm512_storeu_si512(dst + i / 3 * 4, _mm512_permutexvar_epi8(idx, alphabet));
+    }
+    detail::base64_encode_from(src, n, dst, i);
+}
+
+// 每次 64 个字符 → 48 字节；最后一组（可能带 '='）总是留给标量
+inline size_t base64_decode_avx512vbmi(const char* src, size_t len, uint8_t* dst) {
+    base64_decoded_size(src, len);
+    const __m512i lut0 = _mm512_load_si512(detail::kBase64DecodeLut.data());
+    const __m512i lut1 = _mm512_load_si512(detail::kBase64DecodeLut.data() + 64);
+    const __m512i pack = _mm512_load_si512(detail::kBase64DecodePack.data());
+    const __mmask64 out_mask = detail::byte_mask(48);
+    size_t i = 0;
+    for (; i + 64 < len; i += 64) {
+        const __m512i s = _mm512_loadu_si512(src + i);
+        // vpermi2b 只看低 7 位；输入 >= 0x80 或查到 0x80 都是非法字符
+        const __m512i v = _mm512_permutex2var_epi8(lut0, s, lut1);
+        if (_mm512_movepi8_mask(_mm512_or_si512(v, s)) != 0) break;
+        const __m512i ab_cd = _mm512_maddubs_epi16(v, _mm512_set1_epi32(0x01400140));
+        const __m512i out = _mm512_madd_epi16(ab_cd, _mm512_set1_epi32(0x00011000));
+        _mm512_mask_storeu_epi8(dst + i / 4 * 3, out_mask, _mm512_permutexvar_epi8(pack, out));
+    }
+    return detail::base64_decode_from(src, len, dst, i);
+}
+#endif
+
+// 编译期可用的最宽实现
+inline void base64_encode(const uint8_t* src, size_t n, char* dst) {
+#if defined(BYTES_HAS_AVX512VBMI)
+    base64_encode_avx512vbmi(src, n, dst);
+#elif defined(BYTES_HAS_AVX2)
+    base64_encode_avx2(src, n, dst);
+#else
+    base64_encode_scalar(src, n, dst);
+#endif
+}
+
+inline size_t base64_decode(const char* src, size_t len, uint8_t* dst) {
+#if defined(BYTES_HAS_AVX512VBMI)
+    return base64_decode_avx512vbmi(src, len, dst);
+#elif defined(BYTES_HAS_AVX2)
+    return base64_decode_avx2(src, len, dst);
+#else
+    return base64_decode_scalar(src, len, dst);
+#endif
+}
+
+} // namespace simd_bytes
@@ -0,0 +1,199 @@
+// dispatch_demo.cpp
+// 运行期分派演示：同一个二进制（不带 -march 编译）在不同 CPU 上选择不同内核
+// 1. 打印 CPUID 检测结果与最终选用的内核表（SIMD_ISA 环境变量可覆盖）
+// 2. 逐个 ISA 运行 vector_add / fma / dot_product / conditional_add，与标量结果（dot 与 fp64 参考值）比对
+// 3. 比较经函数指针表调用与直接调用的开销（小数组时才可见）
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include "simd_dispatch.h"
+
+// ============================================================================
+// 性能测试框架
+// ============================================================================
+
+template<typename Func>
+double benchmark(const std::string& name, Func func, int iterations = 100) {
+    // 预热
+    func();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+        asm volatile("" : : : "memory");
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    std::cout << std::left << std::setw(35) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(3)
+              << ms << " ms" << std::endl;
+
+    return ms;
+}
+
+// fp64 参考值：10M 元素的 fp32 单累加器误差本身就在 1e-2 量级，不能作为基准
+static double dot_reference(const float* a, const float* b, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<double>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+static float max_abs_diff(const std::vector<float>& x, const std::vector<float>& y) {
+    float diff = 0.0f;
+    for (size_t i = 0; i < x.size(); ++i) {
+        diff = std::max(diff, std::abs(x[i] - y[i]));
+    }
+    return diff;
+}
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+int main() {
+    constexpr size_t N = 10'000'000;
+    constexpr int ITERS = 50;
+
+    std::cout << "================================================\n";
+    std::cout << "  SIMD Runtime Dispatch\n";
+    std::cout << "================================================\n\n";
+
+    std::cout << "CPU Feature Detection (cpuid):\n";
+    std::cout << "------------------------------------------------\n";
+    std::cout << "AVX2:    " << (__builtin_cpu_supports("avx2") ? "✓" : "✗") << "\n";
+    std::cout << "FMA:     " << (__builtin_cpu_supports("fma") ? "✓" : "✗") << "\n";
+    std::cout << "AVX512F: " << (__builtin_cpu_supports("avx512f") ? "✓" : "✗") << "\n";
+    std::cout << "Detected: " << kernels_for(detect_simd_isa()).name << "\n";
+    std::cout << "Selected: " << simd_kernels().name
+              << " (override with SIMD_ISA=scalar|avx2|avx512)\n\n";
+
+    std::vector<float> a(N), b(N), c(N), result(N);
+    for (size_t i = 0; i < N; ++i) {
+        a[i] = static_cast<float>(i % 1000) * 0.001f;
+        b[i] = static_cast<float>((i * 7) % 1000) * 0.002f;
+        c[i] = 1.0f;
+    }
+
+    std::vector<float> ref_add(N), ref_fma(N), ref_cond(N);
+    constexpr float THRESHOLD = 0.5f;
+    kScalarKernels.vector_add(a.data(), b.data(), ref_add.data(), N);
+    kScalarKernels.fma(a.data(), b.data(), c.data(), ref_fma.data(), N);
+    kScalarKernels.conditional_add(a.data(), b.data(), ref_cond.data(), THRESHOLD, N);
+    // 正确性用一个短的、非 8/16 倍数的长度（覆盖尾部循环），累加误差可忽略
+    constexpr size_t CHECK_N = 4099;
+    const double ref_dot = dot_reference(a.data(), b.data(), CHECK_N);
+
+    // ========================================
+    // 测试 1: 各 ISA 的内核（仅运行本机支持的）
+    // ========================================
+    bool ok = true;
+    double base_add = 0.0, base_fma = 0.0, base_dot = 0.0, base_cond = 0.0;
+    for (SimdIsa isa : { SimdIsa::Scalar, SimdIsa::AVX2, SimdIsa::AVX512 }) {
+        const SimdKernels& k = kernels_for(isa);
+        std::cout << "Kernels: " << k.name << "\n";
+        std::cout << "------------------------------------------------\n";
+        if (!simd_isa_supported(isa)) {
+            std::cout << "  not supported on this CPU, skipped\n\n";
+            continue;
+        }
+
+        double t_add = benchmark(std::string(k.name) + " vector_add", [&]() {
+            k.vector_add(a.data(), b.data(), result.data(), N);
+        }, ITERS);
+        float add_err = max_abs_diff(result, ref_add);
+
+        double t_fma = benchmark(std::string(k.name) + " fma", [&]() {
+            k.fma(a.data(), b.data(), c.data(), result.data(), N);
+        }, ITERS);
+        float fma_err = max_abs_diff(result, ref_fma);
+
+        volatile float dot = 0.0f;
+        double t_dot = benchmark(std::string(k.name) + " dot_product", [&]() {
+            dot = k.dot_product(a.data(), b.data(), N);
+        }, ITERS);
+        double dot_rel = std::abs(k.dot_product(a.data(), b.data(), CHECK_N) - ref_dot) / std::abs(ref_dot);
+
+        double t_cond = benchmark(std::string(k.name) + " conditional_add", [&]() {
+            k.conditional_add(a.data(), b.data(), result.data(), THRESHOLD, N);
+        }, ITERS);
+        float cond_err = max_abs_diff(result, ref_cond);
+
+        if (isa == SimdIsa::Scalar) {
+            base_add = t_add;
+            base_fma = t_fma;
+            base_dot = t_dot;
+            base_cond = t_cond;
+        }
+        std::cout << std::setprecision(2) << "  Speedup vs scalar: add " << base_add / t_add
+                  << "x, fma " << base_fma / t_fma << "x, dot " << base_dot / t_dot
+                  << "x, conditional_add " << base_cond / t_cond << "x\n";
+        std::cout << std::scientific << "  Max error vs scalar: add " << add_err
+                  << ", fma " << fma_err << ", dot (rel, fp64 ref) " << dot_rel
+                  << ", conditional_add " << cond_err << std::fixed << "\n\n";
+
+        // FMA 单次舍入与标量 a*b+c 两次舍入可能相差 1 ulp
+        ok = ok && add_err == 0.0f && fma_err < 1e-5f && dot_rel < 1e-5 && cond_err == 0.0f;
+    }
+
+    // ========================================
+    // 测试 2: 分派开销（短数组，调用开销占比最大）
+    // ========================================
+    constexpr size_t SMALL = 64;
+    constexpr int SMALL_CALLS = 1'000'000;
+    std::cout << "Dispatch overhead (n = " << SMALL << ", " << SMALL_CALLS << " calls):\n";
+    std::cout << "------------------------------------------------\n";
+    const SimdKernels& selected = simd_kernels();
+    double t_cached = benchmark("Cached table pointer", [&]() {
+        for (int i = 0; i < SMALL_CALLS; ++i) {
+            selected.vector_add(a.data(), b.data(), result.data(), SMALL);
+            asm volatile("" : : : "memory");
+        }
+    }, 5);
+    double t_wrapper = benchmark("vector_add() wrapper", [&]() {
+        for (int i = 0; i < SMALL_CALLS; ++i) {
+            vector_add(a.data(), b.data(), result.data(), SMALL);
+            asm volatile("" : : : "memory");
+        }
+    }, 5);
+    std::cout << std::setprecision(2) << "  Per call: " << t_cached * 1e6 / SMALL_CALLS
+              << " ns vs " << t_wrapper * 1e6 / SMALL_CALLS << " ns\n\n";
+
+    std::cout << "================================================\n";
+    std::cout << "Summary\n";
+    std::cout << "================================================\n";
+    std::cout << "✓ One binary, kernels chosen once from cpuid:\n";
+    std::cout << "  Haswell / Zen 1-3 → avx2, Skylake-X / Zen 4 → avx512\n";
+    std::cout << "✓ Each ISA lives in its own translation unit with target attributes,\n";
+    std::cout << "  the rest of the program stays at the baseline ISA\n";
+    std::cout << "✓ Results: " << (ok ? "all kernels match scalar" : "MISMATCH!") << "\n";
+    std::cout << "================================================\n";
+
+    return ok ? 0 : 1;
+}
+
+/* 编译与运行:
+
+  # 注意：不加 -march=native / -mavx2，基线代码保持可移植，SIMD 只在分派后的内核中使用
+  g++ -std=c++20 -O3 dispatch_demo.cpp simd_dispatch.cpp simd_kernels_scalar.cpp \
+      simd_kernels_avx2.cpp simd_kernels_avx512.cpp -o dispatch_demo
+  ./dispatch_demo
+  SIMD_ISA=avx2 ./dispatch_demo       # 在 AVX-512 机器上测试 AVX2 路径
+  SIMD_ISA=scalar ./dispatch_demo
+
+  或直接: ./build_dispatch.sh && ./build/dispatch_demo
+
+预期结果:
+  - Haswell:     Selected: avx2，AVX-512 一栏显示 skipped
+  - Skylake-X / Zen 4: Selected: avx512
+  - 10M 元素时 add / fma 受内存带宽限制，各 ISA 差距很小；dot 计算密集一些，差距更明显
+  - 分派开销：函数指针调用约 1-2 ns，wrapper 多一次已初始化的静态变量检查，几乎不可见
+*/
@@ -0,0 +1,654 @@
+// pixel_convert.hpp
+// 像素格式转换库：RGB/BGR/RGBA/BGRA → 灰度、通道重排、RGBA 预乘 alpha、RGB ↔ YUV420（I420 / NV12）
+// 每个转换都有标量参考实现和 SIMD 实现，全部使用定点整数算术，SIMD 结果与标量逐字节一致
+//
+// SIMD 的核心是 pshufb 解交错：一个 128 位 lane 放 4 个像素，用 shuffle_epi8 把通道
+// 展开成 16 位对 (R, G) / (B, 1)，再用 madd_epi16 一步完成 "乘权重 + 相加 + 加偏置"
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#ifdef __AVX2__
+#include "simd_intrin.hpp"
+#define PIXEL_HAS_AVX2
+#endif
+
+#ifdef __AVX512BW__
+#define PIXEL_HAS_AVX512BW
+#endif
+
+// ============================================================================
+// Part 1: 像素布局与定点权重
+// ============================================================================
+
+// 每像素字节数与 R/G/B 通道的字节偏移；4 字节布局的 alpha 固定在第 4 个字节
+struct LayoutRGB  { static constexpr int bpp = 3, r = 0, g = 1, b = 2; };
+struct LayoutBGR  { static constexpr int bpp = 3, r = 2, g = 1, b = 0; };
+struct LayoutRGBA { static constexpr int bpp = 4, r = 0, g = 1, b = 2; };
+struct LayoutBGRA { static constexpr int bpp = 4, r = 2, g = 1, b = 0; };
+
+// Y = (wr*R + wg*G + wb*B + bias) >> shift
+// 权重与偏置都是 16 位有符号数（madd_epi16 的操作数），累加在 32 位中进行
+struct LumaWeights {
+    int16_t wr, wg, wb, bias;
+    int shift;
+};
+
+// 灰度：BT.601 系数 0.299 / 0.587 / 0.114 的 Q14 形式（和为 16384），bias 为 0.5 的舍入
+inline constexpr LumaWeights kGrayWeights{ 4899, 9617, 1868, 8192, 14 };
+
+// YUV 的 Y 平面：BT.601 有限范围 Y = ((66R + 129G + 25B + 128) >> 8) + 16，+16 并入 bias
+inline constexpr LumaWeights kLumaBT601{ 66, 129, 25, 128 + (16 << 8), 8 };
+
+template<typename L>
+inline void luma_scalar(const uint8_t* src, uint8_t* dst, size_t n, const LumaWeights& w) {
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t* p = src + i * L::bpp;
+        dst[i] = static_cast<uint8_t>((w.wr * p[L::r] + w.wg * p[L::g] + w.wb * p[L::b] + w.bias) >> w.shift);
+    }
+}
+
+namespace pixel_detail {
+
+#ifdef PIXEL_HAS_AVX2
+// lane 开头 4 个像素（每像素 Bpp 字节）的通道 c0、c1 展开为 16 位对 (c0, c1)；c1 < 0 时高半部分清零
+template<int Bpp>
+inline __m128i pair_mask(int c0, int c1) {
+    auto lo = [&](int p) { return static_cast<char>(p * Bpp + c0); };
+    auto hi = [&](int p) { return static_cast<char>(c1 < 0 ? -128 : p * Bpp + c1); };
+    return _mm_setr_epi8(lo(0), -128, hi(0), -128, lo(1), -128, hi(1), -128,
+                         lo(2), -128, hi(2), -128, lo(3), -128, hi(3), -128);
+}
+
+// 两个 16 位常数拼成 madd_epi16 的权重对
+inline __m256i weight_pair(int lo, int hi) {
+    return _mm256_set1_epi32(static_cast<int>((static_cast<uint32_t>(hi) << 16) | static_cast<uint16_t>(lo)));
+}
+
+// 8 个像素装入 256 位寄存器，每个 lane 4 个。3 字节像素：一次 32 字节加载（多读 8 字节），
+// 再用跨 lane 的 permutevar8x32 把像素 4..7（dword 3..5）搬到高 lane 开头
+template<int Bpp>
+inline constexpr size_t kOverread8 = Bpp == 3 ? 8 : 0;
+
+template<int Bpp>
+inline __m256i load8_avx2(const uint8_t* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    if constexpr (Bpp == 3) {
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5));
+    }
+    return v;
+}
+
+// 8 个像素 → 8 个 32 位亮度值（每个 lane 4 个，顺序与像素一致）
+template<typename L>
+class LumaAvx2 {
+    __m256i rg_mask_, b_mask_, w_rg_, w_b1_, one_hi_;
+    __m128i shift_;
+public:
+    explicit LumaAvx2(const LumaWeights& w)
+        : rg_mask_(_mm256_broadcastsi128_si256(pair_mask<L::bpp>(L::r, L::g))),
+          b_mask_(_mm256_broadcastsi128_si256(pair_mask<L::bpp>(L::b, -1))),
+          w_rg_(weight_pair(w.wr, w.wg)),
+          w_b1_(weight_pair(w.wb, w.bias)),
+          one_hi_(_mm256_set1_epi32(1 << 16)),
+          shift_(_mm_cvtsi32_si128(w.shift)) {}
+
+    __m256i operator()(__m256i px) const {
+        __m256i rg = _mm256_shuffle_epi8(px, rg_mask_);                                // (R, G)
+        __m256i b1 = _mm256_or_si256(_mm256_shuffle_epi8(px, b_mask_), one_hi_);       // (B, 1)
+        __m256i acc = _mm256_add_epi32(_mm256_madd_epi16(rg, w_rg_), _mm256_madd_epi16(b1, w_b1_));
+        return _mm256_srl_epi32(acc, shift_);
+    }
+};
+#endif
+
+#ifdef PIXEL_HAS_AVX512BW
+// 16 个像素装入 512 位寄存器，每个 lane 4 个。3 字节像素用字节掩码加载恰好 48 字节（不越界），
+// 再用 permutexvar_epi32 把每组 3 个 dword 分散到各 lane 开头
+template<int Bpp>
+inline __m512i load16_avx512(const uint8_t* p) {
+    if constexpr (Bpp == 3) {
+        __m512i v = _mm512_maskz_loadu_epi8(0xFFFFFFFFFFFFull, p);
+        return _mm512_permutexvar_epi32(
+            _mm512_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5, 6, 7, 8, 8, 9, 10, 11, 11), v);
+    } else {
+        return _mm512_loadu_si512(p);
+    }
+}
+
+template<typename L>
+class LumaAvx512 {
+    __m512i rg_mask_, b_mask_, w_rg_, w_b1_, one_hi_;
+    __m128i shift_;
+public:
+    explicit LumaAvx512(const LumaWeights& w)
+        : rg_mask_(_mm512_broadcast_i32x4(pair_mask<L::bpp>(L::r, L::g))),
+          b_mask_(_mm512_broadcast_i32x4(pair_mask<L::bpp>(L::b, -1))),
+          w_rg_(_mm512_broadcast_i32x4(_mm256_castsi256_si128(weight_pair(w.wr, w.wg)))),
+          w_b1_(_mm512_broadcast_i32x4(_mm256_castsi256_si128(weight_pair(w.wb, w.bias)))),
+          one_hi_(_mm512_set1_epi32(1 << 16)),
+          shift_(_mm_cvtsi32_si128(w.shift)) {}
+
+    __m512i operator()(__m512i px) const {
+        __m512i rg = _mm512_shuffle_epi8(px, rg_mask_);
+        __m512i b1 = _mm512_or_si512(_mm512_shuffle_epi8(px, b_mask_), one_hi_);
+        __m512i acc = _mm512_add_epi32(_mm512_madd_epi16(rg, w_rg_), _mm512_madd_epi16(b1, w_b1_));
+        return _mm512_srl_epi32(acc, shift_);
+    }
+};
+#endif
+
+} // namespace pixel_detail
+
+#ifdef PIXEL_HAS_AVX2
+// 每次 32 个像素：4 组 8 像素的 32 位结果经两级 packus 收窄为字节。
+// packus 在 lane 内交错，最后用 permutevar8x32 把 dword（每个 4 像素）恢复为线性顺序
+template<typename L>
+inline void luma_avx2(const uint8_t* src, uint8_t* dst, size_t n, const LumaWeights& w) {
+    using namespace pixel_detail;
+    const LumaAvx2<L> luma(w);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    size_t i = 0;
+    for (; (i + 32) * L::bpp + kOverread8<L::bpp> <= n * L::bpp; i += 32) {
+        const uint8_t* p = src + i * L::bpp;
+        __m256i a = luma(load8_avx2<L::bpp>(p));
+        __m256i b = luma(load8_avx2<L::bpp>(p + 8 * L::bpp));
+        __m256i c = luma(load8_avx2<L::bpp>(p + 16 * L::bpp));
+        __m256i d = luma(load8_avx2<L::bpp>(p + 24 * L::bpp));
+        __m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(a, b), _mm256_packus_epi32(c, d));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permutevar8x32_epi32(bytes, order));
+    }
+    luma_scalar<L>(src + i * L::bpp, dst + i, n - i, w);
+}
+#endif
+
+#ifdef PIXEL_HAS_AVX512BW
+// 每次 64 个像素；收窄后 dword q 应取自第 q/4 组的 lane q%4
+template<typename L>
+inline void luma_avx512bw(const uint8_t* src, uint8_t* dst, size_t n, const LumaWeights& w) {
+    using namespace pixel_detail;
+    const LumaAvx512<L> luma(w);
+    const __m512i order = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const uint8_t* p = src + i * L::bpp;
+        __m512i a = luma(load16_avx512<L::bpp>(p));
+        __m512i b = luma(load16_avx512<L::bpp>(p + 16 * L::bpp));
+        __m512i c = luma(load16_avx512<L::bpp>(p + 32 * L::bpp));
+        __m512i d = luma(load16_avx512<L::bpp>(p + 48 * L::bpp));
+        __m512i bytes = _mm512_packus_epi16(_mm512_packus_epi32(a, b), _mm512_packus_epi32(c, d));
+        _mm512_storeu_si512(dst + i, _mm512_permutexvar_epi32(order, bytes));
+    }
+    luma_avx2<L>(src + i * L::bpp, dst + i, n - i, w);
+}
+#endif
+
+// ============================================================================
+// Part 2: 灰度
+// ============================================================================
+
+template<typename L>
+inline void to_gray_scalar(const uint8_t* src, uint8_t* gray, size_t n) {
+    luma_scalar<L>(src, gray, n, kGrayWeights);
+}
+
+#ifdef PIXEL_HAS_AVX2
+template<typename L>
+inline void to_gray_avx2(const uint8_t* src, uint8_t* gray, size_t n) {
+    luma_avx2<L>(src, gray, n, kGrayWeights);
+}
+
+inline void rgb_to_gray_avx2(const uint8_t* rgb, uint8_t* gray, size_t pixel_count) {
+    to_gray_avx2<LayoutRGB>(rgb, gray, pixel_count);
+}
+#endif
+
+#ifdef PIXEL_HAS_AVX512BW
+template<typename L>
+inline void to_gray_avx512bw(const uint8_t* src, uint8_t* gray, size_t n) {
+    luma_avx512bw<L>(src, gray, n, kGrayWeights);
+}
+
+inline void rgb_to_gray_avx512bw(const uint8_t* rgb, uint8_t* gray, size_t pixel_count) {
+    to_gray_avx512bw<LayoutRGB>(rgb, gray, pixel_count);
+}
+#endif
+
+// 编译期可用的最宽实现
+template<typename L>
+inline void to_gray(const uint8_t* src, uint8_t* gray, size_t n) {
+#if defined(PIXEL_HAS_AVX512BW)
+    to_gray_avx512bw<L>(src, gray, n);
+#elif defined(PIXEL_HAS_AVX2)
+    to_gray_avx2<L>(src, gray, n);
+#else
+    to_gray_scalar<L>(src, gray, n);
+#endif
+}
+
+// ============================================================================
+// Part 3: 通道重排
+// ============================================================================
+
+// 目标像素的通道 c 取自源像素的通道 order[c]
+struct Swizzle3 { uint8_t order[3]; };
+struct Swizzle4 { uint8_t order[4]; };
+
+inline constexpr Swizzle3 kSwapRB3{ { 2, 1, 0 } };       // RGB ↔ BGR
+inline constexpr Swizzle4 kSwapRB4{ { 2, 1, 0, 3 } };    // RGBA ↔ BGRA
+inline constexpr Swizzle4 kRGBAtoARGB{ { 3, 0, 1, 2 } };
+inline constexpr Swizzle4 kARGBtoRGBA{ { 1, 2, 3, 0 } };
+
+inline void swizzle3_scalar(const uint8_t* src, uint8_t* dst, size_t n, const Swizzle3& s) {
+    for (size_t i = 0; i < n; ++i, src += 3, dst += 3) {
+        const uint8_t c0 = src[s.order[0]], c1 = src[s.order[1]], c2 = src[s.order[2]];
+        dst[0] = c0;
+        dst[1] = c1;
+        dst[2] = c2;
+    }
+}
+
+inline void swizzle4_scalar(const uint8_t* src, uint8_t* dst, size_t n, const Swizzle4& s) {
+    for (size_t i = 0; i < n; ++i, src += 4, dst += 4) {
+        const uint8_t c0 = src[s.order[0]], c1 = src[s.order[1]], c2 = src[s.order[2]], c3 = src[s.order[3]];
+        dst[0] = c0;
+        dst[1] = c1;
+        dst[2] = c2;
+        dst[3] = c3;
+    }
+}
+
+namespace pixel_detail {
+#ifdef PIXEL_HAS_AVX2
+// 一个 lane 内 16 字节的重排掩码：Bpp = 4 时 4 个像素占满，Bpp = 3 时前 12 字节有效
+template<int Bpp>
+inline __m128i swizzle_mask(const uint8_t* order) {
+    alignas(16) int8_t m[16];
+    for (int i = 0; i < 16; ++i) {
+        const int p = i / Bpp, c = i % Bpp;
+        m[i] = static_cast<int8_t>(p < 4 ? p * Bpp + order[c] : -128);
+    }
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(m));
+}
+#endif
+} // namespace pixel_detail
+
+#ifdef PIXEL_HAS_AVX2
+// 3 字节像素跨越 lane 边界，256 位 pshufb 不能跨 lane 搬运：先用 permutevar8x32 把
+// 8 个像素分到两个 lane，lane 内重排后再收拢回 24 字节，用 maskstore 只写有效部分
+inline void swizzle3_avx2(const uint8_t* src, uint8_t* dst, size_t n, const Swizzle3& s) {
+    using namespace pixel_detail;
+    const __m256i mask = _mm256_broadcastsi128_si256(swizzle_mask<3>(s.order));
+    const __m256i gather = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 0, 0);
+    const __m256i store_mask = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+
+    size_t i = 0;
+    for (; (i + 8) * 3 + kOverread8<3> <= n * 3; i += 8) {
+        __m256i v = _mm256_shuffle_epi8(load8_avx2<3>(src + i * 3), mask);
+        _mm256_maskstore_epi32(reinterpret_cast<int*>(dst + i * 3), store_mask,
+                               _mm256_permutevar8x32_epi32(v, gather));
+    }
+    swizzle3_scalar(src + i * 3, dst + i * 3, n - i, s);
+}
+
+inline void swizzle4_avx2(const uint8_t* src, uint8_t* dst, size_t n, const Swizzle4& s) {
+    const __m256i mask = _mm256_broadcastsi128_si256(pixel_detail::swizzle_mask<4>(s.order));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(v, mask));
+    }
+    swizzle4_scalar(src + i * 4, dst + i * 4, n - i, s);
+}
+#endif
+
+#ifdef PIXEL_HAS_AVX512BW
+// 与 AVX2 版本相同的思路：掩码加载 48 字节 → 分散到 4 个 lane → 重排 → 收拢 → 掩码存储 48 字节
+inline void swizzle3_avx512bw(const uint8_t* src, uint8_t* dst, size_t n, const Swizzle3& s) {
+    using namespace pixel_detail;
+    const __m512i mask = _mm512_broadcast_i32x4(swizzle_mask<3>(s.order));
+    const __m512i gather = _mm512_setr_epi32(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 0, 0, 0, 0);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_shuffle_epi8(load16_avx512<3>(src + i * 3), mask);
+        _mm512_mask_storeu_epi8(dst + i * 3, 0xFFFFFFFFFFFFull, _mm512_permutexvar_epi32(gather, v));
+    }
+    swizzle3_avx2(src + i * 3, dst + i * 3, n - i, s);
+}
+
+inline void swizzle4_avx512bw(const uint8_t* src, uint8_t* dst, size_t n, const Swizzle4& s) {
+    const __m512i mask = _mm512_broadcast_i32x4(pixel_detail::swizzle_mask<4>(s.order));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_si512(dst + i * 4, _mm512_shuffle_epi8(_mm512_loadu_si512(src + i * 4), mask));
+    }
+    swizzle4_avx2(src + i * 4, dst + i * 4, n - i, s);
+}
+#endif
+
+// ============================================================================
+// Part 4: RGBA 预乘 alpha
+// ============================================================================
+
+// c' = round(c * a / 255)，alpha 在每个像素的第 4 个字节（RGBA 与 BGRA 都适用）
+// 除以 255 的精确舍入：t = c*a + 128, c' = (t + (t >> 8)) >> 8，对 0..255 × 0..255 全部精确
+inline void premultiply_alpha_scalar(const uint8_t* src, uint8_t* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i, src += 4, dst += 4) {
+        const uint32_t a = src[3];
+        for (int c = 0; c < 3; ++c) {
+            const uint32_t t = src[c] * a + 128;
+            dst[c] = static_cast<uint8_t>((t + (t >> 8)) >> 8);
+        }
+        dst[3] = static_cast<uint8_t>(a);
+    }
+}
+
+#ifdef PIXEL_HAS_AVX2
+// 用 pshufb 把 alpha 广播到本像素的 3 个颜色字节，alpha 字节本身乘 255（结果仍为 a），
+// 字节展开为 16 位后 mullo，再用上面的移位公式除以 255
+inline void premultiply_alpha_avx2(const uint8_t* src, uint8_t* dst, size_t n) {
+    const __m256i alpha_mask = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(3, 3, 3, -128, 7, 7, 7, -128, 11, 11, 11, -128, 15, 15, 15, -128));
+    const __m256i alpha_255 = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i round = _mm256_set1_epi16(128);
+    const __m256i zero = _mm256_setzero_si256();
+
+    auto mul_div255 = [&](__m256i x, __m256i y) {
+        __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(x, y), round);
+        return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+    };
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        __m256i mult = _mm256_or_si256(_mm256_shuffle_epi8(px, alpha_mask), alpha_255);
+        __m256i lo = mul_div255(_mm256_unpacklo_epi8(px, zero), _mm256_unpacklo_epi8(mult, zero));
+        __m256i hi = mul_div255(_mm256_unpackhi_epi8(px, zero), _mm256_unpackhi_epi8(mult, zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_packus_epi16(lo, hi));
+    }
+    premultiply_alpha_scalar(src + i * 4, dst + i * 4, n - i);
+}
+#endif
+
+#ifdef PIXEL_HAS_AVX512BW
+inline void premultiply_alpha_avx512bw(const uint8_t* src, uint8_t* dst, size_t n) {
+    const __m512i alpha_mask = _mm512_broadcast_i32x4(
+        _mm_setr_epi8(3, 3, 3, -128, 7, 7, 7, -128, 11, 11, 11, -128, 15, 15, 15, -128));
+    const __m512i alpha_255 = _mm512_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m512i round = _mm512_set1_epi16(128);
+    const __m512i zero = _mm512_setzero_si512();
+
+    auto mul_div255 = [&](__m512i x, __m512i y) {
+        __m512i t = _mm512_add_epi16(_mm512_mullo_epi16(x, y), round);
+        return _mm512_srli_epi16(_mm512_add_epi16(t, _mm512_srli_epi16(t, 8)), 8);
+    };
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i px = _mm512_loadu_si512(src + i * 4);
+        __m512i mult = _mm512_or_si512(_mm512_shuffle_epi8(px, alpha_mask), alpha_255);
+        __m512i lo = mul_div255(_mm512_unpacklo_epi8(px, zero), _mm512_unpacklo_epi8(mult, zero));
+        __m512i hi = mul_div255(_mm512_unpackhi_epi8(px, zero), _mm512_unpackhi_epi8(mult, zero));
+        _mm512_storeu_si512(dst + i * 4, _mm512_packus_epi16(lo, hi));
+    }
+    premultiply_alpha_avx2(src + i * 4, dst + i * 4, n - i);
+}
+#endif
+
+// ============================================================================
+// Part 5: RGB → YUV420（BT.601 有限范围）
+// ============================================================================
+
+// Y 见 kLumaBT601。色度取 2x2 块 4 个像素的通道和 S，系数不变、多右移 2 位：
+//   U = ((-38 S_R -  74 S_G + 112 S_B + 512) >> 10) + 128
+//   V = ((112 S_R -  94 S_G -  18 S_B + 512) >> 10) + 128
+// 图像紧凑排列：RGB 行宽 width * bpp，Y 行宽 width，色度行宽 cw = (width + 1) / 2
+// （NV12 的 UV 交错行宽 2 * cw）。宽或高为奇数时，最后一列 / 行与自身配对
+
+struct I420Out {
+    uint8_t* u;
+    uint8_t* v;
+    I420Out row(size_t j, size_t cw) const { return { u + j * cw, v + j * cw }; }
+    void put(size_t k, int cu, int cv) const {
+        u[k] = static_cast<uint8_t>(cu);
+        v[k] = static_cast<uint8_t>(cv);
+    }
+};
+
+struct NV12Out {
+    uint8_t* uv;
+    NV12Out row(size_t j, size_t cw) const { return { uv + j * 2 * cw }; }
+    void put(size_t k, int cu, int cv) const {
+        uv[2 * k] = static_cast<uint8_t>(cu);
+        uv[2 * k + 1] = static_cast<uint8_t>(cv);
+    }
+};
+
+namespace pixel_detail {
+template<typename L, typename Out>
+inline void chroma_row_scalar(const uint8_t* r0, const uint8_t* r1, size_t width, size_t k_begin, const Out& out) {
+    const size_t cw = (width + 1) / 2;
+    for (size_t k = k_begin; k < cw; ++k) {
+        const size_t x0 = 2 * k * L::bpp, x1 = std::min(2 * k + 1, width - 1) * L::bpp;
+        auto sum = [&](int c) { return r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c]; };
+        const int sr = sum(L::r), sg = sum(L::g), sb = sum(L::b);
+        out.put(k, ((-38 * sr - 74 * sg + 112 * sb + 512) >> 10) + 128,
+                   ((112 * sr - 94 * sg - 18 * sb + 512) >> 10) + 128);
+    }
+}
+} // namespace pixel_detail
+
+template<typename L, typename Out>
+inline void rgb_to_yuv420_scalar(const uint8_t* src, size_t width, size_t height, uint8_t* y, const Out& chroma) {
+    const size_t stride = width * L::bpp, cw = (width + 1) / 2;
+    luma_scalar<L>(src, y, width * height, kLumaBT601);
+    for (size_t j = 0; j < (height + 1) / 2; ++j) {
+        const uint8_t* r0 = src + 2 * j * stride;
+        const uint8_t* r1 = src + std::min(2 * j + 1, height - 1) * stride;
+        pixel_detail::chroma_row_scalar<L>(r0, r1, width, 0, chroma.row(j, cw));
+    }
+}
+
+#ifdef PIXEL_HAS_AVX2
+namespace pixel_detail {
+// 8 个 32 位 U、V（线性顺序）收窄为字节写出
+inline void store_chroma8_avx2(const I420Out& out, size_t k, __m256i u, __m256i v) {
+    // lane l: [u 4 个, v 4 个] → dword 重排为 u0-3, u4-7, v0-3, v4-7
+    __m256i p = _mm256_packus_epi16(_mm256_packus_epi32(u, v), _mm256_setzero_si256());
+    __m128i uv = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(p, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out.u + k), uv);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out.v + k), _mm_srli_si128(uv, 8));
+}
+
+inline void store_chroma8_avx2(const NV12Out& out, size_t k, __m256i u, __m256i v) {
+    // U、V 都在 0..255 内，拼成 16 位 (U, V) 后一次收窄
+    __m256i uv = _mm256_or_si256(u, _mm256_slli_epi32(v, 8));
+    __m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi32(uv, uv), 0xD8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out.uv + 2 * k), _mm256_castsi256_si128(p));
+}
+
+// 每次处理两行各 16 个像素 → 8 个色度样本
+template<typename L, typename Out>
+inline void chroma_row_avx2(const uint8_t* r0, const uint8_t* r1, size_t width, const Out& out) {
+    const __m256i rg_mask = _mm256_broadcastsi128_si256(pair_mask<L::bpp>(L::r, L::g));
+    const __m256i b_mask = _mm256_broadcastsi128_si256(pair_mask<L::bpp>(L::b, -1));
+    const __m256i one_hi = _mm256_set1_epi32(1 << 16);
+    const __m256i u_rg = weight_pair(-38, -74), u_b1 = weight_pair(112, 512);
+    const __m256i v_rg = weight_pair(112, -94), v_b1 = weight_pair(-18, 512);
+    const __m256i offset = _mm256_set1_epi32(128);
+    const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    size_t x = 0;
+    for (; (x + 16) * L::bpp + kOverread8<L::bpp> <= width * L::bpp; x += 16) {
+        __m256i u[2], v[2];
+        for (int h = 0; h < 2; ++h) {
+            const size_t off = (x + 8 * h) * L::bpp;
+            const __m256i p0 = load8_avx2<L::bpp>(r0 + off), p1 = load8_avx2<L::bpp>(r1 + off);
+            // 垂直相加两行，再把相邻像素（相邻 dword）相加：偶数 dword 得到 2x2 块之和
+            __m256i rg = _mm256_add_epi16(_mm256_shuffle_epi8(p0, rg_mask), _mm256_shuffle_epi8(p1, rg_mask));
+            __m256i b = _mm256_add_epi16(_mm256_shuffle_epi8(p0, b_mask), _mm256_shuffle_epi8(p1, b_mask));
+            rg = _mm256_add_epi16(rg, _mm256_srli_epi64(rg, 32));
+            b = _mm256_or_si256(_mm256_add_epi16(b, _mm256_srli_epi64(b, 32)), one_hi);
+            u[h] = _mm256_add_epi32(_mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_madd_epi16(rg, u_rg), _mm256_madd_epi16(b, u_b1)), 10), offset);
+            v[h] = _mm256_add_epi32(_mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_madd_epi16(rg, v_rg), _mm256_madd_epi16(b, v_b1)), 10), offset);
+        }
+        // 两半各有 4 个有效值（偶数 dword），交错合并后恢复为色度 0..7
+        __m256i cu = _mm256_permutevar8x32_epi32(_mm256_blend_epi32(u[0], _mm256_slli_epi64(u[1], 32), 0xAA), order);
+        __m256i cv = _mm256_permutevar8x32_epi32(_mm256_blend_epi32(v[0], _mm256_slli_epi64(v[1], 32), 0xAA), order);
+        store_chroma8_avx2(out, x / 2, cu, cv);
+    }
+    chroma_row_scalar<L>(r0, r1, width, x / 2, out);
+}
+} // namespace pixel_detail
+
+template<typename L, typename Out>
+inline void rgb_to_yuv420_avx2(const uint8_t* src, size_t width, size_t height, uint8_t* y, const Out& chroma) {
+    const size_t stride = width * L::bpp, cw = (width + 1) / 2;
+    luma_avx2<L>(src, y, width * height, kLumaBT601);
+    for (size_t j = 0; j < (height + 1) / 2; ++j) {
+        const uint8_t* r0 = src + 2 * j * stride;
+        const uint8_t* r1 = src + std::min(2 * j + 1, height - 1) * stride;
+        pixel_detail::chroma_row_avx2<L>(r0, r1, width, chroma.row(j, cw));
+    }
+}
+#endif
+
+// ============================================================================
+// Part 6: YUV420 → RGB（BT.601 有限范围）
+// ============================================================================
+
+// C = Y - 16, D = U - 128, E = V - 128
+//   R = clamp((298 C + 409 E + 128) >> 8)
+//   G = clamp((298 C - 100 D - 208 E + 128) >> 8)
+//   B = clamp((298 C + 516 D + 128) >> 8)
+// 色度按最近邻上采样（像素 x 使用色度 x / 2）；4 字节输出布局的 alpha 置 255
+
+struct I420In {
+    const uint8_t* u;
+    const uint8_t* v;
+    I420In row(size_t j, size_t cw) const { return { u + j * cw, v + j * cw }; }
+    int u_at(size_t k) const { return u[k]; }
+    int v_at(size_t k) const { return v[k]; }
+};
+
+struct NV12In {
+    const uint8_t* uv;
+    NV12In row(size_t j, size_t cw) const { return { uv + j * 2 * cw }; }
+    int u_at(size_t k) const { return uv[2 * k]; }
+    int v_at(size_t k) const { return uv[2 * k + 1]; }
+};
+
+namespace pixel_detail {
+inline uint8_t clamp_u8(int x) {
+    return static_cast<uint8_t>(std::clamp(x, 0, 255));
+}
+
+template<typename L, typename In>
+inline void yuv_row_scalar(const uint8_t* y, const In& chroma, size_t width, size_t x_begin, uint8_t* dst) {
+    for (size_t x = x_begin; x < width; ++x) {
+        const int c = y[x] - 16, d = chroma.u_at(x / 2) - 128, e = chroma.v_at(x / 2) - 128;
+        uint8_t* p = dst + x * L::bpp;
+        p[L::r] = clamp_u8((298 * c + 409 * e + 128) >> 8);
+        p[L::g] = clamp_u8((298 * c - 100 * d - 208 * e + 128) >> 8);
+        p[L::b] = clamp_u8((298 * c + 516 * d + 128) >> 8);
+        if constexpr (L::bpp == 4) p[3] = 255;
+    }
+}
+} // namespace pixel_detail
+
+template<typename L, typename In>
+inline void yuv420_to_rgb_scalar(const uint8_t* y, const In& chroma, size_t width, size_t height, uint8_t* dst) {
+    const size_t cw = (width + 1) / 2;
+    for (size_t row = 0; row < height; ++row) {
+        pixel_detail::yuv_row_scalar<L>(y + row * width, chroma.row(row / 2, cw), width, 0,
+                                        dst + row * width * L::bpp);
+    }
+}
+
+#ifdef PIXEL_HAS_AVX2
+namespace pixel_detail {
+// 4 个色度样本 → 8 个像素的 32 位 U、V（每个样本重复两次）
+inline void load_chroma8_avx2(const I420In& in, size_t k, __m256i& u, __m256i& v) {
+    int32_t u4, v4;
+    std::memcpy(&u4, in.u + k, 4);
+    std::memcpy(&v4, in.v + k, 4);
+    __m128i u8 = _mm_cvtsi32_si128(u4), v8 = _mm_cvtsi32_si128(v4);
+    u = _mm256_cvtepu8_epi32(_mm_unpacklo_epi8(u8, u8));
+    v = _mm256_cvtepu8_epi32(_mm_unpacklo_epi8(v8, v8));
+}
+
+inline void load_chroma8_avx2(const NV12In& in, size_t k, __m256i& u, __m256i& v) {
+    // 8 字节 UV → 4 个 dword (U | V << 16)，每个复制到相邻两个像素
+    __m128i uv = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in.uv + 2 * k)));
+    __m256i pairs = _mm256_permutevar8x32_epi32(_mm256_zextsi128_si256(uv), _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3));
+    u = _mm256_and_si256(pairs, _mm256_set1_epi32(0xFFFF));
+    v = _mm256_srli_epi32(pairs, 16);
+}
+
+// 每次 8 个像素，32 位通道各占一个 dword；madd 的 16 位对为 (C, E)、(C, D)、(E, 1)
+template<typename L, typename In>
+inline void yuv_row_avx2(const uint8_t* y, const In& chroma, size_t width, uint8_t* dst) {
+    const __m256i low16 = _mm256_set1_epi32(0xFFFF), one_hi = _mm256_set1_epi32(1 << 16);
+    const __m256i w_r = weight_pair(298, 409), w_b = weight_pair(298, 516);
+    const __m256i w_g_cd = weight_pair(298, -100), w_g_e1 = weight_pair(-208, 128);
+    const __m256i round = _mm256_set1_epi32(128), y_off = _mm256_set1_epi32(16), c_off = _mm256_set1_epi32(128);
+    const __m256i zero = _mm256_setzero_si256(), max = _mm256_set1_epi32(255);
+    const __m256i alpha = L::bpp == 4 ? _mm256_set1_epi32(static_cast<int>(0xFF000000u)) : zero;
+    // 3 字节输出：lane 内去掉每个 dword 的第 4 字节，再把两个 lane 的 12 字节拼成连续 24 字节
+    const __m256i compact = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128));
+    const __m256i gather = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 0, 0);
+    const __m256i store_mask = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+
+    auto clamp = [&](__m256i x) { return _mm256_min_epi32(_mm256_max_epi32(x, zero), max); };
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i c = _mm256_sub_epi32(
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x))), y_off);
+        __m256i d, e;
+        load_chroma8_avx2(chroma, x / 2, d, e);
+        d = _mm256_sub_epi32(d, c_off);
+        e = _mm256_sub_epi32(e, c_off);
+
+        const __m256i c_lo = _mm256_and_si256(c, low16);
+        const __m256i ce = _mm256_or_si256(c_lo, _mm256_slli_epi32(e, 16));
+        const __m256i cd = _mm256_or_si256(c_lo, _mm256_slli_epi32(d, 16));
+        const __m256i e1 = _mm256_or_si256(_mm256_and_si256(e, low16), one_hi);
+
+        __m256i r = clamp(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(ce, w_r), round), 8));
+        __m256i g = clamp(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cd, w_g_cd),
+                                                             _mm256_madd_epi16(e1, w_g_e1)), 8));
+        __m256i b = clamp(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cd, w_b), round), 8));
+
+        __m256i px = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(r, 8 * L::r), _mm256_slli_epi32(g, 8 * L::g)),
+                                     _mm256_or_si256(_mm256_slli_epi32(b, 8 * L::b), alpha));
+        if constexpr (L::bpp == 4) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), px);
+        } else {
+            px = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(px, compact), gather);
+            _mm256_maskstore_epi32(reinterpret_cast<int*>(dst + x * 3), store_mask, px);
+        }
+    }
+    yuv_row_scalar<L>(y, chroma, width, x, dst);
+}
+} // namespace pixel_detail
+
+template<typename L, typename In>
+inline void yuv420_to_rgb_avx2(const uint8_t* y, const In& chroma, size_t width, size_t height, uint8_t* dst) {
+    const size_t cw = (width + 1) / 2;
+    for (size_t row = 0; row < height; ++row) {
+        pixel_detail::yuv_row_avx2<L>(y + row * width, chroma.row(row / 2, cw), width,
+                                      dst + row * width * L::bpp);
+    }
+}
+#endif
@@ -0,0 +1,315 @@
+// pixel_convert_benchmark.cpp
+// pixel_convert.hpp 的正确性与吞吐量测试
+// 1. 各种奇数宽高（覆盖尾部循环与奇数行列的色度配对）下，SIMD 结果与标量逐字节比较
+// 2. 4K 图像上每个转换的耗时与吞吐量（GB/s，按读 + 写字节数计算）
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <string>
+#include <functional>
+#include <cstdint>
+
+#include "pixel_convert.hpp"
+
+// ============================================================================
+// Part 1: 测试工具
+// ============================================================================
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes random_bytes(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(0, 255);
+    Bytes v(n);
+    for (auto& x : v) x = static_cast<uint8_t>(dist(rng));
+    return v;
+}
+
+// 一个转换的一种实现：读 src，写 dst（NV12 / I420 的多个平面拼在同一个缓冲区里）
+struct Variant {
+    std::string name;
+    std::function<void(const uint8_t* src, uint8_t* dst, size_t w, size_t h)> run;
+};
+
+struct Conversion {
+    std::string name;
+    size_t src_bpp_num, src_bpp_den;    // 每像素源字节数 = num / den（YUV420 为 3/2）
+    size_t dst_bpp_num, dst_bpp_den;
+    std::vector<Variant> variants;      // 第一个为标量参考实现
+
+    static size_t bytes(size_t w, size_t h, size_t num, size_t den) {
+        if (den == 2) return w * h + 2 * ((w + 1) / 2) * ((h + 1) / 2);   // YUV420
+        return w * h * num;
+    }
+    size_t src_bytes(size_t w, size_t h) const { return bytes(w, h, src_bpp_num, src_bpp_den); }
+    size_t dst_bytes(size_t w, size_t h) const { return bytes(w, h, dst_bpp_num, dst_bpp_den); }
+};
+
+// YUV420 缓冲区布局：Y 平面在前，其后是 U、V 平面（I420）或交错 UV 平面（NV12）
+I420Out i420_out(uint8_t* p, size_t w, size_t h) {
+    uint8_t* u = p + w * h;
+    return { u, u + ((w + 1) / 2) * ((h + 1) / 2) };
+}
+I420In i420_in(const uint8_t* p, size_t w, size_t h) {
+    const uint8_t* u = p + w * h;
+    return { u, u + ((w + 1) / 2) * ((h + 1) / 2) };
+}
+
+template<typename L>
+Variant gray_variant(std::string name, void (*fn)(const uint8_t*, uint8_t*, size_t)) {
+    return { std::move(name), [fn](const uint8_t* s, uint8_t* d, size_t w, size_t h) { fn(s, d, w * h); } };
+}
+
+std::vector<Conversion> make_conversions() {
+    std::vector<Conversion> conv;
+
+    auto gray = [&](std::string name, size_t bpp, auto layout) {
+        using L = decltype(layout);
+        Conversion c{ std::move(name), bpp, 1, 1, 1, {} };
+        c.variants.push_back(gray_variant<L>("scalar", to_gray_scalar<L>));
+#ifdef PIXEL_HAS_AVX2
+        c.variants.push_back(gray_variant<L>("AVX2", to_gray_avx2<L>));
+#endif
+#ifdef PIXEL_HAS_AVX512BW
+        c.variants.push_back(gray_variant<L>("AVX-512BW", to_gray_avx512bw<L>));
+#endif
+        conv.push_back(std::move(c));
+    };
+    gray("RGB -> gray", 3, LayoutRGB{});
+    gray("BGR -> gray", 3, LayoutBGR{});
+    gray("RGBA -> gray", 4, LayoutRGBA{});
+
+    {
+        Conversion c{ "RGB <-> BGR", 3, 1, 3, 1, {} };
+        auto add = [&](std::string name, void (*fn)(const uint8_t*, uint8_t*, size_t, const Swizzle3&)) {
+            c.variants.push_back({ std::move(name), [fn](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+                fn(s, d, w * h, kSwapRB3);
+            } });
+        };
+        add("scalar", swizzle3_scalar);
+#ifdef PIXEL_HAS_AVX2
+        add("AVX2", swizzle3_avx2);
+#endif
+#ifdef PIXEL_HAS_AVX512BW
+        add("AVX-512BW", swizzle3_avx512bw);
+#endif
+        conv.push_back(std::move(c));
+    }
+    {
+        Conversion c{ "RGBA -> ARGB", 4, 1, 4, 1, {} };
+        auto add = [&](std::string name, void (*fn)(const uint8_t*, uint8_t*, size_t, const Swizzle4&)) {
+            c.variants.push_back({ std::move(name), [fn](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+                fn(s, d, w * h, kRGBAtoARGB);
+            } });
+        };
+        add("scalar", swizzle4_scalar);
+#ifdef PIXEL_HAS_AVX2
+        add("AVX2", swizzle4_avx2);
+#endif
+#ifdef PIXEL_HAS_AVX512BW
+        add("AVX-512BW", swizzle4_avx512bw);
+#endif
+        conv.push_back(std::move(c));
+    }
+    {
+        Conversion c{ "RGBA premultiply", 4, 1, 4, 1, {} };
+        auto add = [&](std::string name, void (*fn)(const uint8_t*, uint8_t*, size_t)) {
+            c.variants.push_back({ std::move(name), [fn](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+                fn(s, d, w * h);
+            } });
+        };
+        add("scalar", premultiply_alpha_scalar);
+#ifdef PIXEL_HAS_AVX2
+        add("AVX2", premultiply_alpha_avx2);
+#endif
+#ifdef PIXEL_HAS_AVX512BW
+        add("AVX-512BW", premultiply_alpha_avx512bw);
+#endif
+        conv.push_back(std::move(c));
+    }
+
+    // RGB → YUV420 / YUV420 → RGB：AVX-512 没有单独的实现（Y 平面与 AVX2 共用 madd 思路，
+    // 色度部分受 2x2 归约后的重排限制，256 位已接近内存带宽）
+    {
+        Conversion c{ "RGB -> I420", 3, 1, 3, 2, {} };
+        c.variants.push_back({ "scalar", [](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+            rgb_to_yuv420_scalar<LayoutRGB>(s, w, h, d, i420_out(d, w, h));
+        } });
+#ifdef PIXEL_HAS_AVX2
+        c.variants.push_back({ "AVX2", [](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+            rgb_to_yuv420_avx2<LayoutRGB>(s, w, h, d, i420_out(d, w, h));
+        } });
+#endif
+        conv.push_back(std::move(c));
+    }
+    {
+        Conversion c{ "RGB -> NV12", 3, 1, 3, 2, {} };
+        c.variants.push_back({ "scalar", [](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+            rgb_to_yuv420_scalar<LayoutRGB>(s, w, h, d, NV12Out{ d + w * h });
+        } });
+#ifdef PIXEL_HAS_AVX2
+        c.variants.push_back({ "AVX2", [](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+            rgb_to_yuv420_avx2<LayoutRGB>(s, w, h, d, NV12Out{ d + w * h });
+        } });
+#endif
+        conv.push_back(std::move(c));
+    }
+    {
+        Conversion c{ "I420 -> RGB", 3, 2, 3, 1, {} };
+        c.variants.push_back({ "scalar", [](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+            yuv420_to_rgb_scalar<LayoutRGB>(s, i420_in(s, w, h), w, h, d);
+        } });
+#ifdef PIXEL_HAS_AVX2
+        c.variants.push_back({ "AVX2", [](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+            yuv420_to_rgb_avx2<LayoutRGB>(s, i420_in(s, w, h), w, h, d);
+        } });
+#endif
+        conv.push_back(std::move(c));
+    }
+    {
+        Conversion c{ "NV12 -> RGBA", 3, 2, 4, 1, {} };
+        c.variants.push_back({ "scalar", [](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+            yuv420_to_rgb_scalar<LayoutRGBA>(s, NV12In{ s + w * h }, w, h, d);
+        } });
+#ifdef PIXEL_HAS_AVX2
+        c.variants.push_back({ "AVX2", [](const uint8_t* s, uint8_t* d, size_t w, size_t h) {
+            yuv420_to_rgb_avx2<LayoutRGBA>(s, NV12In{ s + w * h }, w, h, d);
+        } });
+#endif
+        conv.push_back(std::move(c));
+    }
+    return conv;
+}
+
+// ============================================================================
+// Part 2: 正确性
+// ============================================================================
+
+bool check_parity(const std::vector<Conversion>& conversions) {
+    const size_t widths[] = { 1, 2, 7, 15, 16, 31, 33, 63, 64, 65, 127, 130, 641 };
+    const size_t heights[] = { 1, 2, 3, 8 };
+
+    bool all_ok = true;
+    for (const Conversion& c : conversions) {
+        bool ok = true;
+        for (size_t w : widths) {
+            for (size_t h : heights) {
+                const Bytes src = random_bytes(c.src_bytes(w, h), static_cast<uint32_t>(w * 131 + h));
+                Bytes ref(c.dst_bytes(w, h), 0xCD);
+                c.variants[0].run(src.data(), ref.data(), w, h);
+                for (size_t v = 1; v < c.variants.size(); ++v) {
+                    // 多分配一个保护区，检查 SIMD 版本没有越界写
+                    Bytes out(c.dst_bytes(w, h) + 64, 0xCD);
+                    c.variants[v].run(src.data(), out.data(), w, h);
+                    bool same = std::equal(ref.begin(), ref.end(), out.begin()) &&
+                                std::all_of(out.begin() + ref.size(), out.end(), [](uint8_t b) { return b == 0xCD; });
+                    if (!same && ok) {
+                        std::cout << "  MISMATCH: " << c.name << " [" << c.variants[v].name << "] at "
+                                  << w << "x" << h << "\n";
+                    }
+                    ok = ok && same;
+                }
+            }
+        }
+        std::cout << "  " << std::left << std::setw(20) << c.name
+                  << (ok ? "✓ bit-exact" : "✗ FAILED") << " (" << c.variants.size() << " variants)\n";
+        all_ok = all_ok && ok;
+    }
+    return all_ok;
+}
+
+// ============================================================================
+// 性能测试框架
+// ============================================================================
+
+template<typename Func>
+double benchmark(const std::string& name, double bytes, Func func, int iterations = 20) {
+    // 预热
+    func();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+        asm volatile("" : : : "memory");
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    std::cout << std::left << std::setw(35) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(3) << ms << " ms"
+              << std::setw(10) << std::setprecision(2) << bytes / (ms * 1e6) << " GB/s" << std::endl;
+    return ms;
+}
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+int main() {
+    constexpr size_t W = 3840, H = 2160;
+
+    std::cout << "================================================\n";
+    std::cout << "  Pixel Format Conversion (fixed-point SIMD)\n";
+    std::cout << "================================================\n";
+#if defined(PIXEL_HAS_AVX512BW)
+    std::cout << "Compiled for: AVX-512BW + AVX2\n\n";
+#elif defined(PIXEL_HAS_AVX2)
+    std::cout << "Compiled for: AVX2\n\n";
+#else
+    std::cout << "Compiled for: scalar only (build with -mavx2 or -march=native)\n\n";
+#endif
+
+    const std::vector<Conversion> conversions = make_conversions();
+
+    std::cout << "Parity vs scalar (odd sizes, tails, guard bytes):\n";
+    std::cout << "------------------------------------------------\n";
+    const bool ok = check_parity(conversions);
+    std::cout << "\n";
+
+    std::cout << "Throughput, " << W << "x" << H << " (bytes read + written):\n";
+    std::cout << "------------------------------------------------\n";
+    for (const Conversion& c : conversions) {
+        const size_t src_size = c.src_bytes(W, H), dst_size = c.dst_bytes(W, H);
+        const Bytes src = random_bytes(src_size, 7);
+        Bytes dst(dst_size);
+        const double bytes = static_cast<double>(src_size + dst_size);
+
+        double scalar_ms = 0.0;
+        for (const Variant& v : c.variants) {
+            double ms = benchmark(c.name + " [" + v.name + "]", bytes, [&]() {
+                v.run(src.data(), dst.data(), W, H);
+            });
+            if (scalar_ms == 0.0) scalar_ms = ms;
+            else std::cout << "    speedup vs scalar: " << std::setprecision(2) << scalar_ms / ms << "x\n";
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "================================================\n";
+    std::cout << "Summary\n";
+    std::cout << "================================================\n";
+    std::cout << "✓ pshufb deinterleave + madd_epi16: 3 weights and rounding bias in 2 multiplies\n";
+    std::cout << "✓ All arithmetic is fixed point: SIMD output is bit-exact with scalar\n";
+    std::cout << "✓ 3-byte pixels: cross-lane permute into 4-pixel lanes, masked store on the way out\n";
+    std::cout << "✓ Results: " << (ok ? "all variants match" : "MISMATCH!") << "\n";
+    std::cout << "================================================\n";
+
+    return ok ? 0 : 1;
+}
+
+/* 编译与运行:
+
+  g++ -std=c++20 -O3 -march=native pixel_convert_benchmark.cpp -o pixel_convert
+  ./pixel_convert
+
+  g++ -std=c++20 -O3 -mavx2 -mfma pixel_convert_benchmark.cpp -o pixel_convert_avx2   # 只有 AVX2
+  g++ -std=c++20 -O3 pixel_convert_benchmark.cpp -o pixel_convert_scalar              # 只有标量
+
+预期结果（单核，4K 图像每个转换读 + 写 33-58 MB，全部超出 LLC）:
+  - RGB → gray：标量受 3 字节步长限制，AVX2 / AVX-512BW 快 2-4x，接近内存带宽
+  - 通道重排、预乘：SIMD 快 3-5x，AVX-512BW 相对 AVX2 的提升主要来自更少的指令
+  - RGB → YUV420：AVX2 快约 3x；YUV420 → RGB 标量有 3 次钳位和乘法，AVX2 快 6x 以上
+*/
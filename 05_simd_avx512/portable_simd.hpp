@@ -0,0 +1,173 @@
+// portable_simd.hpp
+// 基于 std::experimental::simd（Parallelism TS v2）的可移植内核：
+// add、fma、dot、conditional_add、RGB → 灰度
+//
+// 1. 每个内核以 simd 类型 V 为模板参数：默认 native_simd<float>（AVX-512 上 16 lane、
+//    AVX2 上 8 lane、ARM NEON 上 4 lane），也可以用 fixed_size_simd<float, 8> 固定宽度，
+//    与某个 intrinsics 版本逐条对照
+// 2. 逐元素内核（add / fma / conditional_add / 灰度）与 intrinsics 版本逐位相同；
+//    dot 的水平求和顺序按 simd_kernels_<isa>.cpp 的写法固定下来（先对半折叠到 4 lane，
+//    再 (x0 + x1) + (x2 + x3)，与 hadd 相同），尾部同样逐个标量累加，因此也逐位相同。
+//    stdx::reduce 的求和顺序由实现决定，用它时只能保证 ULP 级一致
+// 3. 灰度没有 pshufb：用生成器构造函数按像素取通道（编译为 gather 或逐个插入），
+//    定点公式与 pixel_convert.hpp 的 luma_scalar 相同
+//
+// 内核本身不含任何 intrinsics（pixel_convert.hpp 只用到可移植的布局、权重与标量实现），
+// 换到 aarch64 只需要重新编译
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// libstdc++ 的 simd 在 x86 上引用 AVX-512 内联函数，GCC 12 会在其中报误报的 -Wuninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <experimental/simd>
+#pragma GCC diagnostic pop
+
+#include "pixel_convert.hpp"
+
+namespace simd_portable {
+
+namespace stdx = std::experimental;
+
+using NativeF = stdx::native_simd<float>;
+
+// ============================================================================
+// Part 1: 尾部掩码与固定顺序的水平求和
+// ============================================================================
+
+namespace detail {
+
+// 前 k 个 lane 为 true（k < V::size()）
+template<typename V>
+inline typename V::mask_type first_lanes(size_t k) {
+    using T = typename V::value_type;
+    const V lane([](auto i) { return static_cast<T>(i); });
+    return lane < V(static_cast<T>(k));
+}
+
+// 掩码加载：被屏蔽的 lane 为 0，不访问对应内存
+template<typename V>
+inline V load_masked(const typename V::value_type* p, typename V::mask_type m) {
+    V v = 0;
+    stdx::where(m, v).copy_from(p, stdx::element_aligned);
+    return v;
+}
+
+// 先对半折叠到 4 lane，再 (x0 + x1) + (x2 + x3)：与 _mm256 / _mm512 版本的
+// extract + add + 两次 hadd 顺序相同
+template<typename V>
+inline typename V::value_type hsum_fixed(const V& v) {
+    constexpr size_t W = V::size();
+    if constexpr (W > 4) {
+        using Half = stdx::resize_simd_t<W / 2, V>;
+        const auto halves = stdx::split<Half>(v);
+        return hsum_fixed(halves[0] + halves[1]);
+    } else if constexpr (W == 4) {
+        return (v[0] + v[1]) + (v[2] + v[3]);
+    } else {
+        return stdx::reduce(v);
+    }
+}
+
+} // namespace detail
+
+// ============================================================================
+// Part 2: 浮点内核
+// ============================================================================
+
+// c = a + b
+template<typename V = NativeF>
+inline void add(const float* a, const float* b, float* c, size_t n) {
+    constexpr size_t W = V::size();
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const V va(a + i, stdx::element_aligned), vb(b + i, stdx::element_aligned);
+        (va + vb).copy_to(c + i, stdx::element_aligned);
+    }
+    if (i < n) {
+        const auto m = detail::first_lanes<V>(n - i);
+        stdx::where(m, detail::load_masked<V>(a + i, m) + detail::load_masked<V>(b + i, m))
+            .copy_to(c + i, stdx::element_aligned);
+    }
+}
+
+// result = a * b + c（单次舍入）
+template<typename V = NativeF>
+inline void fma(const float* a, const float* b, const float* c, float* result, size_t n) {
+    constexpr size_t W = V::size();
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const V va(a + i, stdx::element_aligned), vb(b + i, stdx::element_aligned), vc(c + i, stdx::element_aligned);
+        stdx::fma(va, vb, vc).copy_to(result + i, stdx::element_aligned);
+    }
+    if (i < n) {
+        const auto m = detail::first_lanes<V>(n - i);
+        const V r = stdx::fma(detail::load_masked<V>(a + i, m), detail::load_masked<V>(b + i, m),
+                              detail::load_masked<V>(c + i, m));
+        stdx::where(m, r).copy_to(result + i, stdx::element_aligned);
+    }
+}
+
+// 单累加器点积；尾部逐个标量累加（与 intrinsics 版本逐位相同，见文件头）
+template<typename V = NativeF>
+inline float dot(const float* a, const float* b, size_t n) {
+    constexpr size_t W = V::size();
+    V acc = 0;
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        acc = stdx::fma(V(a + i, stdx::element_aligned), V(b + i, stdx::element_aligned), acc);
+    }
+    float sum = detail::hsum_fixed(acc);
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// c = a > threshold ? a + b : a
+template<typename V = NativeF>
+inline void conditional_add(const float* a, const float* b, float* c, float threshold, size_t n) {
+    constexpr size_t W = V::size();
+    const V vt = threshold;
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        V va(a + i, stdx::element_aligned);
+        const V vb(b + i, stdx::element_aligned);
+        stdx::where(va > vt, va) += vb;
+        va.copy_to(c + i, stdx::element_aligned);
+    }
+    if (i < n) {
+        const auto m = detail::first_lanes<V>(n - i);
+        V va = detail::load_masked<V>(a + i, m);
+        stdx::where(va > vt, va) += detail::load_masked<V>(b + i, m);
+        stdx::where(m, va).copy_to(c + i, stdx::element_aligned);
+    }
+}
+
+// ============================================================================
+// Part 3: RGB → 灰度（定点）
+// ============================================================================
+
+// Y = (wr * R + wg * G + wb * B + bias) >> shift，32 位整数 lane，lane 数与 V 相同
+template<typename L = LayoutRGB, typename V = NativeF>
+inline void to_gray(const uint8_t* src, uint8_t* gray, size_t n, const LumaWeights& w = kGrayWeights) {
+    using I = stdx::rebind_simd_t<int32_t, V>;
+    using B = stdx::rebind_simd_t<uint8_t, V>;
+    constexpr size_t W = V::size();
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const uint8_t* p = src + i * L::bpp;
+        const I r([&](auto k) { return static_cast<int32_t>(p[k * L::bpp + L::r]); });
+        const I g([&](auto k) { return static_cast<int32_t>(p[k * L::bpp + L::g]); });
+        const I b([&](auto k) { return static_cast<int32_t>(p[k * L::bpp + L::b]); });
+        const I y = (r * w.wr + g * w.wg + b * w.wb + w.bias) >> w.shift;
+        stdx::static_simd_cast<B>(y).copy_to(gray + i, stdx::element_aligned);
+    }
+    luma_scalar<L>(src + i * L::bpp, gray + i, n - i, w);
+}
+
+} // namespace simd_portable
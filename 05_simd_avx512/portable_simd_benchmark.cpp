@@ -0,0 +1,257 @@
+// portable_simd_benchmark.cpp
+// portable_simd.hpp（std::experimental::simd）与 intrinsics 版本逐对比较
+// 1. 一致性：add / fma / dot / conditional_add 与 simd_kernels_<isa>.cpp 的分派内核、
+//    灰度与 pixel_convert.hpp 的 AVX2 / AVX-512BW 版本比较；逐位相同记为 bit-exact，
+//    否则报告最大 ULP 距离。长度取 1..300 全部 + 大数组，覆盖尾部
+// 2. 性能：同一宽度的两个版本各自计时（L2 内 16K 元素 + 16M 元素的访存受限情形），
+//    ratio = stdx / intrinsics，> 1 表示可移植版本更慢
+// 结论列：bit-exact 且 ratio <= 1.10 记为 "portable"，即可以换成可移植代码而没有损失
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+#include "portable_simd.hpp"
+#include "simd_dispatch.h"
+
+namespace sp = simd_portable;
+namespace stdx = std::experimental;
+
+#if !defined(__AVX2__) || !defined(__FMA__)
+int main() {
+    std::cout << "portable_simd_benchmark compares against AVX2 intrinsics: build with -march=native\n";
+    return 0;
+}
+#else
+
+// ============================================================================
+// 性能测试框架
+// ============================================================================
+
+// 每轮重复 reps 次取平均，5 轮取最小值，返回单次调用的微秒数
+template<typename Func>
+double best_us(Func func, int reps) {
+    func();
+    double best = 1e300;
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            func();
+            asm volatile("" : : : "memory");
+        }
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::micro>(end - start).count() / reps);
+    }
+    return best;
+}
+
+// fp32 的 ULP 距离：把位模式映射到单调的整数轴上相减
+int64_t ulp_distance(float x, float y) {
+    auto ordered = [](float v) {
+        int32_t i;
+        std::memcpy(&i, &v, sizeof i);
+        return i < 0 ? -static_cast<int64_t>(i & 0x7fffffff) : static_cast<int64_t>(i);
+    };
+    return std::abs(ordered(x) - ordered(y));
+}
+
+// 一对实现（intrinsics / stdx）的比较结果
+struct Parity {
+    int64_t max_ulp = 0;
+    bool bit_exact() const { return max_ulp == 0; }
+    void merge(const float* x, const float* y, size_t n) {
+        for (size_t i = 0; i < n; ++i) max_ulp = std::max(max_ulp, ulp_distance(x[i], y[i]));
+    }
+    void merge(const uint8_t* x, const uint8_t* y, size_t n) {
+        for (size_t i = 0; i < n; ++i) max_ulp = std::max<int64_t>(max_ulp, std::abs(int(x[i]) - int(y[i])));
+    }
+};
+
+struct Totals {
+    bool all_exact = true;
+    std::vector<std::string> portable, slower;
+};
+
+void print_header() {
+    std::cout << std::left << std::setw(17) << "kernel" << std::setw(9) << "width" << std::setw(11) << "size"
+              << std::right << std::setw(14) << "intrinsics us" << std::setw(10) << "stdx us" << std::setw(8) << "ratio"
+              << std::setw(13) << "parity" << std::setw(11) << "verdict" << "\n";
+    std::cout << std::string(93, '-') << "\n";
+}
+
+void print_row(const std::string& kernel, const char* width, const std::string& size, double t_intr, double t_stdx,
+               const Parity& parity, Totals& totals) {
+    const double ratio = t_stdx / t_intr;
+    const bool portable = parity.bit_exact() && ratio <= 1.10;
+    const std::string parity_label = parity.bit_exact() ? "bit-exact" : std::to_string(parity.max_ulp) + " ULP";
+    std::cout << std::left << std::setw(17) << kernel << std::setw(9) << width << std::setw(11) << size << std::right
+              << std::fixed << std::setprecision(2) << std::setw(14) << t_intr << std::setw(10) << t_stdx
+              << std::setw(7) << ratio << "x" << std::setw(13) << parity_label
+              << std::setw(11) << (portable ? "portable" : "keep") << "\n";
+    totals.all_exact = totals.all_exact && parity.bit_exact();
+    const std::string tag = kernel + " (" + width + ", " + size + ")";
+    (portable ? totals.portable : totals.slower).push_back(tag);
+}
+
+// ============================================================================
+// 浮点内核：分派表中的 intrinsics 版本 vs 同宽度的 stdx 版本
+// ============================================================================
+
+struct Data {
+    std::vector<float> a, b, c, out_intr, out_stdx;
+};
+
+// 每个内核的 intr / stdx 分别写 out_intr / out_stdx，dot 只写第 0 个元素
+template<typename V>
+void float_kernels(const SimdKernels& k, const char* width, Data& d, const std::vector<size_t>& sizes,
+                   Totals& totals) {
+    const float* a = d.a.data();
+    const float* b = d.b.data();
+    const float* c = d.c.data();
+    float* oi = d.out_intr.data();
+    float* os = d.out_stdx.data();
+    constexpr float kThreshold = 0.0f;
+
+    struct Kernel {
+        const char* name;
+        std::function<void(size_t)> intr, stdx;
+        size_t outputs(size_t n) const { return std::strcmp(name, "dot") == 0 ? 1 : n; }
+    };
+    const Kernel kernels[] = {
+        { "add", [&](size_t n) { k.vector_add(a, b, oi, n); }, [&](size_t n) { sp::add<V>(a, b, os, n); } },
+        { "fma", [&](size_t n) { k.fma(a, b, c, oi, n); }, [&](size_t n) { sp::fma<V>(a, b, c, os, n); } },
+        { "dot", [&](size_t n) { oi[0] = k.dot_product(a, b, n); }, [&](size_t n) { os[0] = sp::dot<V>(a, b, n); } },
+        { "conditional_add", [&](size_t n) { k.conditional_add(a, b, oi, kThreshold, n); },
+          [&](size_t n) { sp::conditional_add<V>(a, b, os, kThreshold, n); } },
+    };
+
+    for (const Kernel& kernel : kernels) {
+        Parity parity;
+        for (size_t n = 1; n <= 300; ++n) {
+            kernel.intr(n);
+            kernel.stdx(n);
+            parity.merge(oi, os, kernel.outputs(n));
+        }
+        for (size_t n : sizes) {
+            kernel.intr(n);
+            kernel.stdx(n);
+            parity.merge(oi, os, kernel.outputs(n));
+            const int reps = static_cast<int>(std::clamp<size_t>(100'000'000 / n, 5, 20'000));
+            const double t_intr = best_us([&]() { kernel.intr(n); }, reps);
+            const double t_stdx = best_us([&]() { kernel.stdx(n); }, reps);
+            print_row(kernel.name, width, n >= 1'000'000 ? std::to_string(n >> 20) + "M" : std::to_string(n >> 10) + "K",
+                      t_intr, t_stdx, parity, totals);
+        }
+    }
+}
+
+// ============================================================================
+// RGB → 灰度：pixel_convert.hpp 的 pshufb + madd 版本 vs stdx 生成器构造
+// ============================================================================
+
+template<typename V, typename Intr>
+void gray_kernel(const char* width, Intr intr, Totals& totals) {
+    const size_t pixels = 1920 * 1080;
+    std::vector<uint8_t> rgb(pixels * 3), gray_intr(pixels), gray_stdx(pixels);
+    for (size_t i = 0; i < rgb.size(); ++i) rgb[i] = static_cast<uint8_t>(i * 2654435761u >> 24);
+
+    Parity parity;
+    for (size_t n = 1; n <= 300; ++n) {
+        intr(rgb.data(), gray_intr.data(), n);
+        sp::to_gray<LayoutRGB, V>(rgb.data(), gray_stdx.data(), n);
+        parity.merge(gray_intr.data(), gray_stdx.data(), n);
+    }
+    intr(rgb.data(), gray_intr.data(), pixels);
+    sp::to_gray<LayoutRGB, V>(rgb.data(), gray_stdx.data(), pixels);
+    parity.merge(gray_intr.data(), gray_stdx.data(), pixels);
+
+    const double t_intr = best_us([&]() { intr(rgb.data(), gray_intr.data(), pixels); }, 50);
+    const double t_stdx = best_us([&]() { sp::to_gray<LayoutRGB, V>(rgb.data(), gray_stdx.data(), pixels); }, 50);
+    print_row("rgb_to_gray", width, "1920x1080", t_intr, t_stdx, parity, totals);
+}
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+int main() {
+    std::cout << "================================================\n";
+    std::cout << "  Portable SIMD (std::experimental::simd) vs Intrinsics\n";
+    std::cout << "================================================\n";
+    std::cout << "native_simd<float>: " << sp::NativeF::size() << " lanes\n";
+    std::cout << "ratio = stdx time / intrinsics time; portable = bit-exact and ratio <= 1.10\n\n";
+
+    constexpr size_t N_SMALL = 16 * 1024;        // 64 KB / 数组，L2 内
+    constexpr size_t N_LARGE = 16 * 1024 * 1024; // 64 MB / 数组，访存受限
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    Data d;
+    for (auto* v : { &d.a, &d.b, &d.c }) {
+        v->resize(N_LARGE);
+        for (auto& x : *v) x = dist(rng);
+    }
+    d.out_intr.resize(N_LARGE);
+    d.out_stdx.resize(N_LARGE);
+
+    Totals totals;
+    print_header();
+    float_kernels<stdx::fixed_size_simd<float, 8>>(kAvx2Kernels, "8 lane", d, { N_SMALL, N_LARGE }, totals);
+#ifdef __AVX512F__
+    float_kernels<stdx::fixed_size_simd<float, 16>>(kAvx512Kernels, "16 lane", d, { N_SMALL, N_LARGE }, totals);
+#endif
+    gray_kernel<stdx::fixed_size_simd<float, 8>>("8 lane", [](const uint8_t* s, uint8_t* g, size_t n) {
+        to_gray_avx2<LayoutRGB>(s, g, n);
+    }, totals);
+#ifdef PIXEL_HAS_AVX512BW
+    gray_kernel<stdx::fixed_size_simd<float, 16>>("16 lane", [](const uint8_t* s, uint8_t* g, size_t n) {
+        to_gray_avx512bw<LayoutRGB>(s, g, n);
+    }, totals);
+#endif
+
+    std::cout << "\n================================================\n";
+    std::cout << "Summary\n";
+    std::cout << "================================================\n";
+    std::cout << (totals.all_exact ? "✓" : "✗") << " Parity: "
+              << (totals.all_exact ? "every stdx kernel is bit-identical to its intrinsics twin" : "ULP differences, see table")
+              << "\n";
+    std::cout << "✓ Portable with no loss: " << totals.portable.size() << " of "
+              << totals.portable.size() + totals.slower.size() << " kernel / width / size cases\n";
+    for (const std::string& s : totals.slower) std::cout << "  keep intrinsics: " << s << "\n";
+    std::cout << "================================================\n";
+
+    return totals.all_exact ? 0 : 1;
+}
+
+#endif
+
+/* 编译与运行:
+
+  # 分派内核的翻译单元一起编译（同一套 -march=native）
+  g++ -std=c++20 -O3 -march=native portable_simd_benchmark.cpp simd_dispatch.cpp \
+      simd_kernels_scalar.cpp simd_kernels_avx2.cpp simd_kernels_avx512.cpp -o portable_simd
+  ./portable_simd
+
+  # 不要加 -ffp-contract=off：分派内核的标量尾部 a * b + c 依赖默认的 FMA 合并，
+  # 与 stdx::fma 的单次舍入一致；关掉后 fma / dot 的尾部会出现 1 ULP 差异
+
+  # aarch64（只编译可移植部分，intrinsics 对照需要 x86）:
+  #   g++ -std=c++20 -O3 -mcpu=native 引用 portable_simd.hpp 的代码即可，native_simd<float> 为 4 lane
+
+预期结果:
+  - add / fma：bit-exact，ratio 约 1.0（噪声 ±10%）；libstdc++ 把 simd 运算直接编译成 vaddps / vfmadd，
+    16M 元素时两者都在内存带宽上限
+  - conditional_add：bit-exact；16K 时 stdx 慢 10-30%：where(va > vt, va) += vb 被编译成
+    "内存操作数比较 + 再加载一次 a"，intrinsics 版本只加载一次；16M 时被带宽掩盖
+  - dot：固定求和顺序后 bit-exact；16K 时 ratio 约 1.0（stdx::split 只在循环外调用一次）
+  - rgb_to_gray：bit-exact 但慢 3-8 倍。标准 simd 没有字节 shuffle，生成器构造逐个 vpinsrb
+    插入通道；要移植这类内核，需要等 std::simd 的 permute（C++26）或保留 intrinsics 版本
+  - 结论：逐元素 / 归约类浮点内核可以直接换成可移植代码，ARM 上只需重新编译；
+    依赖 pshufb / madd 这类 ISA 专有技巧的整数内核仍然保留 intrinsics
+*/
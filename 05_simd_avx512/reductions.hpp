@@ -0,0 +1,516 @@
+// reductions.hpp
+// SIMD 归约：sum、dot、norm、min / max、argmin / argmax、mean / variance
+//
+// 1. K 个独立累加器（默认 4，最多 8）：单累加器的归约被加法 / FMA 延迟（4 周期）卡住，
+//    每周期只能完成 1/4 - 1/8 的峰值吞吐；K 条依赖链交错执行才能喂满两个 FMA 端口
+// 2. fp32 求和的精度模式：朴素、Kahan 补偿、分块两两（pairwise）求和、fp64 累加
+// 3. 同一份算法模板通过 Ops 描述 ISA（ScalarOps / Avx2Ops / Avx512Ops），与
+//    expression_templates.hpp 的 packet 层是同一个思路
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include "simd_intrin.hpp"
+#define REDUCE_HAS_AVX2
+#ifdef __AVX512F__
+#define REDUCE_HAS_AVX512
+#endif
+#endif
+
+namespace simd_reduce {
+
+// ============================================================================
+// Part 1: ISA 描述
+// ============================================================================
+
+// 每个 Ops 提供：fp32 向量 V（W 个 lane）、fp64 向量 D（一个 V 展开为 DW 个 D）、
+// 32 位下标向量 I，以及归约所需的最小操作集合
+
+struct ScalarOps {
+    static constexpr const char* name = "scalar";
+    using V = float;
+    using D = double;
+    using I = int32_t;
+    static constexpr size_t W = 1, DW = 1;
+
+    static V zero() { return 0.0f; }
+    static V set1(float x) { return x; }
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V a) { *p = a; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V fmadd(V a, V b, V c) { return a * b + c; }
+    static V fmsub(V a, V b, V c) { return a * b - c; }
+    // min(x, acc)：x 为 NaN 时返回 acc（与 minps 的语义一致，NaN 被忽略）
+    static V min(V a, V b) { return a < b ? a : b; }
+    static V max(V a, V b) { return a > b ? a : b; }
+    static float hsum(V a) { return a; }
+    static float hmin(V a) { return a; }
+    static float hmax(V a) { return a; }
+
+    template<int H> static D widen(V a) { return a; }
+    static D dzero() { return 0.0; }
+    static D dset1(double x) { return x; }
+    static D dadd(D a, D b) { return a + b; }
+    static D dsub(D a, D b) { return a - b; }
+    static D dfmadd(D a, D b, D c) { return a * b + c; }
+    static double dhsum(D a) { return a; }
+
+    static I iota() { return 0; }
+    static I add_i(I a, int32_t b) { return a + b; }
+    static I set1_i(int32_t x) { return x; }
+    static void store_i(int32_t* p, I a) { *p = a; }
+    static void keep_lt(V x, I xi, V& best, I& bi) { if (x < best) { best = x; bi = xi; } }
+    static void keep_gt(V x, I xi, V& best, I& bi) { if (x > best) { best = x; bi = xi; } }
+};
+
+#ifdef REDUCE_HAS_AVX2
+struct Avx2Ops {
+    static constexpr const char* name = "AVX2";
+    using V = __m256;
+    using D = __m256d;
+    using I = __m256i;
+    static constexpr size_t W = 8, DW = 2;
+
+    static V zero() { return _mm256_setzero_ps(); }
+    static V set1(float x) { return _mm256_set1_ps(x); }
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V a) { _mm256_storeu_ps(p, a); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+    static V fmsub(V a, V b, V c) { return _mm256_fmsub_ps(a, b, c); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+
+    // 256 → 128 → 64 → 32
+    template<typename F>
+    static float fold(V a, F op) {
+        __m128 x = op(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        x = op(x, _mm_movehl_ps(x, x));
+        x = op(x, _mm_movehdup_ps(x));
+        return _mm_cvtss_f32(x);
+    }
+    static float hsum(V a) { return fold(a, [](__m128 x, __m128 y) { return _mm_add_ps(x, y); }); }
+    static float hmin(V a) { return fold(a, [](__m128 x, __m128 y) { return _mm_min_ps(x, y); }); }
+    static float hmax(V a) { return fold(a, [](__m128 x, __m128 y) { return _mm_max_ps(x, y); }); }
+
+    template<int H> static D widen(V a) { return _mm256_cvtps_pd(_mm256_extractf128_ps(a, H)); }
+    static D dzero() { return _mm256_setzero_pd(); }
+    static D dset1(double x) { return _mm256_set1_pd(x); }
+    static D dadd(D a, D b) { return _mm256_add_pd(a, b); }
+    static D dsub(D a, D b) { return _mm256_sub_pd(a, b); }
+    static D dfmadd(D a, D b, D c) { return _mm256_fmadd_pd(a, b, c); }
+    static double dhsum(D a) {
+        __m128d x = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+    }
+
+    static I iota() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+    static I add_i(I a, int32_t b) { return _mm256_add_epi32(a, _mm256_set1_epi32(b)); }
+    static I set1_i(int32_t x) { return _mm256_set1_epi32(x); }
+    static void store_i(int32_t* p, I a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a); }
+    static void keep_lt(V x, I xi, V& best, I& bi) {
+        V m = _mm256_cmp_ps(x, best, _CMP_LT_OQ);
+        best = _mm256_blendv_ps(best, x, m);
+        bi = _mm256_blendv_epi8(bi, xi, _mm256_castps_si256(m));
+    }
+    static void keep_gt(V x, I xi, V& best, I& bi) {
+        V m = _mm256_cmp_ps(x, best, _CMP_GT_OQ);
+        best = _mm256_blendv_ps(best, x, m);
+        bi = _mm256_blendv_epi8(bi, xi, _mm256_castps_si256(m));
+    }
+};
+#endif
+
+#ifdef REDUCE_HAS_AVX512
+struct Avx512Ops {
+    static constexpr const char* name = "AVX-512";
+    using V = __m512;
+    using D = __m512d;
+    using I = __m512i;
+    static constexpr size_t W = 16, DW = 2;
+
+    static V zero() { return _mm512_setzero_ps(); }
+    static V set1(float x) { return _mm512_set1_ps(x); }
+    static V load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, V a) { _mm512_storeu_ps(p, a); }
+    static V add(V a, V b) { return _mm512_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+    static V fmsub(V a, V b, V c) { return _mm512_fmsub_ps(a, b, c); }
+    static V min(V a, V b) { return _mm512_min_ps(a, b); }
+    static V max(V a, V b) { return _mm512_max_ps(a, b); }
+
+    static __m256 low(V a) { return _mm512_castps512_ps256(a); }
+    static __m256 high(V a) { return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a), 1)); }
+    static float hsum(V a) { return Avx2Ops::hsum(_mm256_add_ps(low(a), high(a))); }
+    static float hmin(V a) { return Avx2Ops::hmin(_mm256_min_ps(low(a), high(a))); }
+    static float hmax(V a) { return Avx2Ops::hmax(_mm256_max_ps(low(a), high(a))); }
+
+    template<int H> static D widen(V a) { return _mm512_cvtps_pd(H == 0 ? low(a) : high(a)); }
+    static D dzero() { return _mm512_setzero_pd(); }
+    static D dset1(double x) { return _mm512_set1_pd(x); }
+    static D dadd(D a, D b) { return _mm512_add_pd(a, b); }
+    static D dsub(D a, D b) { return _mm512_sub_pd(a, b); }
+    static D dfmadd(D a, D b, D c) { return _mm512_fmadd_pd(a, b, c); }
+    static double dhsum(D a) {
+        return Avx2Ops::dhsum(_mm256_add_pd(_mm512_castpd512_pd256(a), _mm512_extractf64x4_pd(a, 1)));
+    }
+
+    static I iota() { return _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15); }
+    static I add_i(I a, int32_t b) { return _mm512_add_epi32(a, _mm512_set1_epi32(b)); }
+    static I set1_i(int32_t x) { return _mm512_set1_epi32(x); }
+    static void store_i(int32_t* p, I a) { _mm512_storeu_si512(p, a); }
+    static void keep_lt(V x, I xi, V& best, I& bi) {
+        __mmask16 m = _mm512_cmp_ps_mask(x, best, _CMP_LT_OQ);
+        best = _mm512_mask_mov_ps(best, m, x);
+        bi = _mm512_mask_mov_epi32(bi, m, xi);
+    }
+    static void keep_gt(V x, I xi, V& best, I& bi) {
+        __mmask16 m = _mm512_cmp_ps_mask(x, best, _CMP_GT_OQ);
+        best = _mm512_mask_mov_ps(best, m, x);
+        bi = _mm512_mask_mov_epi32(bi, m, xi);
+    }
+};
+#endif
+
+// 编译期可用的最宽 ISA
+#if defined(REDUCE_HAS_AVX512)
+using BestOps = Avx512Ops;
+#elif defined(REDUCE_HAS_AVX2)
+using BestOps = Avx2Ops;
+#else
+using BestOps = ScalarOps;
+#endif
+
+// ============================================================================
+// Part 2: sum / dot 的精度模式
+// ============================================================================
+
+enum class SumMode {
+    Naive,      // fp32 累加，误差随 n 线性增长
+    Kahan,      // fp32 + 每个 lane 一个补偿项，误差与 n 无关，约 4 倍运算量
+    Pairwise,   // fp32 分块（kPairwiseBlock）朴素求和后两两合并，误差 O(log n)
+    Fp64        // 每个元素转为 fp64 再累加（点积的乘积在 fp64 中精确），适合长数组
+};
+
+inline const char* mode_name(SumMode mode) {
+    switch (mode) {
+    case SumMode::Naive: return "naive";
+    case SumMode::Kahan: return "kahan";
+    case SumMode::Pairwise: return "pairwise";
+    case SumMode::Fp64: return "fp64";
+    }
+    return "?";
+}
+
+inline constexpr size_t kMaxAccumulators = 8;
+inline constexpr size_t kPairwiseBlock = 4096;
+
+namespace detail {
+
+// 把 K 个累加器树形合并到 acc[0]
+template<typename T, size_t K, typename F>
+inline void merge_tree(T (&acc)[K], F op) {
+    for (size_t s = 1; s < K; s *= 2) {
+        for (size_t k = 0; k + s < K; k += 2 * s) {
+            acc[k] = op(acc[k], acc[k + s]);
+        }
+    }
+}
+
+// Dot 为 false 时 b 不被访问（可以为 nullptr）
+template<typename Ops, size_t K, bool Dot>
+inline float naive(const float* a, const float* b, size_t n) {
+    using V = typename Ops::V;
+    constexpr size_t W = Ops::W;
+
+    V acc[K];
+    for (size_t k = 0; k < K; ++k) acc[k] = Ops::zero();
+
+    auto step = [&](V& s, size_t i) {
+        if constexpr (Dot) s = Ops::fmadd(Ops::load(a + i), Ops::load(b + i), s);
+        else s = Ops::add(s, Ops::load(a + i));
+    };
+
+    // 循环边界取整到步长的倍数（而不是 i + step <= n），GCC 才能证明尾部循环不会回绕
+    // （否则 -Wall 会对标量尾部给出 -Waggressive-loop-optimizations 误报）
+    const size_t main_end = n - n % (K * W), vec_end = n - n % W;
+    size_t i = 0;
+    for (; i < main_end; i += K * W) {
+        for (size_t k = 0; k < K; ++k) step(acc[k], i + k * W);
+    }
+    for (; i < vec_end; i += W) step(acc[0], i);
+
+    merge_tree(acc, [](V x, V y) { return Ops::add(x, y); });
+    float total = Ops::hsum(acc[0]);
+    for (; i < n; ++i) total += Dot ? a[i] * b[i] : a[i];
+    return total;
+}
+
+// 每个 lane 独立做 Kahan 补偿：y = x - c; t = s + y; c = (t - s) - y; s = t
+// 点积用 fmsub 计算 a*b - c，乘积只舍入一次
+template<typename Ops, size_t K, bool Dot>
+inline double kahan(const float* a, const float* b, size_t n) {
+    using V = typename Ops::V;
+    constexpr size_t W = Ops::W;
+
+    V s[K], c[K];
+    for (size_t k = 0; k < K; ++k) s[k] = c[k] = Ops::zero();
+
+    auto step = [&](V& sum, V& comp, size_t i) {
+        V y;
+        if constexpr (Dot) y = Ops::fmsub(Ops::load(a + i), Ops::load(b + i), comp);
+        else y = Ops::sub(Ops::load(a + i), comp);
+        V t = Ops::add(sum, y);
+        comp = Ops::sub(Ops::sub(t, sum), y);
+        sum = t;
+    };
+
+    const size_t main_end = n - n % (K * W), vec_end = n - n % W;
+    size_t i = 0;
+    for (; i < main_end; i += K * W) {
+        for (size_t k = 0; k < K; ++k) step(s[k], c[k], i + k * W);
+    }
+    for (; i < vec_end; i += W) step(s[0], c[0], i);
+
+    // 各 lane 的 (s - c) 在 fp64 中合并；尾部元素少于 K * W 个，直接以 fp64 累加
+    double total = 0.0;
+    float sl[W], cl[W];
+    for (size_t k = 0; k < K; ++k) {
+        Ops::store(sl, s[k]);
+        Ops::store(cl, c[k]);
+        for (size_t l = 0; l < W; ++l) total += static_cast<double>(sl[l]) - cl[l];
+    }
+    for (; i < n; ++i) total += Dot ? static_cast<double>(a[i]) * b[i] : a[i];
+    return total;
+}
+
+template<typename Ops, size_t K, bool Dot>
+inline float pairwise(const float* a, const float* b, size_t n) {
+    if (n <= kPairwiseBlock) return naive<Ops, K, Dot>(a, b, n);
+    // 切分点取块大小的整数倍，保证每个叶子都是完整的向量循环
+    const size_t half = (n / 2 + kPairwiseBlock - 1) / kPairwiseBlock * kPairwiseBlock;
+    return pairwise<Ops, K, Dot>(a, b, half) + pairwise<Ops, K, Dot>(a + half, Dot ? b + half : nullptr, n - half);
+}
+
+template<typename Ops, size_t K, bool Dot>
+inline double fp64(const float* a, const float* b, size_t n) {
+    using V = typename Ops::V;
+    using D = typename Ops::D;
+    constexpr size_t W = Ops::W, DW = Ops::DW;
+
+    D acc[K * DW];
+    for (size_t k = 0; k < K * DW; ++k) acc[k] = Ops::dzero();
+
+    auto step = [&](D* s, size_t i) {
+        V x = Ops::load(a + i);
+        if constexpr (Dot) {
+            V y = Ops::load(b + i);
+            s[0] = Ops::dfmadd(Ops::template widen<0>(x), Ops::template widen<0>(y), s[0]);
+            if constexpr (DW == 2) s[1] = Ops::dfmadd(Ops::template widen<1>(x), Ops::template widen<1>(y), s[1]);
+        } else {
+            s[0] = Ops::dadd(s[0], Ops::template widen<0>(x));
+            if constexpr (DW == 2) s[1] = Ops::dadd(s[1], Ops::template widen<1>(x));
+        }
+    };
+
+    const size_t main_end = n - n % (K * W), vec_end = n - n % W;
+    size_t i = 0;
+    for (; i < main_end; i += K * W) {
+        for (size_t k = 0; k < K; ++k) step(acc + k * DW, i + k * W);
+    }
+    for (; i < vec_end; i += W) step(acc, i);
+
+    merge_tree(acc, [](D x, D y) { return Ops::dadd(x, y); });
+    double total = Ops::dhsum(acc[0]);
+    for (; i < n; ++i) total += Dot ? static_cast<double>(a[i]) * b[i] : a[i];
+    return total;
+}
+
+template<typename Ops, size_t K, bool Dot>
+inline double sum_or_dot(const float* a, const float* b, size_t n, SumMode mode) {
+    static_assert(K >= 1 && K <= kMaxAccumulators, "1 to 8 accumulators");
+    switch (mode) {
+    case SumMode::Naive: return naive<Ops, K, Dot>(a, b, n);
+    case SumMode::Kahan: return kahan<Ops, K, Dot>(a, b, n);
+    case SumMode::Pairwise: return pairwise<Ops, K, Dot>(a, b, n);
+    case SumMode::Fp64: return fp64<Ops, K, Dot>(a, b, n);
+    }
+    return 0.0;
+}
+
+} // namespace detail
+
+// ============================================================================
+// Part 3: 公共接口
+// ============================================================================
+
+template<typename Ops = BestOps, size_t K = 4>
+inline double sum(const float* x, size_t n, SumMode mode = SumMode::Naive) {
+    return detail::sum_or_dot<Ops, K, false>(x, nullptr, n, mode);
+}
+
+template<typename Ops = BestOps, size_t K = 4>
+inline double dot(const float* a, const float* b, size_t n, SumMode mode = SumMode::Naive) {
+    return detail::sum_or_dot<Ops, K, true>(a, b, n, mode);
+}
+
+// 2-范数。fp32 模式下 |x| > 1.8e19 的平方会上溢；Fp64 模式对任意有限 fp32 输入都不会
+template<typename Ops = BestOps, size_t K = 4>
+inline double norm(const float* x, size_t n, SumMode mode = SumMode::Naive) {
+    return std::sqrt(detail::sum_or_dot<Ops, K, true>(x, x, n, mode));
+}
+
+// min / max：NaN 被忽略；n == 0 时返回 +inf / -inf
+template<typename Ops = BestOps, size_t K = 4, bool Max = false>
+inline float extreme(const float* x, size_t n) {
+    using V = typename Ops::V;
+    constexpr size_t W = Ops::W;
+    constexpr float init = Max ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+    auto pick = [](V v, V acc) { return Max ? Ops::max(v, acc) : Ops::min(v, acc); };
+
+    V acc[K];
+    for (size_t k = 0; k < K; ++k) acc[k] = Ops::set1(init);
+
+    const size_t main_end = n - n % (K * W), vec_end = n - n % W;
+    size_t i = 0;
+    for (; i < main_end; i += K * W) {
+        for (size_t k = 0; k < K; ++k) acc[k] = pick(Ops::load(x + i + k * W), acc[k]);
+    }
+    for (; i < vec_end; i += W) acc[0] = pick(Ops::load(x + i), acc[0]);
+
+    detail::merge_tree(acc, pick);
+    float best = Max ? Ops::hmax(acc[0]) : Ops::hmin(acc[0]);
+    for (; i < n; ++i) best = Max ? (x[i] > best ? x[i] : best) : (x[i] < best ? x[i] : best);
+    return best;
+}
+
+template<typename Ops = BestOps, size_t K = 4>
+inline float min(const float* x, size_t n) { return extreme<Ops, K, false>(x, n); }
+
+template<typename Ops = BestOps, size_t K = 4>
+inline float max(const float* x, size_t n) { return extreme<Ops, K, true>(x, n); }
+
+// argmin / argmax：返回第一个最小（大）值的下标，与 std::min_element / max_element 一致
+// 每个 lane 记录自己见过的最优值及其 32 位下标；超过 2^30 个元素时分段处理
+template<typename Ops = BestOps, size_t K = 4, bool Max = false>
+inline size_t arg_extreme(const float* x, size_t n) {
+    using V = typename Ops::V;
+    using I = typename Ops::I;
+    constexpr size_t W = Ops::W;
+    constexpr size_t kChunk = size_t{ 1 } << 30;
+    constexpr float init = Max ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+
+    if (n == 0) throw std::invalid_argument("arg_extreme: empty input");
+
+    float best_val = x[0];
+    size_t best_idx = 0;
+    auto better = [](float v, float b) { return Max ? v > b : v < b; };
+
+    for (size_t base = 0; base < n; base += kChunk) {
+        const float* p = x + base;
+        const size_t len = std::min(kChunk, n - base);
+
+        V best[K];
+        I bidx[K], cur[K];
+        for (size_t k = 0; k < K; ++k) {
+            best[k] = Ops::set1(init);
+            bidx[k] = Ops::set1_i(-1);
+            cur[k] = Ops::add_i(Ops::iota(), static_cast<int32_t>(k * W));
+        }
+
+        const size_t main_end = len - len % (K * W);
+        size_t i = 0;
+        for (; i < main_end; i += K * W) {
+            for (size_t k = 0; k < K; ++k) {
+                if constexpr (Max) Ops::keep_gt(Ops::load(p + i + k * W), cur[k], best[k], bidx[k]);
+                else Ops::keep_lt(Ops::load(p + i + k * W), cur[k], best[k], bidx[k]);
+                cur[k] = Ops::add_i(cur[k], static_cast<int32_t>(K * W));
+            }
+        }
+
+        // lane 之间：值更优者胜，值相等时下标小者胜
+        float vals[W];
+        int32_t idxs[W];
+        for (size_t k = 0; k < K; ++k) {
+            Ops::store(vals, best[k]);
+            Ops::store_i(idxs, bidx[k]);
+            for (size_t l = 0; l < W; ++l) {
+                if (idxs[l] < 0) continue;
+                const size_t g = base + static_cast<size_t>(idxs[l]);
+                if (better(vals[l], best_val) || (vals[l] == best_val && g < best_idx)) {
+                    best_val = vals[l];
+                    best_idx = g;
+                }
+            }
+        }
+        for (; i < len; ++i) {
+            if (better(p[i], best_val)) {
+                best_val = p[i];
+                best_idx = base + i;
+            }
+        }
+    }
+    return best_idx;
+}
+
+template<typename Ops = BestOps, size_t K = 4>
+inline size_t argmin(const float* x, size_t n) { return arg_extreme<Ops, K, false>(x, n); }
+
+template<typename Ops = BestOps, size_t K = 4>
+inline size_t argmax(const float* x, size_t n) { return arg_extreme<Ops, K, true>(x, n); }
+
+// 均值与样本方差（除以 n - 1）：两遍算法，全部在 fp64 中累加
+// 第二遍累加 (x - mean)^2，避免单遍公式 E[x^2] - E[x]^2 在均值远大于标准差时的灾难性抵消
+struct MeanVariance {
+    double mean;
+    double variance;
+};
+
+template<typename Ops = BestOps, size_t K = 4>
+inline MeanVariance mean_variance(const float* x, size_t n) {
+    using D = typename Ops::D;
+    constexpr size_t W = Ops::W, DW = Ops::DW;
+
+    if (n == 0) throw std::invalid_argument("mean_variance: empty input");
+
+    const double mean = detail::fp64<Ops, K, false>(x, nullptr, n) / static_cast<double>(n);
+    if (n == 1) return { mean, 0.0 };
+
+    const D m = Ops::dset1(mean);
+    D acc[K * DW];
+    for (size_t k = 0; k < K * DW; ++k) acc[k] = Ops::dzero();
+
+    auto step = [&](D* s, size_t i) {
+        auto v = Ops::load(x + i);
+        D d0 = Ops::dsub(Ops::template widen<0>(v), m);
+        s[0] = Ops::dfmadd(d0, d0, s[0]);
+        if constexpr (DW == 2) {
+            D d1 = Ops::dsub(Ops::template widen<1>(v), m);
+            s[1] = Ops::dfmadd(d1, d1, s[1]);
+        }
+    };
+
+    const size_t main_end = n - n % (K * W), vec_end = n - n % W;
+    size_t i = 0;
+    for (; i < main_end; i += K * W) {
+        for (size_t k = 0; k < K; ++k) step(acc + k * DW, i + k * W);
+    }
+    for (; i < vec_end; i += W) step(acc, i);
+
+    detail::merge_tree(acc, [](D a, D b) { return Ops::dadd(a, b); });
+    double ss = Ops::dhsum(acc[0]);
+    for (; i < n; ++i) ss += (x[i] - mean) * (x[i] - mean);
+    return { mean, ss / static_cast<double>(n - 1) };
+}
+
+} // namespace simd_reduce
@@ -0,0 +1,294 @@
+// reductions_benchmark.cpp
+// reductions.hpp 的精度与速度测试：每一行同时给出耗时、带宽和相对误差
+// 1. sum / dot：ISA × 累加器个数 × 精度模式，缓存内（延迟受限）与 10M 元素（带宽受限）两种规模
+// 2. norm、min / max、argmin / argmax 与 std:: 算法对比
+// 3. mean / variance：两遍 fp64 与单遍 fp32 公式在大均值数据上的精度
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <string>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+
+#include "reductions.hpp"
+
+namespace sr = simd_reduce;
+
+// ============================================================================
+// Part 1: 参考值
+// ============================================================================
+
+// long double（x87 80 位）Neumaier 求和：对 10M 个 fp32 元素可视为精确
+long double reference_dot(const float* a, const float* b, size_t n) {
+    long double s = 0.0L, c = 0.0L;
+    for (size_t i = 0; i < n; ++i) {
+        const long double x = b ? static_cast<long double>(a[i]) * b[i] : a[i];
+        const long double t = s + x;
+        c += std::fabs(s) >= std::fabs(x) ? (s - t) + x : (x - t) + s;
+        s = t;
+    }
+    return s + c;
+}
+
+double rel_error(double value, long double ref) {
+    return static_cast<double>(std::fabs((value - ref) / ref));
+}
+
+// ============================================================================
+// 性能测试框架
+// ============================================================================
+
+// 每次调用处理 bytes 字节；小数组时重复 reps 次以获得可测量的耗时
+template<typename Func>
+double benchmark(const std::string& name, double bytes, double error, Func func, int iterations, int reps = 1) {
+    // 预热
+    func();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (int r = 0; r < reps; ++r) {
+            func();
+            asm volatile("" : : : "memory");
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / (iterations * reps);
+    std::cout << std::left << std::setw(35) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(4) << ms << " ms"
+              << std::setw(9) << std::setprecision(2) << bytes / (ms * 1e6) << " GB/s";
+    if (error >= 0.0) std::cout << std::setw(12) << std::scientific << std::setprecision(2) << error << std::fixed;
+    std::cout << std::endl;
+    return ms;
+}
+
+// ============================================================================
+// Part 2: sum / dot 扫描
+// ============================================================================
+
+struct Config {
+    const char* label;
+    double (*sum)(const float*, size_t, sr::SumMode);
+    double (*dot)(const float*, const float*, size_t, sr::SumMode);
+    sr::SumMode mode;
+};
+
+template<typename Ops, size_t K>
+Config config(const char* label, sr::SumMode mode) {
+    return { label, sr::sum<Ops, K>, sr::dot<Ops, K>, mode };
+}
+
+std::vector<Config> configs() {
+    using sr::SumMode;
+    std::vector<Config> c = {
+        config<sr::ScalarOps, 1>("scalar K=1 naive", SumMode::Naive),
+        config<sr::ScalarOps, 4>("scalar K=4 naive", SumMode::Naive),
+        config<sr::ScalarOps, 4>("scalar K=4 fp64", SumMode::Fp64),
+    };
+#ifdef REDUCE_HAS_AVX2
+    c.push_back(config<sr::Avx2Ops, 1>("AVX2 K=1 naive", SumMode::Naive));
+    c.push_back(config<sr::Avx2Ops, 4>("AVX2 K=4 naive", SumMode::Naive));
+    c.push_back(config<sr::Avx2Ops, 8>("AVX2 K=8 naive", SumMode::Naive));
+    c.push_back(config<sr::Avx2Ops, 4>("AVX2 K=4 kahan", SumMode::Kahan));
+    c.push_back(config<sr::Avx2Ops, 4>("AVX2 K=4 pairwise", SumMode::Pairwise));
+    c.push_back(config<sr::Avx2Ops, 4>("AVX2 K=4 fp64", SumMode::Fp64));
+#endif
+#ifdef REDUCE_HAS_AVX512
+    c.push_back(config<sr::Avx512Ops, 1>("AVX-512 K=1 naive", SumMode::Naive));
+    c.push_back(config<sr::Avx512Ops, 4>("AVX-512 K=4 naive", SumMode::Naive));
+    c.push_back(config<sr::Avx512Ops, 8>("AVX-512 K=8 naive", SumMode::Naive));
+    c.push_back(config<sr::Avx512Ops, 4>("AVX-512 K=4 kahan", SumMode::Kahan));
+    c.push_back(config<sr::Avx512Ops, 4>("AVX-512 K=4 pairwise", SumMode::Pairwise));
+    c.push_back(config<sr::Avx512Ops, 4>("AVX-512 K=4 fp64", SumMode::Fp64));
+#endif
+    return c;
+}
+
+void print_header() {
+    std::cout << std::left << std::setw(35) << "" << std::right << std::setw(15) << "time"
+              << std::setw(14) << "bandwidth" << std::setw(12) << "rel error" << "\n";
+}
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+int main() {
+    constexpr size_t N = 10'000'000;
+    constexpr size_t SMALL = 4096;      // 16 KB，L1 内，受延迟而非带宽限制
+    constexpr int ITERS = 20;
+
+    std::cout << "================================================\n";
+    std::cout << "  SIMD Reductions: Accumulators and Accuracy\n";
+    std::cout << "================================================\n";
+    std::cout << "Widest ISA: " << sr::BestOps::name << ", N = " << N << "\n";
+    std::cout << "Errors are relative to an 80-bit compensated reference\n\n";
+
+    // uniform [0, 1)：全部为正，fp32 朴素累加的和增大后每次加法都丢失低位
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::vector<float> a(N), b(N);
+    for (size_t i = 0; i < N; ++i) {
+        a[i] = uni(rng);
+        b[i] = gauss(rng);
+    }
+
+    const long double ref_sum = reference_dot(a.data(), nullptr, N);
+    const long double ref_dot = reference_dot(a.data(), b.data(), N);
+    const long double ref_small = reference_dot(a.data(), nullptr, SMALL);
+
+    volatile double sink = 0.0;
+    const std::vector<Config> cfgs = configs();
+
+    // ========================================
+    // 测试 1: sum
+    // ========================================
+    std::cout << "Test 1: Sum, " << SMALL << " floats (in L1, latency-bound)\n";
+    std::cout << "------------------------------------------------\n";
+    print_header();
+    for (const Config& c : cfgs) {
+        double err = rel_error(c.sum(a.data(), SMALL, c.mode), ref_small);
+        benchmark(c.label, SMALL * 4.0, err, [&]() { sink = c.sum(a.data(), SMALL, c.mode); }, ITERS, 2000);
+    }
+    std::cout << "\n";
+
+    std::cout << "Test 1b: Sum, " << N << " floats (memory-bound)\n";
+    std::cout << "------------------------------------------------\n";
+    print_header();
+    double worst_err = 0.0, best_err = 1.0;
+    for (const Config& c : cfgs) {
+        double err = rel_error(c.sum(a.data(), N, c.mode), ref_sum);
+        worst_err = std::max(worst_err, err);
+        best_err = std::min(best_err, err);
+        benchmark(c.label, N * 4.0, err, [&]() { sink = c.sum(a.data(), N, c.mode); }, ITERS);
+    }
+    benchmark("std::accumulate (float)", N * 4.0,
+              rel_error(std::accumulate(a.begin(), a.end(), 0.0f), ref_sum),
+              [&]() { sink = std::accumulate(a.begin(), a.end(), 0.0f); }, ITERS);
+    std::cout << "\n";
+
+    // ========================================
+    // 测试 2: dot
+    // ========================================
+    std::cout << "Test 2: Dot product, " << SMALL << " floats (in L1)\n";
+    std::cout << "------------------------------------------------\n";
+    print_header();
+    const long double ref_dot_small = reference_dot(a.data(), b.data(), SMALL);
+    for (const Config& c : cfgs) {
+        double err = rel_error(c.dot(a.data(), b.data(), SMALL, c.mode), ref_dot_small);
+        benchmark(c.label, SMALL * 8.0, err, [&]() { sink = c.dot(a.data(), b.data(), SMALL, c.mode); }, ITERS, 2000);
+    }
+    std::cout << "\n";
+
+    std::cout << "Test 2b: Dot product, " << N << " floats\n";
+    std::cout << "------------------------------------------------\n";
+    print_header();
+    for (const Config& c : cfgs) {
+        double err = rel_error(c.dot(a.data(), b.data(), N, c.mode), ref_dot);
+        benchmark(c.label, N * 8.0, err, [&]() { sink = c.dot(a.data(), b.data(), N, c.mode); }, ITERS);
+    }
+    std::cout << "\n";
+
+    // ========================================
+    // 测试 3: norm / min / max / argmin / argmax
+    // ========================================
+    std::cout << "Test 3: Norm and extrema, " << N << " floats\n";
+    std::cout << "------------------------------------------------\n";
+    print_header();
+    const long double ref_norm = std::sqrt(reference_dot(b.data(), b.data(), N));
+    benchmark("norm (fp32 K=4)", N * 4.0, rel_error(sr::norm(b.data(), N), ref_norm),
+              [&]() { sink = sr::norm(b.data(), N); }, ITERS);
+    benchmark("norm (fp64 K=4)", N * 4.0, rel_error(sr::norm(b.data(), N, sr::SumMode::Fp64), ref_norm),
+              [&]() { sink = sr::norm(b.data(), N, sr::SumMode::Fp64); }, ITERS);
+
+    bool ok = true;
+    const size_t std_min = std::min_element(b.begin(), b.end()) - b.begin();
+    const size_t std_max = std::max_element(b.begin(), b.end()) - b.begin();
+    ok = ok && sr::min(b.data(), N) == b[std_min] && sr::max(b.data(), N) == b[std_max];
+    ok = ok && sr::argmin(b.data(), N) == std_min && sr::argmax(b.data(), N) == std_max;
+    ok = ok && sr::argmin<sr::ScalarOps>(b.data(), N) == std_min;
+
+    double t_std_min = benchmark("std::min_element", N * 4.0, -1.0, [&]() {
+        sink = static_cast<double>(std::min_element(b.begin(), b.end()) - b.begin());
+    }, ITERS);
+    benchmark("min (K=4)", N * 4.0, -1.0, [&]() { sink = sr::min(b.data(), N); }, ITERS);
+    benchmark("max (K=4)", N * 4.0, -1.0, [&]() { sink = sr::max(b.data(), N); }, ITERS);
+    double t_argmin = benchmark("argmin (K=4)", N * 4.0, -1.0, [&]() {
+        sink = static_cast<double>(sr::argmin(b.data(), N));
+    }, ITERS);
+    benchmark("argmax (K=4)", N * 4.0, -1.0, [&]() { sink = static_cast<double>(sr::argmax(b.data(), N)); }, ITERS);
+    std::cout << "argmin speedup vs std::min_element: " << std::setprecision(2) << t_std_min / t_argmin << "x, "
+              << "indices " << (ok ? "match std::" : "MISMATCH!") << "\n\n";
+
+    // 重复值与首个出现位置：argmin 必须与 std::min_element 一样返回第一个
+    {
+        std::vector<float> ties(1000, 5.0f);
+        ties[123] = ties[700] = ties[999] = 1.0f;
+        ok = ok && sr::argmin(ties.data(), ties.size()) == 123;
+        ok = ok && sr::argmax<sr::BestOps, 8>(ties.data(), ties.size()) == 0;
+    }
+
+    // ========================================
+    // 测试 4: mean / variance
+    // ========================================
+    // 均值 1e4、标准差 1：x^2 约 1e8，fp32 只有 24 位尾数，E[x^2] - E[x]^2 几乎全是舍入误差
+    std::cout << "Test 4: Mean / variance, " << N << " floats, mean 1e4, stddev 1\n";
+    std::cout << "------------------------------------------------\n";
+    std::vector<float> m(N);
+    for (auto& x : m) x = 10000.0f + gauss(rng);
+    long double ref_mean = reference_dot(m.data(), nullptr, N) / N, ref_ss = 0.0L;
+    for (float x : m) ref_ss += (x - ref_mean) * (x - ref_mean);
+    const long double ref_var = ref_ss / (N - 1);
+
+    auto one_pass_fp32 = [&]() {
+        float s = 0.0f, s2 = 0.0f;
+        for (float x : m) {
+            s += x;
+            s2 += x * x;
+        }
+        float mean = s / N;
+        return static_cast<double>((s2 / N - mean * mean) * N / (N - 1));
+    };
+    benchmark("one-pass fp32 E[x^2]-E[x]^2", N * 4.0, rel_error(one_pass_fp32(), ref_var),
+              [&]() { sink = one_pass_fp32(); }, 5);
+    sr::MeanVariance mv = sr::mean_variance(m.data(), N);
+    benchmark("two-pass fp64 (K=4)", N * 8.0, rel_error(mv.variance, ref_var),
+              [&]() { sink = sr::mean_variance(m.data(), N).variance; }, ITERS);
+    std::cout << "mean rel error: " << std::scientific << rel_error(mv.mean, ref_mean) << std::fixed << "\n\n";
+    (void)sink;
+
+    std::cout << "================================================\n";
+    std::cout << "Summary\n";
+    std::cout << "================================================\n";
+    std::cout << "✓ K=4..8 accumulators hide the 4-cycle add/FMA latency (in-cache sums)\n";
+    std::cout << "✓ Out of cache every variant is bandwidth-bound: pick the accurate one\n";
+    std::cout << "✓ Sum of " << N << " floats: rel error from " << std::scientific << std::setprecision(1)
+              << worst_err << " (scalar fp32) down to " << best_err << " (kahan / fp64)" << std::fixed << "\n";
+    std::cout << "✓ Variance: two-pass fp64 vs one-pass fp32 cancellation\n";
+    std::cout << "✓ Results: " << (ok ? "extrema and indices match std::" : "MISMATCH!") << "\n";
+    std::cout << "================================================\n";
+
+    return ok ? 0 : 1;
+}
+
+/* 编译与运行:
+
+  g++ -std=c++20 -O3 -march=native reductions_benchmark.cpp -o reductions
+  ./reductions
+
+  g++ -std=c++20 -O3 -mavx2 -mfma reductions_benchmark.cpp -o reductions_avx2    # 只有 AVX2
+  # 不要加 -ffast-math：它允许重结合，Kahan 的补偿项会被优化掉
+
+预期结果:
+  - 缓存内求和：K=1 受 4 周期加法延迟限制，K=4 快约 2x（两个加法端口 + 加载端口成为瓶颈）
+  - 10M 元素：SIMD 变体都受内存带宽限制，耗时相近；Kahan / fp64 只慢 10-30%
+  - 10M 个 [0, 1) 求和：标量 fp32 相对误差约 5e-5，SIMD K=4 约 1e-7 - 1e-6（lane 越多，
+    每条链越短），pairwise 约 2e-8，Kahan 约 1e-11，fp64 与参考值一致
+  - 点积的 Kahan 只补偿加法误差，乘积的舍入仍在（约 1e-7）；fp64 中乘积是精确的
+  - 单遍 fp32 方差的相对误差可达 1e6 量级（结果毫无意义），两遍 fp64 约 1e-14
+*/
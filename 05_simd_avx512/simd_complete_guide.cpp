@@ -3,10 +3,13 @@
 
 #include <iostream>
 #include <vector>
+#include <string>
+#include <algorithm>
 #include <chrono>
 #include <random>
 #include <cmath>
-#include <immintrin.h>  // Intel intrinsics
+#include <cstdint>
+#include "simd_intrin.hpp"  // Intel intrinsics
 #include <iomanip>
 
 // 检测 CPU 特性
@@ -42,11 +45,34 @@ void vector_add_auto(const float* __restrict__ a,
     }
 }
 
+// ============================================================================
+// 尾部处理：标量循环 vs 掩码加载 / 存储
+// ============================================================================
+
+// 每个内核的主循环之后都剩下 n % W 个元素（W = 8 / 16）：
+//   Scalar: 逐元素循环，最多 W-1 次迭代，次数随 n 变化，循环出口分支难以预测
+//   Masked: 一次掩码加载 + 一次掩码存储，被屏蔽的 lane 不访问内存（越过页边界也不会缺页）
+// n < 64 时尾部占了大部分耗时，见测试 5
+enum class Tail { Scalar, Masked };
+
 // ============================================================================
 // 第二部分：手动 AVX2 优化（256-bit，8 个 float）
 // ============================================================================
 
 #ifdef HAS_AVX2
+// 前 rem 个 lane 为 -1 的 maskload / maskstore 掩码（0 < rem < 8）
+// 从 kAvx2TailMask + 8 - rem 处取 8 个 int32：一次非对齐加载，没有分支
+alignas(64) inline constexpr int32_t kAvx2TailMask[16] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+inline __m256i avx2_tail_mask(size_t rem) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kAvx2TailMask + 8 - rem));
+}
+
+// 注意：vmaskmovps 的存储形式在 Intel 上与普通存储相当，在 AMD Zen 上是微码实现（约 10+ 周期），
+// 那里只在尾部使用它，主循环保持普通 loadu / storeu
+template<Tail T = Tail::Masked>
 void vector_add_avx2(const float* a, const float* b, float* c, size_t n) {
     size_t i = 0;
     
@@ -59,12 +85,22 @@ void vector_add_avx2(const float* a, const float* b, float* c, size_t n) {
     }
     
     // 处理剩余元素
-    for (; i < n; ++i) {
-        c[i] = a[i] + b[i];
+    if constexpr (T == Tail::Masked) {
+        if (i < n) {
+            __m256i m = avx2_tail_mask(n - i);
+            __m256 va = _mm256_maskload_ps(&a[i], m);
+            __m256 vb = _mm256_maskload_ps(&b[i], m);
+            _mm256_maskstore_ps(&c[i], m, _mm256_add_ps(va, vb));
+        }
+    } else {
+        for (; i < n; ++i) {
+            c[i] = a[i] + b[i];
+        }
     }
 }
 
 // 复杂运算：FMA (Fused Multiply-Add)
+template<Tail T = Tail::Masked>
 void fma_avx2(const float* a, const float* b, const float* c, float* result, size_t n) {
     size_t i = 0;
     
@@ -77,12 +113,23 @@ void fma_avx2(const float* a, const float* b, const float* c, float* result, siz
         _mm256_storeu_ps(&result[i], vr);
     }
     
-    for (; i < n; ++i) {
-        result[i] = a[i] * b[i] + c[i];
+    if constexpr (T == Tail::Masked) {
+        if (i < n) {
+            __m256i m = avx2_tail_mask(n - i);
+            __m256 vr = _mm256_fmadd_ps(_mm256_maskload_ps(&a[i], m), _mm256_maskload_ps(&b[i], m),
+                                        _mm256_maskload_ps(&c[i], m));
+            _mm256_maskstore_ps(&result[i], m, vr);
+        }
+    } else {
+        for (; i < n; ++i) {
+            result[i] = a[i] * b[i] + c[i];
+        }
     }
 }
 
 // 点积运算
+// 掩码尾部：被屏蔽的 lane 加载为 0，直接累加进 sum_vec，水平求和只做一次
+template<Tail T = Tail::Masked>
 float dot_product_avx2(const float* a, const float* b, size_t n) {
     __m256 sum_vec = _mm256_setzero_ps();
     size_t i = 0;
@@ -93,6 +140,14 @@ float dot_product_avx2(const float* a, const float* b, size_t n) {
         sum_vec = _mm256_fmadd_ps(va, vb, sum_vec);
     }
     
+    if constexpr (T == Tail::Masked) {
+        if (i < n) {
+            __m256i m = avx2_tail_mask(n - i);
+            sum_vec = _mm256_fmadd_ps(_mm256_maskload_ps(&a[i], m), _mm256_maskload_ps(&b[i], m), sum_vec);
+            i = n;
+        }
+    }
+    
     // 水平求和
     __m128 low = _mm256_castps256_ps128(sum_vec);
     __m128 high = _mm256_extractf128_ps(sum_vec, 1);
@@ -104,7 +159,7 @@ float dot_product_avx2(const float* a, const float* b, size_t n) {
     
     float sum = _mm_cvtss_f32(sum128);
     
-    // 处理剩余元素
+    // 处理剩余元素（Tail::Masked 时 i == n，循环不执行）
     for (; i < n; ++i) {
         sum += a[i] * b[i];
     }
@@ -118,6 +173,13 @@ float dot_product_avx2(const float* a, const float* b, size_t n) {
 // ============================================================================
 
 #ifdef HAS_AVX512
+// 前 rem 个 lane 置位的 __mmask16（0 < rem < 16），配合 maskz_loadu / mask_storeu 使用
+// AVX-512 的掩码访存是原生指令，Intel 与 AMD Zen 4 上都和普通访存一样快
+inline __mmask16 avx512_tail_mask(size_t rem) {
+    return static_cast<__mmask16>((1u << rem) - 1);
+}
+
+template<Tail T = Tail::Masked>
 void vector_add_avx512(const float* a, const float* b, float* c, size_t n) {
     size_t i = 0;
     
@@ -130,12 +192,23 @@ void vector_add_avx512(const float* a, const float* b, float* c, size_t n) {
     }
     
     // 处理剩余元素
-    for (; i < n; ++i) {
-        c[i] = a[i] + b[i];
+    if constexpr (T == Tail::Masked) {
+        if (i < n) {
+            __mmask16 m = avx512_tail_mask(n - i);
+            __m512 va = _mm512_maskz_loadu_ps(m, &a[i]);
+            __m512 vb = _mm512_maskz_loadu_ps(m, &b[i]);
+            _mm512_mask_storeu_ps(&c[i], m, _mm512_add_ps(va, vb));
+        }
+    } else {
+        for (; i < n; ++i) {
+            c[i] = a[i] + b[i];
+        }
     }
 }
 
 // AVX-512 的掩码运算（条件执行）
+// 尾部的条件掩码与范围掩码相与：_mm512_mask_cmp_ps_mask 只比较前 rem 个 lane
+template<Tail T = Tail::Masked>
 void conditional_add_avx512(const float* a, const float* b, float* c, 
                            const float threshold, size_t n) {
     size_t i = 0;
@@ -153,8 +226,18 @@ void conditional_add_avx512(const float* a, const float* b, float* c,
         _mm512_storeu_ps(&c[i], result);
     }
     
-    for (; i < n; ++i) {
-        c[i] = a[i] > threshold ? a[i] + b[i] : a[i];
+    if constexpr (T == Tail::Masked) {
+        if (i < n) {
+            __mmask16 tail = avx512_tail_mask(n - i);
+            __m512 va = _mm512_maskz_loadu_ps(tail, &a[i]);
+            __m512 vb = _mm512_maskz_loadu_ps(tail, &b[i]);
+            __mmask16 mask = _mm512_mask_cmp_ps_mask(tail, va, vthreshold, _CMP_GT_OQ);
+            _mm512_mask_storeu_ps(&c[i], tail, _mm512_mask_add_ps(va, mask, va, vb));
+        }
+    } else {
+        for (; i < n; ++i) {
+            c[i] = a[i] > threshold ? a[i] + b[i] : a[i];
+        }
     }
 }
 #endif
@@ -166,7 +249,12 @@ void conditional_add_avx512(const float* a, const float* b, float* c,
 #include <experimental/simd>
 namespace stdx = std::experimental;
 
-template<typename T>
+// 完整的可移植内核集（add / fma / dot / conditional_add / 灰度）在 portable_simd.hpp，
+// 与 intrinsics 版本的逐位对照与性能比较见 portable_simd_benchmark.cpp
+//
+// 掩码尾部用 where(mask, v).copy_from / copy_to 表达，
+// libstdc++ 在 AVX2 / AVX-512 上把它们编译成 vmaskmov / 带 {k} 掩码的访存
+template<typename T, Tail TailMode = Tail::Masked>
 void vector_add_stdsimd(const T* a, const T* b, T* c, size_t n) {
     using simd_t = stdx::native_simd<T>;
     constexpr size_t lanes = simd_t::size();
@@ -179,8 +267,19 @@ void vector_add_stdsimd(const T* a, const T* b, T* c, size_t n) {
         vc.copy_to(&c[i], stdx::element_aligned);
     }
     
-    for (; i < n; ++i) {
-        c[i] = a[i] + b[i];
+    if constexpr (TailMode == Tail::Masked) {
+        if (i < n) {
+            const simd_t lane([](auto k) { return T(k); });
+            const auto m = lane < simd_t(T(n - i));
+            simd_t va = 0, vb = 0;
+            stdx::where(m, va).copy_from(&a[i], stdx::element_aligned);
+            stdx::where(m, vb).copy_from(&b[i], stdx::element_aligned);
+            stdx::where(m, va + vb).copy_to(&c[i], stdx::element_aligned);
+        }
+    } else {
+        for (; i < n; ++i) {
+            c[i] = a[i] + b[i];
+        }
     }
 }
 
@@ -188,40 +287,15 @@ void vector_add_stdsimd(const T* a, const T* b, T* c, size_t n) {
 // 第五部分：实际应用 - 图像处理
 // ============================================================================
 
-#ifdef HAS_AVX2
-// RGB 转灰度（Y = 0.299*R + 0.587*G + 0.114*B）
-void rgb_to_gray_avx2(const uint8_t* rgb, uint8_t* gray, size_t pixel_count) {
-    const __m256 coeff_r = _mm256_set1_ps(0.299f);
-    const __m256 coeff_g = _mm256_set1_ps(0.587f);
-    const __m256 coeff_b = _mm256_set1_ps(0.114f);
-    
-    size_t i = 0;
-    for (; i + 8 <= pixel_count; i += 8) {
-        // 加载 8 个像素（24 字节）
-        __m256i pixels = _mm256_loadu_si256((__m256i*)&rgb[i * 3]);
-        
-        // 提取 RGB 通道（需要复杂的 shuffle 操作，简化示例）
-        // 实际实现会更复杂
-        
-        for (size_t j = 0; j < 8 && i + j < pixel_count; ++j) {
-            gray[i + j] = static_cast<uint8_t>(
-                0.299f * rgb[(i + j) * 3 + 0] +
-                0.587f * rgb[(i + j) * 3 + 1] +
-                0.114f * rgb[(i + j) * 3 + 2]
-            );
-        }
-    }
-    
-    // 处理剩余像素
-    for (; i < pixel_count; ++i) {
-        gray[i] = static_cast<uint8_t>(
-            0.299f * rgb[i * 3 + 0] +
-            0.587f * rgb[i * 3 + 1] +
-            0.114f * rgb[i * 3 + 2]
-        );
-    }
-}
-#endif
+// RGB 转灰度（Y = 0.299*R + 0.587*G + 0.114*B）的完整实现在 pixel_convert.hpp：
+//   1. pshufb 把每个 lane 的 4 个像素解交错为 16 位 (R, G) 与 (B, 1)
+//   2. madd_epi16 用 Q14 定点权重一步完成乘加，bias 项完成舍入
+//   3. packus 收窄后 permutevar8x32 恢复像素顺序
+// 同一文件还有 AVX-512BW 版本、BGR/RGBA 布局、通道重排、预乘 alpha 与 RGB ↔ YUV420
+#include "pixel_convert.hpp"
+
+// 大数组的非临时（streaming）存储与软件预取变体：streaming.hpp
+#include "streaming.hpp"
 
 // ============================================================================
 // 性能测试框架
@@ -246,6 +320,75 @@ double benchmark(const std::string& name, Func func, int iterations = 100) {
     return ms;
 }
 
+// 小数组一次调用只有几 ns：每轮重复 reps 次取平均，5 轮取最小值（排除被调度打断的轮次）
+template<typename Func>
+double ns_per_call(Func func, int reps) {
+    func();
+    double best = 1e300;
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            func();
+            asm volatile("" : : : "memory");
+        }
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / reps);
+    }
+    return best;
+}
+
+// 测试 5 的 n 区间：[1, 16) [16, 64) [64, 256]
+constexpr size_t kTailBands[4] = { 1, 16, 64, 257 };
+constexpr size_t kTailMaxN = 256;
+
+struct TailTiming {
+    double band[3];  // 各区间内逐个 n 计时的平均值（同一 n 连续调用，分支可预测）
+    double random;   // 每次调用换一个随机 n ∈ [1, 64]（分支预测失效时的真实情况）
+};
+
+template<typename Kernel>
+TailTiming time_tail(Kernel kernel, const std::vector<size_t>& random_n) {
+    TailTiming t{};
+    for (int b = 0; b < 3; ++b) {
+        double sum = 0.0;
+        for (size_t n = kTailBands[b]; n < kTailBands[b + 1]; ++n) {
+            sum += ns_per_call([&]() { kernel(n); }, 1000);
+        }
+        t.band[b] = sum / static_cast<double>(kTailBands[b + 1] - kTailBands[b]);
+    }
+    t.random = ns_per_call([&]() { for (size_t n : random_n) kernel(n); }, 10) / random_n.size();
+    return t;
+}
+
+// 先对 n = 1..256 逐个运行两种尾部并用 check(n) 核对结果（包括没有越界写），再分别计时
+// 返回 {结果一致, 随机 n 下的加速比}
+template<typename ScalarTail, typename MaskedTail, typename Check>
+std::pair<bool, double> compare_tails(const std::string& name, ScalarTail scalar_tail, MaskedTail masked_tail,
+                                      Check check, const std::vector<size_t>& random_n) {
+    bool ok = true;
+    for (size_t n = 1; n <= kTailMaxN; ++n) {
+        scalar_tail(n);
+        masked_tail(n);
+        ok = ok && check(n);
+    }
+
+    const TailTiming s = time_tail(scalar_tail, random_n);
+    const TailTiming m = time_tail(masked_tail, random_n);
+    auto row = [](const std::string& kernel, const char* tail, const double* v) {
+        std::cout << std::left << std::setw(22) << kernel << std::setw(13) << tail << std::right << std::fixed;
+        for (int k = 0; k < 4; ++k) std::cout << std::setw(10) << std::setprecision(2) << v[k];
+        std::cout << "\n";
+    };
+    const double sv[4] = { s.band[0], s.band[1], s.band[2], s.random };
+    const double mv[4] = { m.band[0], m.band[1], m.band[2], m.random };
+    row(name, "scalar tail", sv);
+    row("", "masked tail", mv);
+    std::cout << std::left << std::setw(22) << "" << std::setw(13) << (ok ? "speedup" : "MISMATCH!") << std::right;
+    for (int k = 0; k < 4; ++k) std::cout << std::setw(9) << std::setprecision(2) << sv[k] / mv[k] << "x";
+    std::cout << "\n";
+    return { ok, s.random / m.random };
+}
+
 // ============================================================================
 // 主程序
 // ============================================================================
@@ -311,6 +454,20 @@ int main() {
         [&]() { vector_add_avx512(a.data(), b.data(), c.data(), N); }, ITERS);
 #endif
 
+    // 三个 40 MB 数组：streaming 存储不做写目标的 RFO，也不把 a / b 挤出缓存
+    // 不同数组大小下的交叉点与预取距离：streaming_benchmark.cpp
+#ifdef STREAM_HAS_AVX2
+    double avx2_stream_time = benchmark("AVX2 (streaming stores)",
+        [&]() { simd_stream::add<simd_stream::Store::Stream, 0, simd_stream::Avx2Ops>(a.data(), b.data(), c.data(), N); },
+        ITERS);
+#endif
+
+#ifdef STREAM_HAS_AVX512
+    double avx512_stream_time = benchmark("AVX-512 (streaming stores)",
+        [&]() { simd_stream::add<simd_stream::Store::Stream, 0, simd_stream::Avx512Ops>(a.data(), b.data(), c.data(), N); },
+        ITERS);
+#endif
+
     std::cout << "\nSpeedup vs Scalar:\n";
     std::cout << "  Auto-vectorized: " << (scalar_time / auto_time) << "x\n";
 #ifdef HAS_AVX2
@@ -318,6 +475,12 @@ int main() {
 #endif
 #ifdef HAS_AVX512
     std::cout << "  AVX-512:         " << (scalar_time / avx512_time) << "x\n";
+#endif
+#ifdef STREAM_HAS_AVX2
+    std::cout << "  AVX2 streaming:  " << (scalar_time / avx2_stream_time) << "x\n";
+#endif
+#ifdef STREAM_HAS_AVX512
+    std::cout << "  AVX-512 stream:  " << (scalar_time / avx512_stream_time) << "x\n";
 #endif
     std::cout << "\n";
 
@@ -364,6 +527,126 @@ int main() {
     std::cout << "\nSpeedup: " << (dot_scalar_time / dot_avx2_time) << "x\n\n";
 #endif
 
+    // ========================================
+    // 测试 4: RGB 转灰度（1920x1080，定点 SIMD）
+    // ========================================
+#ifdef HAS_AVX2
+    std::cout << "Test 4: RGB to Gray (1920x1080)\n";
+    std::cout << "------------------------------------------------\n";
+
+    const size_t pixels = 1920 * 1080;
+    std::vector<uint8_t> rgb(pixels * 3), gray_ref(pixels), gray(pixels);
+    for (size_t i = 0; i < rgb.size(); ++i) {
+        rgb[i] = static_cast<uint8_t>(i * 2654435761u >> 24);
+    }
+
+    // 每次迭代的输出相同，阻止编译器把重复调用合并掉
+    double gray_scalar_time = benchmark("Scalar RGB->Gray",
+        [&]() {
+            to_gray_scalar<LayoutRGB>(rgb.data(), gray_ref.data(), pixels);
+            asm volatile("" : : : "memory");
+        }, ITERS);
+
+    double gray_avx2_time = benchmark("AVX2 RGB->Gray",
+        [&]() {
+            rgb_to_gray_avx2(rgb.data(), gray.data(), pixels);
+            asm volatile("" : : : "memory");
+        }, ITERS);
+    bool gray_ok = gray == gray_ref;
+
+#ifdef PIXEL_HAS_AVX512BW
+    double gray_avx512_time = benchmark("AVX-512BW RGB->Gray",
+        [&]() {
+            rgb_to_gray_avx512bw(rgb.data(), gray.data(), pixels);
+            asm volatile("" : : : "memory");
+        }, ITERS);
+    gray_ok = gray_ok && gray == gray_ref;
+#endif
+
+    std::cout << "\nSpeedup: AVX2 " << (gray_scalar_time / gray_avx2_time) << "x";
+#ifdef PIXEL_HAS_AVX512BW
+    std::cout << ", AVX-512BW " << (gray_scalar_time / gray_avx512_time) << "x";
+#endif
+    std::cout << " (" << (gray_ok ? "bit-exact" : "MISMATCH") << ")\n";
+    std::cout << "More conversions: pixel_convert_benchmark.cpp\n\n";
+#endif
+
+    // ========================================
+    // 测试 5: 小数组的尾部处理（n = 1..256）
+    // ========================================
+    std::cout << "Test 5: Small-n Tails, scalar loop vs masked load/store (ns per call)\n";
+    std::cout << "------------------------------------------------\n";
+
+    // 输入留出 64 个元素的余量；两份输出预先填同一个哨兵值，掩码存储越界写会被 memcmp 发现
+    const size_t tail_len = kTailMaxN + 64;
+    std::vector<float> ta(a.begin(), a.begin() + tail_len), tb(b.begin(), b.begin() + tail_len);
+    std::vector<float> tc(b.rbegin(), b.rbegin() + tail_len);
+    std::vector<float> out_ref(tail_len, -1.0f), out(tail_len, -1.0f);
+    auto same_output = [&](size_t) {
+        return std::equal(out_ref.begin(), out_ref.end(), out.begin());
+    };
+    float dot_ref = 0.0f, dot_masked = 0.0f;
+
+    std::vector<size_t> random_n(4096);
+    std::uniform_int_distribution<size_t> n_dist(1, 64);
+    for (auto& n : random_n) n = n_dist(rng);
+
+    std::cout << std::left << std::setw(35) << "" << std::right << std::setw(10) << "n=1-15"
+              << std::setw(10) << "n=16-63" << std::setw(10) << "n=64-256" << std::setw(10) << "rand 1-64" << "\n";
+
+    bool tails_ok = true;
+    double best_tail_speedup = 0.0;
+    std::string best_tail_kernel = "";
+    auto record = [&](const std::string& name, std::pair<bool, double> r) {
+        tails_ok = tails_ok && r.first;
+        if (r.second > best_tail_speedup) {
+            best_tail_speedup = r.second;
+            best_tail_kernel = name;
+        }
+    };
+
+#ifdef HAS_AVX2
+    record("AVX2 add", compare_tails("AVX2 add",
+        [&](size_t n) { vector_add_avx2<Tail::Scalar>(ta.data(), tb.data(), out_ref.data(), n); },
+        [&](size_t n) { vector_add_avx2<Tail::Masked>(ta.data(), tb.data(), out.data(), n); },
+        same_output, random_n));
+    record("AVX2 FMA", compare_tails("AVX2 FMA",
+        [&](size_t n) { fma_avx2<Tail::Scalar>(ta.data(), tb.data(), tc.data(), out_ref.data(), n); },
+        [&](size_t n) { fma_avx2<Tail::Masked>(ta.data(), tb.data(), tc.data(), out.data(), n); },
+        same_output, random_n));
+    // 点积的两种尾部求和顺序不同，误差按 sum |a_i * b_i| 的相对值比较
+    record("AVX2 dot", compare_tails("AVX2 dot",
+        [&](size_t n) { dot_ref = dot_product_avx2<Tail::Scalar>(ta.data(), tb.data(), n); },
+        [&](size_t n) { dot_masked = dot_product_avx2<Tail::Masked>(ta.data(), tb.data(), n); },
+        [&](size_t n) {
+            double mag = 0.0;
+            for (size_t i = 0; i < n; ++i) mag += std::fabs(double(ta[i]) * tb[i]);
+            return std::fabs(double(dot_ref) - dot_masked) <= 1e-6 * mag;
+        },
+        random_n));
+#endif
+
+#ifdef HAS_AVX512
+    record("AVX-512 add", compare_tails("AVX-512 add",
+        [&](size_t n) { vector_add_avx512<Tail::Scalar>(ta.data(), tb.data(), out_ref.data(), n); },
+        [&](size_t n) { vector_add_avx512<Tail::Masked>(ta.data(), tb.data(), out.data(), n); },
+        same_output, random_n));
+    record("AVX-512 cond add", compare_tails("AVX-512 cond add",
+        [&](size_t n) { conditional_add_avx512<Tail::Scalar>(ta.data(), tb.data(), out_ref.data(), 0.0f, n); },
+        [&](size_t n) { conditional_add_avx512<Tail::Masked>(ta.data(), tb.data(), out.data(), 0.0f, n); },
+        same_output, random_n));
+#endif
+
+    record("std::simd add", compare_tails("std::simd add",
+        [&](size_t n) { vector_add_stdsimd<float, Tail::Scalar>(ta.data(), tb.data(), out_ref.data(), n); },
+        [&](size_t n) { vector_add_stdsimd<float, Tail::Masked>(ta.data(), tb.data(), out.data(), n); },
+        same_output, random_n));
+
+    std::cout << "\n" << (tails_ok ? "✓" : "✗") << " Masked tails match the scalar tails for n = 1.."
+              << kTailMaxN << (tails_ok ? " (no out-of-bounds stores)" : " (MISMATCH!)") << "\n";
+    std::cout << "✓ Best speedup at random n <= 64: " << std::setprecision(1) << best_tail_speedup
+              << "x (" << best_tail_kernel << ")\n\n";
+
     // ========================================
     // 吞吐量分析
     // ========================================
@@ -407,7 +690,7 @@ int main() {
     std::cout << "  1. 数据对齐（16/32/64 字节）\n";
     std::cout << "  2. 避免分支（使用掩码）\n";
     std::cout << "  3. 循环展开\n";
-    std::cout << "  4. 处理边界情况\n\n";
+    std::cout << "  4. 处理边界情况（掩码加载 / 存储代替标量尾部循环）\n\n";
     
     std::cout << "✓ 编译器旗标:\n";
     std::cout << "  GCC/Clang: -mavx2 -mfma\n";
@@ -437,11 +720,55 @@ AVX-512 版本 (需要支持的 CPU):
   g++ -std=c++20 -O3 -march=native -mtune=native simd_complete_guide.cpp -o simd_opt
   ./simd_opt
 
+可移植发布版本（运行期按 CPUID 选择 scalar / AVX2 / AVX-512 内核，SIMD_ISA 可覆盖）:
+  ./build_dispatch.sh && ./build/dispatch_demo
+
+像素格式转换库（灰度 / 通道重排 / 预乘 / YUV420）的正确性与 GB/s 测试:
+  g++ -std=c++20 -O3 -march=native pixel_convert_benchmark.cpp -o pixel_convert
+  ./pixel_convert
+
+归约（多累加器、Kahan / pairwise / fp64 精度模式、argmin / argmax、方差）的精度与速度:
+  g++ -std=c++20 -O3 -march=native reductions_benchmark.cpp -o reductions
+  ./reductions
+
+超越函数（exp / log / sin / cos / tanh / sigmoid / erf，fast / accurate 两档）的吞吐与 ULP 误差:
+  g++ -std=c++20 -O3 -march=native -ffp-contract=off simd_math_benchmark.cpp -o simd_math_bench
+  g++ -std=c++20 -O3 -march=native -ffp-contract=off simd_math_ulp_check.cpp -o simd_math_ulp_check
+  ./simd_math_bench && ./simd_math_ulp_check --step 97
+
+流压缩（AVX-512 vcompress / AVX2 查表 left-pack，float / double / int32 / int64，选择率 1%-99%）:
+  g++ -std=c++20 -O3 -march=native compaction_benchmark.cpp -o compaction
+  ./compaction
+
+非临时存储 / 软件预取（普通存储 vs streaming 存储的交叉点，48 KB - 768 MB）:
+  g++ -std=c++20 -O3 -march=native streaming_benchmark.cpp -o streaming
+  ./streaming
+
+std::experimental::simd 可移植内核 vs intrinsics（逐位一致性 + 逐对计时）:
+  g++ -std=c++20 -O3 -march=native portable_simd_benchmark.cpp simd_dispatch.cpp \
+      simd_kernels_scalar.cpp simd_kernels_avx2.cpp simd_kernels_avx512.cpp -o portable_simd
+  ./portable_simd
+
+排序（双调排序网络 + 向量化分区快速排序，float / double / int32 / int64 / 键值对，1K - 100M）:
+  g++ -std=c++20 -O3 -march=native simd_sort_benchmark.cpp -o simd_sort
+  ./simd_sort --max 1000000
+
+字节流内核（字节直方图、Harley-Seal popcount、hex / base64 编解码，对比标量）:
+  g++ -std=c++20 -O3 -march=native byte_kernels_benchmark.cpp -o byte_kernels
+  ./byte_kernels
+
 预期结果 (Intel Core i7-12700, 32GB RAM):
   Scalar:          ~50 ms
   Auto-vectorized: ~15 ms (3.3x)
   AVX2:            ~8 ms  (6.2x)
   AVX-512:         ~5 ms  (10x)
+  streaming 存储:  比同 ISA 的普通存储再快 20-40%（3 个 40 MB 数组远超单核缓存，省掉写目标的 RFO）
+
+小数组尾部（测试 5，n = 1..256 逐个计时 + 随机 n ∈ [1, 64]）:
+  n < 16 时整个调用就是尾部：掩码版本约 2-4 ns / 调用且与 n 无关，标量尾部随 n % W 增长
+  随机 n 时标量尾部的循环出口分支预测失败，掩码版本快 2-4 倍；n 越大尾部占比越小，差距随之缩小
+  点积的尾部只是几次标量乘加，收益最小
+  AMD Zen 上 vmaskmovps 存储是微码实现，AVX2 的掩码尾部收益会小一些；AVX-512 掩码访存不受影响
 
 内存带宽:
   Scalar:          ~5 GB/s
@@ -0,0 +1,65 @@
+// simd_dispatch.cpp
+// CPUID 检测 + 环境变量覆盖，解析一次后缓存
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "simd_dispatch.h"
+
+// __builtin_cpu_supports 读取 libgcc / compiler-rt 在启动时缓存的 CPUID 结果，
+// 对 AVX / AVX-512 还检查了 XGETBV（操作系统是否保存 YMM/ZMM 状态）
+bool simd_isa_supported(SimdIsa isa) {
+    switch (isa) {
+    case SimdIsa::Scalar:
+        return true;
+    case SimdIsa::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case SimdIsa::AVX512:
+        return __builtin_cpu_supports("avx512f") && simd_isa_supported(SimdIsa::AVX2);
+    }
+    return false;
+}
+
+SimdIsa detect_simd_isa() {
+    if (simd_isa_supported(SimdIsa::AVX512)) return SimdIsa::AVX512;
+    if (simd_isa_supported(SimdIsa::AVX2)) return SimdIsa::AVX2;
+    return SimdIsa::Scalar;
+}
+
+const SimdKernels& kernels_for(SimdIsa isa) {
+    switch (isa) {
+    case SimdIsa::AVX512: return kAvx512Kernels;
+    case SimdIsa::AVX2: return kAvx2Kernels;
+    case SimdIsa::Scalar: break;
+    }
+    return kScalarKernels;
+}
+
+static const SimdKernels& resolve_kernels() {
+    SimdIsa isa = detect_simd_isa();
+
+    if (const char* env = std::getenv("SIMD_ISA")) {
+        SimdIsa requested;
+        if (std::strcmp(env, "scalar") == 0) requested = SimdIsa::Scalar;
+        else if (std::strcmp(env, "avx2") == 0) requested = SimdIsa::AVX2;
+        else if (std::strcmp(env, "avx512") == 0) requested = SimdIsa::AVX512;
+        else {
+            std::cerr << "SIMD_ISA=" << env << " not recognized (scalar|avx2|avx512), using "
+                      << kernels_for(isa).name << "\n";
+            return kernels_for(isa);
+        }
+        if (!simd_isa_supported(requested)) {
+            std::cerr << "SIMD_ISA=" << env << " not supported by this CPU, using "
+                      << kernels_for(isa).name << "\n";
+            return kernels_for(isa);
+        }
+        isa = requested;
+    }
+    return kernels_for(isa);
+}
+
+const SimdKernels& simd_kernels() {
+    static const SimdKernels& kernels = resolve_kernels();
+    return kernels;
+}
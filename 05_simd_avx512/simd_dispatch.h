@@ -0,0 +1,50 @@
+// simd_dispatch.h
+// 运行期 CPU 特性分派：一个二进制同时包含标量 / AVX2 / AVX-512 内核，
+// 启动后按 CPUID 选择一次，之后所有调用都走同一张函数指针表
+
+#pragma once
+
+#include <cstddef>
+
+enum class SimdIsa { Scalar, AVX2, AVX512 };
+
+// 一个 ISA 的全部内核。每张表定义在各自的翻译单元 simd_kernels_<isa>.cpp 中，
+// 那里的函数带 target 属性，因此整个程序不需要 -mavx2 / -mavx512f 编译旗标
+struct SimdKernels {
+    SimdIsa isa;
+    const char* name;
+    void (*vector_add)(const float* a, const float* b, float* c, size_t n);
+    void (*fma)(const float* a, const float* b, const float* c, float* result, size_t n);
+    float (*dot_product)(const float* a, const float* b, size_t n);
+    // c[i] = a[i] > threshold ? a[i] + b[i] : a[i]
+    void (*conditional_add)(const float* a, const float* b, float* c, float threshold, size_t n);
+};
+
+extern const SimdKernels kScalarKernels;
+extern const SimdKernels kAvx2Kernels;
+extern const SimdKernels kAvx512Kernels;
+
+// CPUID（含操作系统对 YMM/ZMM 状态的支持）检测到的最高可用 ISA
+SimdIsa detect_simd_isa();
+bool simd_isa_supported(SimdIsa isa);
+const SimdKernels& kernels_for(SimdIsa isa);
+
+// 首次调用时解析：默认取 detect_simd_isa()，环境变量 SIMD_ISA=scalar|avx2|avx512 可覆盖
+// （请求的 ISA 不受支持时回退到自动检测并打印警告）。之后返回同一张表
+const SimdKernels& simd_kernels();
+
+inline void vector_add(const float* a, const float* b, float* c, size_t n) {
+    simd_kernels().vector_add(a, b, c, n);
+}
+
+inline void fma(const float* a, const float* b, const float* c, float* result, size_t n) {
+    simd_kernels().fma(a, b, c, result, n);
+}
+
+inline float dot_product(const float* a, const float* b, size_t n) {
+    return simd_kernels().dot_product(a, b, n);
+}
+
+inline void conditional_add(const float* a, const float* b, float* c, float threshold, size_t n) {
+    simd_kernels().conditional_add(a, b, c, threshold, n);
+}
@@ -0,0 +1,17 @@
+// simd_intrin.hpp
+// 本目录所有 intrinsics 代码共用的 <immintrin.h> 入口
+//
+// GCC 12 的 _mm512_undefined_*() 用自初始化的 __Y 表示“任意值”，
+// 内联进 _mm512_srl_epi32、_mm512_permutexvar_epi32 等函数后，-Wall 下每个调用点
+// 都会报误报的 -Wuninitialized / -Wmaybe-uninitialized。pragma 只包住头文件本身，
+// 用户代码中的同类警告不受影响。
+// <immintrin.h> 有自己的 include guard：同一翻译单元中第一次包含它的位置决定
+// 是否带着这组 pragma，所以本目录的源文件都只通过这个头文件包含它
+
+#pragma once
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
@@ -0,0 +1,73 @@
+// simd_kernels_avx2.cpp
+// AVX2 + FMA 内核（Haswell 及以后、Zen 1 及以后）
+// 函数级 target 属性只对本文件中的内核启用 AVX2，头文件中的内联函数仍按基线编译，
+// 避免 ODR 合并时把 AVX2 版本的 std:: 函数带进基线代码路径
+
+#include "simd_intrin.hpp"
+
+#include "simd_dispatch.h"
+
+#define SIMD_TARGET __attribute__((target("avx2,fma")))
+
+SIMD_TARGET static void vector_add_avx2(const float* a, const float* b, float* c, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(&a[i]);
+        __m256 vb = _mm256_loadu_ps(&b[i]);
+        _mm256_storeu_ps(&c[i], _mm256_add_ps(va, vb));
+    }
+    for (; i < n; ++i) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+SIMD_TARGET static void fma_avx2(const float* a, const float* b, const float* c, float* result, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(&a[i]);
+        __m256 vb = _mm256_loadu_ps(&b[i]);
+        __m256 vc = _mm256_loadu_ps(&c[i]);
+        _mm256_storeu_ps(&result[i], _mm256_fmadd_ps(va, vb, vc));
+    }
+    for (; i < n; ++i) {
+        result[i] = a[i] * b[i] + c[i];
+    }
+}
+
+SIMD_TARGET static float dot_product_avx2(const float* a, const float* b, size_t n) {
+    __m256 sum_vec = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        sum_vec = _mm256_fmadd_ps(_mm256_loadu_ps(&a[i]), _mm256_loadu_ps(&b[i]), sum_vec);
+    }
+
+    // 水平求和
+    __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum_vec), _mm256_extractf128_ps(sum_vec, 1));
+    sum128 = _mm_hadd_ps(sum128, sum128);
+    sum128 = _mm_hadd_ps(sum128, sum128);
+    float sum = _mm_cvtss_f32(sum128);
+
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// AVX2 没有掩码寄存器：比较结果作为 blendv 的选择掩码，未选中的 lane 保留 a 原值
+SIMD_TARGET static void conditional_add_avx2(const float* a, const float* b, float* c, float threshold, size_t n) {
+    const __m256 vthreshold = _mm256_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(&a[i]);
+        __m256 vb = _mm256_loadu_ps(&b[i]);
+        __m256 mask = _mm256_cmp_ps(va, vthreshold, _CMP_GT_OQ);
+        _mm256_storeu_ps(&c[i], _mm256_blendv_ps(va, _mm256_add_ps(va, vb), mask));
+    }
+    for (; i < n; ++i) {
+        c[i] = a[i] > threshold ? a[i] + b[i] : a[i];
+    }
+}
+
+const SimdKernels kAvx2Kernels = {
+    SimdIsa::AVX2, "avx2", vector_add_avx2, fma_avx2, dot_product_avx2, conditional_add_avx2
+};
@@ -0,0 +1,73 @@
+// simd_kernels_avx512.cpp
+// AVX-512F 内核（Skylake-X / Ice Lake / Sapphire Rapids、Zen 4）
+
+#include "simd_intrin.hpp"
+
+#include "simd_dispatch.h"
+
+#define SIMD_TARGET __attribute__((target("avx512f,avx2,fma")))
+
+SIMD_TARGET static void vector_add_avx512(const float* a, const float* b, float* c, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 va = _mm512_loadu_ps(&a[i]);
+        __m512 vb = _mm512_loadu_ps(&b[i]);
+        _mm512_storeu_ps(&c[i], _mm512_add_ps(va, vb));
+    }
+    for (; i < n; ++i) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+SIMD_TARGET static void fma_avx512(const float* a, const float* b, const float* c, float* result, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 va = _mm512_loadu_ps(&a[i]);
+        __m512 vb = _mm512_loadu_ps(&b[i]);
+        __m512 vc = _mm512_loadu_ps(&c[i]);
+        _mm512_storeu_ps(&result[i], _mm512_fmadd_ps(va, vb, vc));
+    }
+    for (; i < n; ++i) {
+        result[i] = a[i] * b[i] + c[i];
+    }
+}
+
+SIMD_TARGET static float dot_product_avx512(const float* a, const float* b, size_t n) {
+    __m512 sum_vec = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        sum_vec = _mm512_fmadd_ps(_mm512_loadu_ps(&a[i]), _mm512_loadu_ps(&b[i]), sum_vec);
+    }
+
+    // 水平求和：512 → 256 → 128 → 32
+    __m256 sum256 = _mm256_add_ps(_mm512_castps512_ps256(sum_vec),
+                                  _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(sum_vec), 1)));
+    __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum256), _mm256_extractf128_ps(sum256, 1));
+    sum128 = _mm_hadd_ps(sum128, sum128);
+    sum128 = _mm_hadd_ps(sum128, sum128);
+    float sum = _mm_cvtss_f32(sum128);
+
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+SIMD_TARGET static void conditional_add_avx512(const float* a, const float* b, float* c, float threshold,
+                                               size_t n) {
+    const __m512 vthreshold = _mm512_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 va = _mm512_loadu_ps(&a[i]);
+        __m512 vb = _mm512_loadu_ps(&b[i]);
+        __mmask16 mask = _mm512_cmp_ps_mask(va, vthreshold, _CMP_GT_OQ);
+        _mm512_storeu_ps(&c[i], _mm512_mask_add_ps(va, mask, va, vb));
+    }
+    for (; i < n; ++i) {
+        c[i] = a[i] > threshold ? a[i] + b[i] : a[i];
+    }
+}
+
+const SimdKernels kAvx512Kernels = {
+    SimdIsa::AVX512, "avx512", vector_add_avx512, fma_avx512, dot_product_avx512, conditional_add_avx512
+};
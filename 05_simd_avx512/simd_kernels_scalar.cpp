@@ -0,0 +1,34 @@
+// simd_kernels_scalar.cpp
+// 基线内核：只用目标平台的默认指令集（x86-64 上为 SSE2），任何 CPU 都能运行
+
+#include "simd_dispatch.h"
+
+static void vector_add_scalar(const float* a, const float* b, float* c, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+static void fma_scalar(const float* a, const float* b, const float* c, float* result, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = a[i] * b[i] + c[i];
+    }
+}
+
+static float dot_product_scalar(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static void conditional_add_scalar(const float* a, const float* b, float* c, float threshold, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        c[i] = a[i] > threshold ? a[i] + b[i] : a[i];
+    }
+}
+
+const SimdKernels kScalarKernels = {
+    SimdIsa::Scalar, "scalar", vector_add_scalar, fma_scalar, dot_product_scalar, conditional_add_scalar
+};
@@ -0,0 +1,574 @@
+// simd_math.hpp
+// 向量化超越函数：exp、log、sin / cos、tanh、sigmoid、erf
+//
+// 1. 两档精度：Precision::Fast（最大 3.6 ULP，sigmoid；其余函数 2.6 以内。多项式短一到两阶，
+//    省去误差补偿，log 把非规格化输入视为 0）与 Precision::Accurate（最大 1.4 ULP，erf；
+//    exp / log / sin / cos / tanh 在 1 以内。关键步骤用 hi + lo 双 fp32 补偿舍入误差）。
+//    上界由 simd_math_ulp_check 对全部 2^32 个输入穷举验证
+// 2. 算法：Cody-Waite 区间约简 + minimax 多项式（long double 中 Lawson 迭代拟合，系数舍入到 fp32），
+//    全部用 FMA 的 Horner 形式求值
+// 3. 同一份算法模板通过 Ops 描述 ISA（ScalarOps / Avx2Ops / Avx512Ops），与 reductions.hpp 一致；
+//    三种 ISA 的结果逐位相同（需 -ffp-contract=off：GCC 默认会把标量 Ops 中相邻的乘法与加法
+//    合并为 FMA），标量版本可直接用作非 x86 平台的回退
+// 4. 特殊值与 C 库一致：NaN 传播，exp(+inf) = +inf，log(0) = -inf，log(x < 0) = NaN，
+//    sin / cos(±inf) = NaN，tanh / sigmoid / erf 在 ±inf 处饱和
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include "simd_intrin.hpp"
+#define MATH_HAS_AVX2
+#ifdef __AVX512F__
+#define MATH_HAS_AVX512
+#endif
+#endif
+
+namespace simd_math {
+
+enum class Precision { Fast, Accurate };
+
+inline const char* precision_name(Precision p) {
+    return p == Precision::Fast ? "fast" : "accurate";
+}
+
+// ============================================================================
+// Part 1: ISA 描述
+// ============================================================================
+
+// 每个 Ops 提供：fp32 向量 V（W 个 lane）、同宽的 int32 向量 I、比较结果 M，
+// 以及多项式求值、区间约简和位操作所需的最小操作集合
+// 约定：min(a, b) / max(a, b) 在任一操作数为 NaN 时返回 b（与 minps / maxps 一致），
+// 用于把 NaN 钳制成有限值后再转换为整数；最终结果统一用 isnan 选择恢复 NaN
+
+struct ScalarOps {
+    static constexpr const char* name = "scalar";
+    using V = float;
+    using I = int32_t;
+    using M = bool;
+    static constexpr size_t W = 1;
+
+    static V set1(float x) { return x; }
+    static I set1_i(int32_t x) { return x; }
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V a) { *p = a; }
+
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    // a * b + c、a * b - c 与 c - a * b，只舍入一次（与向量 FMA 逐位一致）
+    static V fmadd(V a, V b, V c) { return std::fma(a, b, c); }
+    static V fmsub(V a, V b, V c) { return std::fma(a, b, -c); }
+    static V fnmadd(V a, V b, V c) { return std::fma(-a, b, c); }
+    static V min(V a, V b) { return a < b ? a : b; }
+    static V max(V a, V b) { return a > b ? a : b; }
+    static V round(V a) { return std::nearbyint(a); }
+
+    // 调用方保证输入是有限值且在 int32 范围内
+    static I cvt_i(V a) { return static_cast<int32_t>(std::nearbyint(a)); }
+    static I cvtt_i(V a) { return static_cast<int32_t>(a); }
+    static V cvt_f(I a) { return static_cast<float>(a); }
+    static I as_i(V a) { int32_t r; std::memcpy(&r, &a, sizeof r); return r; }
+    static V as_f(I a) { float r; std::memcpy(&r, &a, sizeof r); return r; }
+
+    static I add_i(I a, I b) { return static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b)); }
+    static I sub_i(I a, I b) { return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b)); }
+    static I and_i(I a, I b) { return a & b; }
+    static I or_i(I a, I b) { return a | b; }
+    static I xor_i(I a, I b) { return a ^ b; }
+    template<int S> static I slli(I a) { return static_cast<int32_t>(static_cast<uint32_t>(a) << S); }
+    template<int S> static I srli(I a) { return static_cast<int32_t>(static_cast<uint32_t>(a) >> S); }
+    template<int S> static I srai(I a) { return a >> S; }
+
+    static M lt(V a, V b) { return a < b; }
+    static M le(V a, V b) { return a <= b; }
+    static M eq(V a, V b) { return a == b; }
+    static M isnan(V a) { return a != a; }
+    // bit 为单个比特：a & bit 非零的 lane
+    static M test_i(I a, int32_t bit) { return (a & bit) != 0; }
+    static V select(M m, V a, V b) { return m ? a : b; }
+    static I select_i(M m, I a, I b) { return m ? a : b; }
+    static unsigned bits(M m) { return m ? 1u : 0u; }
+};
+
+#ifdef MATH_HAS_AVX2
+struct Avx2Ops {
+    static constexpr const char* name = "AVX2";
+    using V = __m256;
+    using I = __m256i;
+    using M = __m256;
+    static constexpr size_t W = 8;
+
+    static V set1(float x) { return _mm256_set1_ps(x); }
+    static I set1_i(int32_t x) { return _mm256_set1_epi32(x); }
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V a) { _mm256_storeu_ps(p, a); }
+
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+    static V fmsub(V a, V b, V c) { return _mm256_fmsub_ps(a, b, c); }
+    static V fnmadd(V a, V b, V c) { return _mm256_fnmadd_ps(a, b, c); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V round(V a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    static I cvt_i(V a) { return _mm256_cvtps_epi32(a); }
+    static I cvtt_i(V a) { return _mm256_cvttps_epi32(a); }
+    static V cvt_f(I a) { return _mm256_cvtepi32_ps(a); }
+    static I as_i(V a) { return _mm256_castps_si256(a); }
+    static V as_f(I a) { return _mm256_castsi256_ps(a); }
+
+    static I add_i(I a, I b) { return _mm256_add_epi32(a, b); }
+    static I sub_i(I a, I b) { return _mm256_sub_epi32(a, b); }
+    static I and_i(I a, I b) { return _mm256_and_si256(a, b); }
+    static I or_i(I a, I b) { return _mm256_or_si256(a, b); }
+    static I xor_i(I a, I b) { return _mm256_xor_si256(a, b); }
+    template<int S> static I slli(I a) { return _mm256_slli_epi32(a, S); }
+    template<int S> static I srli(I a) { return _mm256_srli_epi32(a, S); }
+    template<int S> static I srai(I a) { return _mm256_srai_epi32(a, S); }
+
+    static M lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M le(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static M eq(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static M isnan(V a) { return _mm256_cmp_ps(a, a, _CMP_UNORD_Q); }
+    static M test_i(I a, int32_t bit) {
+        const I b = _mm256_set1_epi32(bit);
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(a, b), b));
+    }
+    static V select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+    static I select_i(M m, I a, I b) { return as_i(_mm256_blendv_ps(as_f(b), as_f(a), m)); }
+    static unsigned bits(M m) { return static_cast<unsigned>(_mm256_movemask_ps(m)); }
+};
+#endif
+
+#ifdef MATH_HAS_AVX512
+struct Avx512Ops {
+    static constexpr const char* name = "AVX-512";
+    using V = __m512;
+    using I = __m512i;
+    using M = __mmask16;
+    static constexpr size_t W = 16;
+
+    static V set1(float x) { return _mm512_set1_ps(x); }
+    static I set1_i(int32_t x) { return _mm512_set1_epi32(x); }
+    static V load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, V a) { _mm512_storeu_ps(p, a); }
+
+    static V add(V a, V b) { return _mm512_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm512_div_ps(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+    static V fmsub(V a, V b, V c) { return _mm512_fmsub_ps(a, b, c); }
+    static V fnmadd(V a, V b, V c) { return _mm512_fnmadd_ps(a, b, c); }
+    static V min(V a, V b) { return _mm512_min_ps(a, b); }
+    static V max(V a, V b) { return _mm512_max_ps(a, b); }
+    static V round(V a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    static I cvt_i(V a) { return _mm512_cvtps_epi32(a); }
+    static I cvtt_i(V a) { return _mm512_cvttps_epi32(a); }
+    static V cvt_f(I a) { return _mm512_cvtepi32_ps(a); }
+    static I as_i(V a) { return _mm512_castps_si512(a); }
+    static V as_f(I a) { return _mm512_castsi512_ps(a); }
+
+    static I add_i(I a, I b) { return _mm512_add_epi32(a, b); }
+    static I sub_i(I a, I b) { return _mm512_sub_epi32(a, b); }
+    static I and_i(I a, I b) { return _mm512_and_si512(a, b); }
+    static I or_i(I a, I b) { return _mm512_or_si512(a, b); }
+    static I xor_i(I a, I b) { return _mm512_xor_si512(a, b); }
+    template<int S> static I slli(I a) { return _mm512_slli_epi32(a, S); }
+    template<int S> static I srli(I a) { return _mm512_srli_epi32(a, S); }
+    template<int S> static I srai(I a) { return _mm512_srai_epi32(a, S); }
+
+    static M lt(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static M le(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    static M eq(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    static M isnan(V a) { return _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q); }
+    static M test_i(I a, int32_t bit) { return _mm512_test_epi32_mask(a, _mm512_set1_epi32(bit)); }
+    static V select(M m, V a, V b) { return _mm512_mask_blend_ps(m, b, a); }
+    static I select_i(M m, I a, I b) { return _mm512_mask_blend_epi32(m, b, a); }
+    static unsigned bits(M m) { return static_cast<unsigned>(m); }
+};
+#endif
+
+// 编译期可用的最宽 ISA
+#if defined(MATH_HAS_AVX512)
+using BestOps = Avx512Ops;
+#elif defined(MATH_HAS_AVX2)
+using BestOps = Avx2Ops;
+#else
+using BestOps = ScalarOps;
+#endif
+
+// ============================================================================
+// Part 2: 多项式系数
+// ============================================================================
+
+// 均为最高次项在前的 Horner 系数；注释给出拟合区间与拟合误差（不含求值舍入）
+namespace coeffs {
+
+// e^r = 1 + r + r^2 * P(r)，r ∈ [-ln2/2, ln2/2]
+inline constexpr float kExpAccurate[] = {   // 0.002 ULP
+    1.9740249263e-04f, 1.3935078168e-03f, 8.3335703239e-03f,
+    4.1666463017e-02f, 1.6666665673e-01f, 5.0000000000e-01f };
+inline constexpr float kExpFast[] = {       // 1.8 ULP
+    8.3126882091e-03f, 4.1890177876e-02f, 1.6667112708e-01f, 4.9999231100e-01f };
+
+// log(1 + f) = f - f^2 / 2 + f^3 * P(f)，f ∈ [sqrt(1/2) - 1, sqrt(2) - 1]
+inline constexpr float kLogAccurate[] = {   // 0.1 ULP
+    -7.6364390552e-02f, 1.2762217224e-01f, -1.3159610331e-01f, 1.4201579988e-01f,
+    -1.6623409092e-01f, 2.0001241565e-01f, -2.5000819564e-01f, 3.3333331347e-01f };
+inline constexpr float kLogFast[] = {       // 0.5 ULP
+    8.7015129626e-02f, -1.4267481863e-01f, 1.4914363623e-01f, -1.6577570140e-01f,
+    1.9963105023e-01f, -2.5001338124e-01f, 3.3333909512e-01f };
+
+// sin(r) = r + r^3 * S(r^2)，cos(r) = 1 - r^2 / 2 + r^4 * C(r^2)，r ∈ [-pi/4, pi/4]
+inline constexpr float kSin[] = {           // 0.07 ULP
+    -1.9518291811e-04f, 8.3321891725e-03f, -1.6666655242e-01f };
+inline constexpr float kCosAccurate[] = {   // 0.002 ULP
+    2.4432558348e-05f, -1.3887310633e-03f, 4.1666645557e-02f };
+inline constexpr float kCosFast[] = {       // 1.4 ULP
+    -1.3648736058e-03f, 4.1661072522e-02f };
+
+// tanh(x) = x + x^3 * P(x^2)，Accurate 用于 |x| < 1，Fast 用于 |x| < 0.625
+inline constexpr float kTanhAccurate[] = {  // 0.08 ULP
+    -3.5861122888e-04f, 2.3019297514e-03f, -7.9468935728e-03f, 2.1487198770e-02f,
+    -5.3879991174e-02f, 1.3332347572e-01f, -3.3333295584e-01f };
+inline constexpr float kTanhFast[] = {      // 2.0 ULP
+    1.5195803717e-02f, -5.1948253065e-02f, 1.3308183849e-01f, -3.3332341909e-01f };
+
+// erf(x) = x * (c0 + x^2 * P(x^2))，|x| < 1；c0 = 2/sqrt(pi) 拆成 fp32 的 hi + lo，
+// 数组最后一项是 lo（否则 c0 的舍入本身就带来 x -> 0 处 0.9 ULP 的系统误差）
+inline constexpr float kErfC0Hi = 1.12837922573089599609375f;
+inline constexpr float kErfSmallAccurate[] = {  // 0.03 ULP
+    7.8425488027e-05f, -8.0093985889e-04f, 5.1885982975e-03f, -2.6854202151e-02f,
+    1.1283603311e-01f, -3.7612628937e-01f, -5.8635383422e-08f };
+inline constexpr float kErfSmallFast[] = {      // 0.75 ULP
+    -5.6729209609e-04f, 4.9290368333e-03f, -2.6722876355e-02f,
+    1.1280689389e-01f, -3.7612417340e-01f, -5.8635383422e-08f };
+
+// log(erfc(t)) + t^2 = Q(t - 2.5)，t ∈ [1, 4]；误差以绝对值计，经 erf = 1 - erfc 再缩小至少 6 倍
+inline constexpr float kErfLargeAccurate[] = {  // 1.4e-8
+    1.6095679030e-06f, -1.3288772607e-05f, 7.7401899034e-05f, -4.2022770504e-04f,
+    2.1651785355e-03f, -1.0858418420e-02f, 5.6106325239e-02f, -3.5268071294e-01f,
+    -1.5568152666e+00f };
+inline constexpr float kErfLargeFast[] = {      // 3.5e-7
+    -1.3290074094e-05f, 8.4631705249e-05f, -4.2026289157e-04f, 2.1550047677e-03f,
+    -1.0858310387e-02f, 5.6110959500e-02f, -3.5268077254e-01f, -1.5568156242e+00f };
+
+} // namespace coeffs
+
+// ============================================================================
+// Part 3: 向量内核
+// ============================================================================
+
+template<typename Ops, Precision P = Precision::Accurate>
+struct Kernels {
+    using V = typename Ops::V;
+    using I = typename Ops::I;
+    using M = typename Ops::M;
+    static constexpr bool kAccurate = P == Precision::Accurate;
+
+    static V c(float x) { return Ops::set1(x); }
+    static I ci(int32_t x) { return Ops::set1_i(x); }
+
+    template<size_t N>
+    static V horner(V x, const float (&k)[N]) {
+        V p = c(k[0]);
+        for (size_t i = 1; i < N; ++i) p = Ops::fmadd(p, x, c(k[i]));
+        return p;
+    }
+
+    static V abs(V x) { return Ops::as_f(Ops::and_i(Ops::as_i(x), ci(0x7fffffff))); }
+    static I sign_of(V x) { return Ops::and_i(Ops::as_i(x), ci(INT32_MIN)); }
+    static V xor_sign(V x, I sign) { return Ops::as_f(Ops::xor_i(Ops::as_i(x), sign)); }
+    // 2^k，k ∈ [-126, 127]
+    static V pow2(I k) { return Ops::as_f(Ops::template slli<23>(Ops::add_i(k, ci(127)))); }
+
+    // ------------------------------------------------------------------------
+    // exp：x = n * ln2 + r，e^x = 2^n * e^r
+    // ln2 拆成 hi + lo：hi 为 ln2 舍入到 fp32，r1 = x - n * hi 在 FMA 中是精确的，
+    // 剩余的 -n * lo（|.| < 3e-7）作为修正项
+    // Accurate 用 Fast2Sum 把 1 + r1 保留为 hi + lo，只在最后舍入一次（约 0.55 ULP）
+    // 2^n 拆成两次乘法：n ∈ [-151, 128] 时结果可以平滑下降到非规格化数，也不会提前上溢
+    // ------------------------------------------------------------------------
+    static V exp(V x) {
+        V lo;
+        return exp_hilo<false>(x, lo);
+    }
+
+    // Accurate 且 WantLo 时额外给出 lo，e^x ≈ hi + lo（结果为规格化数时有效），供 sigmoid 使用
+    template<bool WantLo>
+    static V exp_hilo(V x, V& lo) {
+        const V xc = Ops::min(Ops::max(x, c(-105.0f)), c(89.0f));
+        const V n = Ops::round(Ops::mul(xc, c(1.44269504088896341f)));
+        const V r1 = Ops::fnmadd(n, c(0.693147182464599609375f), xc);
+        const V corr = Ops::mul(n, c(1.9046542999577679e-9f));
+
+        V y;
+        lo = c(0.0f);
+        if constexpr (kAccurate) {
+            const V p = horner(r1, coeffs::kExpAccurate);
+            const V hi = Ops::add(c(1.0f), r1);
+            const V hl = Ops::add(Ops::sub(c(1.0f), hi), r1);
+            const V tail = Ops::fmadd(Ops::mul(r1, r1), p, Ops::fmadd(corr, hi, hl));
+            y = Ops::add(hi, tail);
+            if constexpr (WantLo) lo = Ops::add(Ops::sub(hi, y), tail);
+        } else {
+            const V r = Ops::add(r1, corr);
+            const V p = horner(r, coeffs::kExpFast);
+            y = Ops::add(Ops::fmadd(p, Ops::mul(r, r), r), c(1.0f));
+        }
+
+        const I ni = Ops::cvt_i(n);
+        const I n1 = Ops::template srai<1>(ni);
+        const V s1 = pow2(n1), s2 = pow2(Ops::sub_i(ni, n1));
+        y = Ops::mul(Ops::mul(y, s1), s2);
+        if constexpr (kAccurate && WantLo) lo = Ops::mul(Ops::mul(lo, s1), s2);
+        // ln(FLT_MAX) = 88.7228390...，其上的第一个 fp32 起上溢
+        y = Ops::select(Ops::lt(c(88.7228317f), x), c(std::numeric_limits<float>::infinity()), y);
+        return Ops::select(Ops::isnan(x), x, y);
+    }
+
+    // ------------------------------------------------------------------------
+    // log：x = 2^e * m，m ∈ [sqrt(1/2), sqrt(2))，log(x) = e * ln2 + log(1 + f)，f = m - 1
+    // ------------------------------------------------------------------------
+    static V log(V x) {
+        constexpr float kMinNormal = std::numeric_limits<float>::min();
+        V xs = x;
+        I bias = ci(126);
+        if constexpr (kAccurate) {
+            // 非规格化输入先乘 2^23 规格化
+            const M den = Ops::lt(x, c(kMinNormal));
+            xs = Ops::select(den, Ops::mul(x, c(8388608.0f)), x);
+            bias = Ops::select_i(den, ci(126 + 23), bias);
+        }
+        const I ix = Ops::as_i(xs);
+        I e = Ops::sub_i(Ops::template srli<23>(ix), bias);
+        V m = Ops::as_f(Ops::or_i(Ops::and_i(ix, ci(0x007fffff)), ci(0x3f000000)));   // [0.5, 1)
+
+        // m < sqrt(1/2) 时 m 翻倍、e 减一；2m - 1 与 m - 1 都是精确的
+        const M lo = Ops::lt(m, c(0.707106781186547524f));
+        e = Ops::sub_i(e, Ops::select_i(lo, ci(1), ci(0)));
+        const V f = Ops::sub(Ops::add(m, Ops::select(lo, m, c(0.0f))), c(1.0f));
+        const V ef = Ops::cvt_f(e);
+
+        const V z = Ops::mul(f, f);
+        V y;
+        if constexpr (kAccurate) y = horner(f, coeffs::kLogAccurate);
+        else y = horner(f, coeffs::kLogFast);
+        y = Ops::mul(Ops::mul(f, z), y);
+        // ln2 = 0.693359375 - 2.12194440e-4：前一段只有 9 位有效数字，e * hi 是精确的
+        y = Ops::fmadd(ef, c(-2.12194440e-4f), y);
+        y = Ops::fnmadd(c(0.5f), z, y);
+        y = Ops::add(f, y);
+        y = Ops::fmadd(ef, c(0.693359375f), y);
+
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        y = Ops::select(kAccurate ? Ops::eq(x, c(0.0f)) : Ops::lt(x, c(kMinNormal)), c(-inf), y);
+        y = Ops::select(Ops::lt(x, c(0.0f)), c(std::numeric_limits<float>::quiet_NaN()), y);
+        y = Ops::select(Ops::eq(x, c(inf)), x, y);
+        return Ops::select(Ops::isnan(x), x, y);
+    }
+
+    // ------------------------------------------------------------------------
+    // sin / cos：按 pi/4 约简，j 取偶数后 r ∈ [-pi/4, pi/4]
+    // j & 2 决定用 sin 还是 cos 多项式，j & 4（cos 为 (j + 2) & 4）决定符号
+    // 两档都把 pi/4 拆成三个 fp32（共约 72 位），用三次 FMA 约简；|x| <= 65536 时 j 最多 17 位，
+    // x - j * C1 在 FMA 中是精确的。Cephes 的 8 位首段常数合计只有约 48 位，|x| 到几百时
+    // 就在 pi/4 整数倍附近损失上百 ULP，因此 Fast 档不再使用
+    // Fast：r 只保留 hi，cos 多项式短一阶
+    // Accurate：r 保留为 hi + lo（TwoSum），多项式对 lo 做一阶修正
+    // 超出范围的 lane（以及 ±inf）回退到 fp64 的 std::sin / std::cos：fp32 约简在更大的 |x|
+    // 上靠近 pi/4 整数倍时丢失相对精度
+    // ------------------------------------------------------------------------
+    static constexpr float kTrigMax = 65536.0f;
+
+    template<bool Cos>
+    static V sincos(V x) {
+        const V ax = abs(x);
+        const V axc = Ops::min(ax, c(kTrigMax));
+        I j = Ops::cvtt_i(Ops::mul(axc, c(1.27323954473516f)));
+        j = Ops::add_i(j, Ops::and_i(j, ci(1)));
+        const V yj = Ops::cvt_f(j);
+
+        V hi, lo, z, ps, pc;
+        if constexpr (kAccurate) {
+            const V r1 = Ops::fnmadd(yj, c(0x1.921fb6p-1f), axc);
+            const V p = Ops::mul(yj, c(-0x1.777a5cp-26f));
+            const V pe = Ops::fmsub(yj, c(-0x1.777a5cp-26f), p);
+            hi = Ops::sub(r1, p);
+            const V bb = Ops::sub(hi, r1);
+            const V e = Ops::add(Ops::sub(r1, Ops::sub(hi, bb)), Ops::sub(Ops::sub(c(0.0f), p), bb));
+            lo = Ops::fnmadd(yj, c(-0x1.ee59dap-51f), Ops::sub(e, pe));
+            z = Ops::mul(hi, hi);
+            // sin(hi + lo) ≈ sin(hi) + lo * (1 - hi^2 / 2)
+            const V lc = Ops::fnmadd(Ops::mul(c(0.5f), z), lo, lo);
+            ps = Ops::add(hi, Ops::fmadd(Ops::mul(hi, z), horner(z, coeffs::kSin), lc));
+            // cos(hi + lo) ≈ cos(hi) - hi * lo；主项 w = 1 - z / 2 的舍入误差与 z = hi^2 的
+            // 舍入误差都是精确可求的（Sterbenz 与 FMA），一起并入尾项
+            const V zl = Ops::fmsub(hi, hi, z);
+            const V w = Ops::fnmadd(c(0.5f), z, c(1.0f));
+            const V werr = Ops::sub(Ops::sub(c(1.0f), w), Ops::mul(c(0.5f), z));
+            pc = Ops::fnmadd(hi, lo, Ops::mul(Ops::mul(z, z), horner(z, coeffs::kCosAccurate)));
+            pc = Ops::fnmadd(c(0.5f), zl, Ops::add(pc, werr));
+            pc = Ops::add(w, pc);
+        } else {
+            hi = Ops::fnmadd(yj, c(0x1.921fb6p-1f), axc);
+            hi = Ops::fnmadd(yj, c(-0x1.777a5cp-26f), hi);
+            hi = Ops::fnmadd(yj, c(-0x1.ee59dap-51f), hi);
+            z = Ops::mul(hi, hi);
+            ps = Ops::fmadd(Ops::mul(hi, z), horner(z, coeffs::kSin), hi);
+            pc = Ops::fmadd(Ops::mul(z, z), horner(z, coeffs::kCosFast), Ops::fnmadd(c(0.5f), z, c(1.0f)));
+        }
+
+        const M swap = Ops::test_i(j, 2);
+        V y;
+        I sign;
+        if constexpr (Cos) {
+            y = Ops::select(swap, ps, pc);
+            sign = Ops::template slli<29>(Ops::and_i(Ops::add_i(j, ci(2)), ci(4)));
+        } else {
+            y = Ops::select(swap, pc, ps);
+            sign = Ops::xor_i(Ops::template slli<29>(Ops::and_i(j, ci(4))), sign_of(x));
+        }
+        y = xor_sign(y, sign);
+
+        const unsigned big = Ops::bits(Ops::lt(c(kTrigMax), ax));
+        if (big != 0) {
+            float xs[Ops::W], ys[Ops::W];
+            Ops::store(xs, x);
+            Ops::store(ys, y);
+            for (size_t l = 0; l < Ops::W; ++l) {
+                if (big & (1u << l)) {
+                    const double v = xs[l];
+                    ys[l] = static_cast<float>(Cos ? std::cos(v) : std::sin(v));
+                }
+            }
+            y = Ops::load(ys);
+        }
+        return Ops::select(Ops::isnan(x), x, y);
+    }
+
+    static V sin(V x) { return sincos<false>(x); }
+    static V cos(V x) { return sincos<true>(x); }
+
+    // ------------------------------------------------------------------------
+    // tanh：|x| 小于切换点时用奇多项式，否则 1 - 2 / (e^{2|x|} + 1)
+    // Accurate 的切换点取 1：e^{2|x|} 与 e + 1 的舍入误差经 2 / (e + 1)^2 缩小到 0.03 倍以下
+    // ------------------------------------------------------------------------
+    static constexpr float kTanhSwitch = kAccurate ? 1.0f : 0.625f;
+
+    static V tanh(V x) {
+        const V ax = abs(x);
+        const V z = Ops::mul(x, x);
+        V ps;
+        if constexpr (kAccurate) ps = horner(z, coeffs::kTanhAccurate);
+        else ps = horner(z, coeffs::kTanhFast);
+        ps = Ops::fmadd(Ops::mul(x, z), ps, x);
+
+        const V e = exp(Ops::add(ax, ax));
+        V pl = Ops::sub(c(1.0f), Ops::div(c(2.0f), Ops::add(e, c(1.0f))));
+        pl = xor_sign(pl, sign_of(x));
+        return Ops::select(Ops::lt(ax, c(kTanhSwitch)), ps, pl);
+    }
+
+    // ------------------------------------------------------------------------
+    // sigmoid：s = e^{-|x|}，x >= 0 时 1 / (1 + s)，否则 s / (1 + s)
+    // 负半轴不经过 1 - sigmoid(|x|)，x 很负时结果仍有完整的相对精度
+    // Accurate：s 与 1 + s 都保留为 hi + lo，商做一次修正 q + (num_lo - q * l) / h，
+    // 其中 1 / h 正好是 q（x >= 0）或 1 - q（x < 0），不需要第二次除法
+    // ------------------------------------------------------------------------
+    static V sigmoid(V x) {
+        V sl;
+        const V s = exp_hilo<true>(Ops::sub(c(0.0f), abs(x)), sl);
+        const M neg = Ops::lt(x, c(0.0f));
+        const V h = Ops::add(c(1.0f), s);
+        V q = Ops::div(Ops::select(neg, s, c(1.0f)), h);
+        if constexpr (kAccurate) {
+            const V l = Ops::add(Ops::add(Ops::sub(c(1.0f), h), s), sl);
+            const V num_lo = Ops::select(neg, sl, c(0.0f));
+            const V inv_h = Ops::select(neg, Ops::sub(c(1.0f), q), q);
+            q = Ops::fmadd(Ops::fnmadd(q, l, num_lo), inv_h, q);
+        }
+        return q;
+    }
+
+    // ------------------------------------------------------------------------
+    // erf：|x| < 1 用 x * (c0 + x^2 * P(x^2))；1 <= |x| 时 erf = 1 - erfc，
+    // erfc(t) = e^{Q(t - 2.5) - t^2}
+    // t 钳制到 4：erfc(4) = 1.5e-8 < 2^-25，1 - erfc 舍入为 1
+    // Accurate 用 FMA 把 t^2 拆成 hi + lo，指数的绝对误差不随 t^2 放大
+    // ------------------------------------------------------------------------
+    static V erf(V x) {
+        const V ax = abs(x);
+        const V z = Ops::mul(x, x);
+        V ps;
+        if constexpr (kAccurate) ps = horner(z, coeffs::kErfSmallAccurate);
+        else ps = horner(z, coeffs::kErfSmallFast);
+        ps = Ops::fmadd(x, c(coeffs::kErfC0Hi), Ops::mul(x, ps));
+
+        const V t = Ops::min(ax, c(4.0f));
+        V q;
+        if constexpr (kAccurate) q = horner(Ops::sub(t, c(2.5f)), coeffs::kErfLargeAccurate);
+        else q = horner(Ops::sub(t, c(2.5f)), coeffs::kErfLargeFast);
+        const V t2 = Ops::mul(t, t);
+        if constexpr (kAccurate) q = Ops::sub(q, Ops::fmsub(t, t, t2));
+        V pl = Ops::sub(c(1.0f), exp(Ops::sub(q, t2)));
+        pl = xor_sign(pl, sign_of(x));
+
+        const V y = Ops::select(Ops::lt(ax, c(1.0f)), ps, pl);
+        return Ops::select(Ops::isnan(x), x, y);
+    }
+};
+
+// ============================================================================
+// Part 4: 数组接口
+// ============================================================================
+
+namespace detail {
+
+// 整向量部分直接处理；不足 W 个元素的尾部拷入一个满向量缓冲区再处理，
+// 保证尾部元素与主循环逐位一致（x 与 y 可以是同一数组）
+template<typename Ops, typename F>
+inline void apply(const float* x, float* y, size_t n, F f) {
+    constexpr size_t W = Ops::W;
+    const size_t vec_end = n - n % W;
+    for (size_t i = 0; i < vec_end; i += W) Ops::store(y + i, f(Ops::load(x + i)));
+    if (vec_end == n) return;
+
+    float buf[W] = {};
+    const size_t rest = n - vec_end;
+    std::memcpy(buf, x + vec_end, rest * sizeof(float));
+    Ops::store(buf, f(Ops::load(buf)));
+    std::memcpy(y + vec_end, buf, rest * sizeof(float));
+}
+
+} // namespace detail
+
+#define SIMD_MATH_ARRAY_FUNCTION(fn)                                                    \
+    template<Precision P = Precision::Accurate, typename Ops = BestOps>                 \
+    inline void fn(const float* x, float* y, size_t n) {                                \
+        detail::apply<Ops>(x, y, n, [](typename Ops::V v) { return Kernels<Ops, P>::fn(v); }); \
+    }
+
+SIMD_MATH_ARRAY_FUNCTION(exp)
+SIMD_MATH_ARRAY_FUNCTION(log)
+SIMD_MATH_ARRAY_FUNCTION(sin)
+SIMD_MATH_ARRAY_FUNCTION(cos)
+SIMD_MATH_ARRAY_FUNCTION(tanh)
+SIMD_MATH_ARRAY_FUNCTION(sigmoid)
+SIMD_MATH_ARRAY_FUNCTION(erf)
+
+#undef SIMD_MATH_ARRAY_FUNCTION
+
+} // namespace simd_math
@@ -0,0 +1,203 @@
+// simd_math_benchmark.cpp
+// simd_math.hpp 的吞吐量测试：每个函数对比 libm 标量循环、标量 Ops 与 AVX2 / AVX-512 两档精度
+// 输入为 4096 个 fp32（L1 内），取各函数在激活 / 打分代码中的典型范围；
+// 每一行同时给出该输入上相对 fp64 参考值的最大 ULP 误差
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "simd_math.hpp"
+
+namespace sm = simd_math;
+using sm::Precision;
+
+// ============================================================================
+// 性能测试框架
+// ============================================================================
+
+// 每次调用处理 n 个元素，重复 reps 次以获得可测量的耗时
+template<typename Func>
+double benchmark(const std::string& name, size_t n, double ulp, double baseline_ms, Func func, int iterations, int reps) {
+    // 预热
+    func();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (int r = 0; r < reps; ++r) {
+            func();
+            asm volatile("" : : : "memory");
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / (iterations * reps);
+    std::cout << std::left << std::setw(35) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(4) << ms << " ms"
+              << std::setw(9) << std::setprecision(2) << ms * 1e6 / n << " ns/elem"
+              << std::setw(8) << std::setprecision(2) << ulp
+              << std::setw(8) << std::setprecision(1) << (baseline_ms > 0.0 ? baseline_ms / ms : 1.0) << "x"
+              << std::endl;
+    return ms;
+}
+
+void print_header() {
+    std::cout << std::left << std::setw(35) << "" << std::right << std::setw(15) << "time"
+              << std::setw(17) << "per element" << std::setw(8) << "ULP" << std::setw(9) << "speedup" << "\n";
+}
+
+double ulp_error(float y, double ref) {
+    if (std::isnan(ref)) return std::isnan(y) ? 0.0 : std::numeric_limits<double>::infinity();
+    if (ref == 0.0) return std::fabs(y) / 0x1p-149;
+    int e;
+    std::frexp(ref, &e);
+    return std::fabs(y - ref) / std::ldexp(1.0, std::max(e - 24, -149));
+}
+
+double max_ulp(const std::vector<float>& y, const std::vector<double>& ref) {
+    double m = 0.0;
+    for (size_t i = 0; i < y.size(); ++i) m = std::max(m, ulp_error(y[i], ref[i]));
+    return m;
+}
+
+// ============================================================================
+// 函数表
+// ============================================================================
+
+using ArrayFn = void (*)(const float*, float*, size_t);
+
+struct Variant {
+    const char* label;
+    ArrayFn fn;
+};
+
+struct Function {
+    const char* name;
+    float lo, hi;               // 输入范围
+    float (*libm)(float);       // 标量基线
+    double (*ref)(double);      // fp64 参考
+    std::vector<Variant> variants;
+};
+
+#define VARIANT_LIST(fn)                                                                   \
+    [] {                                                                                   \
+        std::vector<Variant> v = { { "scalar Ops accurate", &sm::fn<Precision::Accurate, sm::ScalarOps> } }; \
+        MATH_AVX2_VARIANTS(fn)                                                             \
+        MATH_AVX512_VARIANTS(fn)                                                           \
+        return v;                                                                          \
+    }()
+
+#ifdef MATH_HAS_AVX2
+#define MATH_AVX2_VARIANTS(fn)                                                             \
+    v.push_back({ "AVX2 fast", &sm::fn<Precision::Fast, sm::Avx2Ops> });                  \
+    v.push_back({ "AVX2 accurate", &sm::fn<Precision::Accurate, sm::Avx2Ops> });
+#else
+#define MATH_AVX2_VARIANTS(fn)
+#endif
+
+#ifdef MATH_HAS_AVX512
+#define MATH_AVX512_VARIANTS(fn)                                                           \
+    v.push_back({ "AVX-512 fast", &sm::fn<Precision::Fast, sm::Avx512Ops> });             \
+    v.push_back({ "AVX-512 accurate", &sm::fn<Precision::Accurate, sm::Avx512Ops> });
+#else
+#define MATH_AVX512_VARIANTS(fn)
+#endif
+
+std::vector<Function> functions() {
+    return {
+        { "exp", -20.0f, 20.0f, [](float x) { return std::exp(x); },
+          [](double x) { return std::exp(x); }, VARIANT_LIST(exp) },
+        { "log", 1e-3f, 1e3f, [](float x) { return std::log(x); },
+          [](double x) { return std::log(x); }, VARIANT_LIST(log) },
+        { "sin", -10.0f, 10.0f, [](float x) { return std::sin(x); },
+          [](double x) { return std::sin(x); }, VARIANT_LIST(sin) },
+        { "cos", -10.0f, 10.0f, [](float x) { return std::cos(x); },
+          [](double x) { return std::cos(x); }, VARIANT_LIST(cos) },
+        { "tanh", -5.0f, 5.0f, [](float x) { return std::tanh(x); },
+          [](double x) { return std::tanh(x); }, VARIANT_LIST(tanh) },
+        { "sigmoid", -10.0f, 10.0f, [](float x) { return 1.0f / (1.0f + std::exp(-x)); },
+          [](double x) { return 1.0 / (1.0 + std::exp(-x)); }, VARIANT_LIST(sigmoid) },
+        { "erf", -3.0f, 3.0f, [](float x) { return std::erf(x); },
+          [](double x) { return std::erf(x); }, VARIANT_LIST(erf) },
+    };
+}
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+int main() {
+    constexpr size_t N = 4096;          // 16 KB 输入 + 16 KB 输出，L1 内
+    constexpr int ITERS = 20, REPS = 500;
+
+    std::cout << "================================================\n";
+    std::cout << "  SIMD Math: Throughput vs libm\n";
+    std::cout << "================================================\n";
+    std::cout << "Widest ISA: " << sm::BestOps::name << ", N = " << N << " floats (in L1)\n";
+    std::cout << "ULP column: max error on the benchmark input vs fp64 libm\n\n";
+
+    std::mt19937 rng(42);
+    std::vector<float> x(N), y(N);
+    std::vector<double> ref(N);
+
+    double best_speedup = 0.0;
+    const char* best_name = "";
+    for (const Function& f : functions()) {
+        std::uniform_real_distribution<float> dist(f.lo, f.hi);
+        for (auto& v : x) v = dist(rng);
+        for (size_t i = 0; i < N; ++i) ref[i] = f.ref(x[i]);
+
+        std::cout << f.name << ", x in [" << std::defaultfloat << f.lo << ", " << f.hi << "]\n";
+        std::cout << "------------------------------------------------\n";
+        print_header();
+
+        for (size_t i = 0; i < N; ++i) y[i] = f.libm(x[i]);
+        const std::string libm_label = std::string("libm std::") + (std::string(f.name) == "sigmoid" ? "exp" : f.name) + " loop";
+        double t_libm = benchmark(libm_label, N, max_ulp(y, ref), 0.0, [&]() {
+            for (size_t i = 0; i < N; ++i) y[i] = f.libm(x[i]);
+        }, ITERS, REPS);
+
+        for (const Variant& v : f.variants) {
+            v.fn(x.data(), y.data(), N);
+            double t = benchmark(v.label, N, max_ulp(y, ref), t_libm, [&]() { v.fn(x.data(), y.data(), N); }, ITERS, REPS);
+            if (t_libm / t > best_speedup) {
+                best_speedup = t_libm / t;
+                best_name = f.name;
+            }
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "================================================\n";
+    std::cout << "Summary\n";
+    std::cout << "================================================\n";
+    std::cout << "✓ libm calls are scalar: std::exp / std::tanh loops never vectorize\n";
+    std::cout << "✓ Polynomial kernels run " << sm::BestOps::W << " lanes per instruction, "
+              << "best speedup " << std::setprecision(1) << best_speedup << "x (" << best_name << ")\n";
+    std::cout << "✓ Fast tier trades ~2 ULP for shorter polynomials and no compensation terms\n";
+    std::cout << "================================================\n";
+
+    return 0;
+}
+
+/* 编译与运行:
+
+  g++ -std=c++20 -O3 -march=native -ffp-contract=off simd_math_benchmark.cpp -o simd_math_bench
+  ./simd_math_bench
+
+  g++ -std=c++20 -O3 -mavx2 -mfma -ffp-contract=off simd_math_benchmark.cpp -o simd_math_bench_avx2
+  # -ffp-contract=off：GCC 默认会把标量 Ops 中相邻的乘法与加法合并为 FMA，
+  # 标量结果因此与向量版本不再逐位相同（误差不会变大）
+
+预期结果:
+  - libm 的 expf / logf 约 3-10 ns/元素，sinf / tanhf / erff 更慢
+  - AVX2 比 libm 快 5-15 倍，AVX-512 再快约 1.5-2 倍；sigmoid 与 tanh 的除法是主要开销
+  - Fast 档比 Accurate 档快 10-40%（exp / sigmoid 最明显）
+  - ULP 列：Accurate 档 1.4 以内，Fast 档 3.6 以内（穷举上界见 simd_math_ulp_check）；libm 的 float 版本一般在 1 以内
+*/
@@ -0,0 +1,655 @@
+// simd_sort.hpp
+// AVX2 / AVX-512 排序：小块用寄存器内双调排序网络，大块用向量化分区的快速排序
+//
+// 1. 排序网络：M 个向量（M * W <= 8 * W 个元素）整体做双调排序。
+//    距离 >= W 的比较交换是两个向量间的 min / max；距离 < W 的在向量内用
+//    permute（lane ^ X）+ min / max + blend 完成，全部没有分支
+// 2. 分区：两端各预读一个向量腾出 2W 的空位，之后每次从空位较少的一端读入一个向量，
+//    把 < pivot 的 lane 左移打包写到左端、其余写到右端。
+//    AVX-512 用 vcompress（与 compaction.hpp 相同）；AVX2 查 256 项的分区置换表，
+//    一次 permutevar8x32 得到 [< pivot | >= pivot]，同一向量整体写两端
+// 3. pivot 取 16 个等距样本的中位数（样本本身用排序网络排序）；
+//    全部 >= pivot 时改用 <= pivot 分区剥离与 pivot 相等的元素，重复值多的输入不会退化；
+//    递归深度超过 2 log2(n) 时交给 std::sort（内省排序）保证 O(n log n)；
+//    整体已有序 / 逆序的输入先用一次 O(n) 检查直接处理
+// 4. 键值对：32 位键 + 32 位值打包成一个 int64（键在高位，按保序映射），用 int64 内核排序
+//
+// 浮点：NaN 先被移到末尾，其余元素升序；-0.0 与 +0.0 视为相等（与 std::sort 相同）
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <array>
+#include <bit>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "compaction.hpp"
+
+#ifdef COMPACT_HAS_AVX2
+#define SORT_HAS_AVX2
+#endif
+#ifdef COMPACT_HAS_AVX512
+#define SORT_HAS_AVX512
+#endif
+
+namespace simd_sort {
+
+// ============================================================================
+// Part 1: ISA 描述
+// ============================================================================
+
+// 在 simd_compact 的 Ops（load / load_partial / mask<Cmp>）之上，每个 Ops<T> 再提供
+//   min / max / store / store_partial / load_padded    排序网络的加载与比较交换
+//   permute_xor<X>(x)       lane i 取 x[i ^ X]
+//   blend_bit<B>(a, b)      lane i 满足 (i & B) != 0 时取 b，否则取 a
+//   partition_store<Exact>(x, lt, valid, left, right)
+//       lt 中的 lane 左移打包写到 left，valid & ~lt 中的 lane 写到 [right - 个数, right)，返回前者个数
+//       Exact = false 时允许整向量写入（调用方保证两端各有 W 个空位）；true 时只写有效元素
+
+// 没有 AVX2 时 sort() 直接调用 std::sort
+template<typename T>
+struct ScalarOps {
+    static constexpr const char* name = "std::sort";
+    static constexpr size_t W = 1;
+};
+
+namespace detail {
+
+// lane i 满足 (i & B) != 0 的位掩码
+template<size_t W, int B>
+constexpr uint32_t kBitLanes = [] {
+    uint32_t m = 0;
+    for (uint32_t i = 0; i < W; ++i) if (i & B) m |= 1u << i;
+    return m;
+}();
+
+// 128 位内 4 个 lane 的 lane ^ X 置换立即数（X < 4）
+template<int X>
+constexpr int kXorImm4 = (0 ^ X) | (1 ^ X) << 2 | (2 ^ X) << 4 | (3 ^ X) << 6;
+
+// 64 位 lane 的 blend_epi32 立即数：每个 64 位 lane 对应两个 32 位 lane
+constexpr int widen_imm(uint32_t m4) {
+    int imm = 0;
+    for (int i = 0; i < 4; ++i) if (m4 >> i & 1) imm |= 3 << (2 * i);
+    return imm;
+}
+
+} // namespace detail
+
+#ifdef SORT_HAS_AVX2
+namespace detail {
+
+// AVX2 分区置换表：表项 m 先列出 m 中置位的 lane，再列出其余 lane（各自保持原顺序）
+// 与 compaction.hpp 的左移打包表格式相同，每个 4-bit 字段一个 32 位下标
+template<size_t Lanes>
+constexpr std::array<uint32_t, size_t{ 1 } << Lanes> make_partition_lut() {
+    constexpr uint32_t kSub = 8 / Lanes;
+    std::array<uint32_t, size_t{ 1 } << Lanes> lut{};
+    for (uint32_t m = 0; m < lut.size(); ++m) {
+        uint32_t packed = 0, k = 0;
+        for (uint32_t pass = 0; pass < 2; ++pass) {
+            for (uint32_t j = 0; j < Lanes; ++j) {
+                if ((m >> j & 1) != (pass == 0 ? 1u : 0u)) continue;
+                for (uint32_t s = 0; s < kSub; ++s) packed |= (j * kSub + s) << (4 * k++);
+            }
+        }
+        lut[m] = packed;
+    }
+    return lut;
+}
+
+inline constexpr auto kPartitionLut32 = make_partition_lut<8>();
+inline constexpr auto kPartitionLut64 = make_partition_lut<4>();
+
+using simd_compact::detail::pack_index;
+using simd_compact::detail::lane_mask32;
+
+// 32 位 lane 的公共部分：P 是分区置换后的向量 [lt | 其余]
+// 非精确写入：P 整体写到 left 与 right - W（调用方保证两端各有 W 个空位）
+// 精确写入：left 只写前 nl 个 lane；右端写 P 的 [nl, nl + nr) 到 [right - nr, right)
+template<typename Store, typename MaskStore>
+inline size_t partition_store32(uint32_t lt, uint32_t valid, bool exact, char* left, char* right, size_t elem,
+                                Store store, MaskStore mask_store) {
+    const size_t nl = std::popcount(lt);
+    if (!exact) {
+        store(left);
+        store(right - 8 * elem);
+    } else {
+        const size_t nr = std::popcount(valid) - nl;
+        mask_store(left, lane_mask32(nl));
+        mask_store(right - (nl + nr) * elem, _mm256_andnot_si256(lane_mask32(nl), lane_mask32(nl + nr)));
+    }
+    return nl;
+}
+
+} // namespace detail
+
+template<typename T> struct Avx2Ops;
+
+template<>
+struct Avx2Ops<float> : simd_compact::Avx2Ops<float> {
+    using V = __m256;
+
+    static void store(float* p, V x) { _mm256_storeu_ps(p, x); }
+    static void store_partial(float* p, size_t rem, V x) { _mm256_maskstore_ps(p, detail::lane_mask32(rem), x); }
+    static V load_padded(const float* p, size_t rem, V pad) {
+        return _mm256_blendv_ps(pad, load_partial(p, rem), _mm256_castsi256_ps(detail::lane_mask32(rem)));
+    }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    template<int X> static V permute_xor(V x) {
+        if constexpr (X < 4) return _mm256_permute_ps(x, detail::kXorImm4<X>);
+        else return _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(0 ^ X, 1 ^ X, 2 ^ X, 3 ^ X, 4 ^ X, 5 ^ X, 6 ^ X, 7 ^ X));
+    }
+    template<int B> static V blend_bit(V a, V b) { return _mm256_blend_ps(a, b, detail::kBitLanes<8, B>); }
+    template<bool Exact> static size_t partition_store(V x, uint32_t lt, uint32_t valid, float* left, float* right) {
+        const V p = _mm256_permutevar8x32_ps(x, detail::pack_index(detail::kPartitionLut32[lt]));
+        return detail::partition_store32(lt, valid, Exact, reinterpret_cast<char*>(left), reinterpret_cast<char*>(right),
+            sizeof(float), [&](char* d) { _mm256_storeu_ps(reinterpret_cast<float*>(d), p); },
+            [&](char* d, __m256i m) { _mm256_maskstore_ps(reinterpret_cast<float*>(d), m, p); });
+    }
+};
+
+template<>
+struct Avx2Ops<int32_t> : simd_compact::Avx2Ops<int32_t> {
+    using V = __m256i;
+
+    static void store(int32_t* p, V x) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x); }
+    static void store_partial(int32_t* p, size_t rem, V x) { _mm256_maskstore_epi32(p, detail::lane_mask32(rem), x); }
+    static V load_padded(const int32_t* p, size_t rem, V pad) {
+        return _mm256_blendv_epi8(pad, load_partial(p, rem), detail::lane_mask32(rem));
+    }
+    static V min(V a, V b) { return _mm256_min_epi32(a, b); }
+    static V max(V a, V b) { return _mm256_max_epi32(a, b); }
+    template<int X> static V permute_xor(V x) {
+        if constexpr (X < 4) return _mm256_shuffle_epi32(x, detail::kXorImm4<X>);
+        else return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0 ^ X, 1 ^ X, 2 ^ X, 3 ^ X, 4 ^ X, 5 ^ X, 6 ^ X, 7 ^ X));
+    }
+    template<int B> static V blend_bit(V a, V b) { return _mm256_blend_epi32(a, b, detail::kBitLanes<8, B>); }
+    template<bool Exact> static size_t partition_store(V x, uint32_t lt, uint32_t valid, int32_t* left, int32_t* right) {
+        const V p = _mm256_permutevar8x32_epi32(x, detail::pack_index(detail::kPartitionLut32[lt]));
+        return detail::partition_store32(lt, valid, Exact, reinterpret_cast<char*>(left), reinterpret_cast<char*>(right),
+            sizeof(int32_t), [&](char* d) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), p); },
+            [&](char* d, __m256i m) { _mm256_maskstore_epi32(reinterpret_cast<int*>(d), m, p); });
+    }
+};
+
+// 64 位 lane：4 个 lane 的置换用 permute4x64 立即数，分区表每个 lane 对应两个 32 位下标
+namespace detail {
+
+template<int X>
+constexpr int kXorImm64 = (0 ^ X) | (1 ^ X) << 2 | (2 ^ X) << 4 | (3 ^ X) << 6;
+
+// 64 位 lane 的分区写入与 32 位相同，只是 lt / valid 每一位对应两个 32 位 lane
+inline uint32_t spread64(uint32_t m4) {
+    return (m4 & 1) * 3u | (m4 >> 1 & 1) * 12u | (m4 >> 2 & 1) * 48u | (m4 >> 3 & 1) * 192u;
+}
+
+} // namespace detail
+
+template<>
+struct Avx2Ops<double> : simd_compact::Avx2Ops<double> {
+    using V = __m256d;
+
+    static void store(double* p, V x) { _mm256_storeu_pd(p, x); }
+    static void store_partial(double* p, size_t rem, V x) {
+        _mm256_maskstore_pd(p, simd_compact::detail::lane_mask64(rem), x);
+    }
+    static V load_padded(const double* p, size_t rem, V pad) {
+        return _mm256_blendv_pd(pad, load_partial(p, rem), _mm256_castsi256_pd(simd_compact::detail::lane_mask64(rem)));
+    }
+    static V min(V a, V b) { return _mm256_min_pd(a, b); }
+    static V max(V a, V b) { return _mm256_max_pd(a, b); }
+    template<int X> static V permute_xor(V x) {
+        if constexpr (X == 1) return _mm256_permute_pd(x, 0b0101);
+        else return _mm256_permute4x64_pd(x, detail::kXorImm64<X>);
+    }
+    template<int B> static V blend_bit(V a, V b) { return _mm256_blend_pd(a, b, detail::kBitLanes<4, B>); }
+    template<bool Exact> static size_t partition_store(V x, uint32_t lt, uint32_t valid, double* left, double* right) {
+        const __m256 p = _mm256_permutevar8x32_ps(_mm256_castpd_ps(x), detail::pack_index(detail::kPartitionLut64[lt]));
+        return detail::partition_store32(detail::spread64(lt), detail::spread64(valid), Exact,
+            reinterpret_cast<char*>(left), reinterpret_cast<char*>(right), sizeof(float),
+            [&](char* d) { _mm256_storeu_ps(reinterpret_cast<float*>(d), p); },
+            [&](char* d, __m256i m) { _mm256_maskstore_ps(reinterpret_cast<float*>(d), m, p); }) / 2;
+    }
+};
+
+template<>
+struct Avx2Ops<int64_t> : simd_compact::Avx2Ops<int64_t> {
+    using V = __m256i;
+
+    static void store(int64_t* p, V x) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x); }
+    static void store_partial(int64_t* p, size_t rem, V x) {
+        _mm256_maskstore_epi64(reinterpret_cast<long long*>(p), simd_compact::detail::lane_mask64(rem), x);
+    }
+    static V load_padded(const int64_t* p, size_t rem, V pad) {
+        return _mm256_blendv_epi8(pad, load_partial(p, rem), simd_compact::detail::lane_mask64(rem));
+    }
+    // AVX2 没有 64 位 min / max：cmpgt + blendv
+    static V min(V a, V b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+    static V max(V a, V b) { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+    template<int X> static V permute_xor(V x) {
+        if constexpr (X == 1) return _mm256_shuffle_epi32(x, 0b01001110);
+        else return _mm256_permute4x64_epi64(x, detail::kXorImm64<X>);
+    }
+    template<int B> static V blend_bit(V a, V b) {
+        return _mm256_blend_epi32(a, b, detail::widen_imm(detail::kBitLanes<4, B>));
+    }
+    template<bool Exact> static size_t partition_store(V x, uint32_t lt, uint32_t valid, int64_t* left, int64_t* right) {
+        const V p = _mm256_permutevar8x32_epi32(x, detail::pack_index(detail::kPartitionLut64[lt]));
+        return detail::partition_store32(detail::spread64(lt), detail::spread64(valid), Exact,
+            reinterpret_cast<char*>(left), reinterpret_cast<char*>(right), sizeof(int32_t),
+            [&](char* d) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), p); },
+            [&](char* d, __m256i m) { _mm256_maskstore_epi32(reinterpret_cast<int*>(d), m, p); }) / 2;
+    }
+};
+#endif
+
+#ifdef SORT_HAS_AVX512
+// 分区用寄存器形式的 vcompress + 掩码存储（两端都只写有效元素，Exact 与否相同）
+namespace detail {
+
+using simd_compact::detail::low_bits;
+
+template<size_t W, int X>
+inline __m512i xor_index() {
+    if constexpr (W == 16) {
+        return _mm512_setr_epi32(0 ^ X, 1 ^ X, 2 ^ X, 3 ^ X, 4 ^ X, 5 ^ X, 6 ^ X, 7 ^ X,
+                                 8 ^ X, 9 ^ X, 10 ^ X, 11 ^ X, 12 ^ X, 13 ^ X, 14 ^ X, 15 ^ X);
+    } else {
+        return _mm512_setr_epi64(0 ^ X, 1 ^ X, 2 ^ X, 3 ^ X, 4 ^ X, 5 ^ X, 6 ^ X, 7 ^ X);
+    }
+}
+
+} // namespace detail
+
+template<typename T> struct Avx512Ops;
+
+template<>
+struct Avx512Ops<float> : simd_compact::Avx512Ops<float> {
+    using V = __m512;
+
+    static void store(float* p, V x) { _mm512_storeu_ps(p, x); }
+    static void store_partial(float* p, size_t rem, V x) { _mm512_mask_storeu_ps(p, detail::low_bits(rem), x); }
+    static V load_padded(const float* p, size_t rem, V pad) { return _mm512_mask_loadu_ps(pad, detail::low_bits(rem), p); }
+    static V min(V a, V b) { return _mm512_min_ps(a, b); }
+    static V max(V a, V b) { return _mm512_max_ps(a, b); }
+    template<int X> static V permute_xor(V x) {
+        if constexpr (X < 4) return _mm512_permute_ps(x, detail::kXorImm4<X>);
+        else return _mm512_permutexvar_ps(detail::xor_index<16, X>(), x);
+    }
+    template<int B> static V blend_bit(V a, V b) { return _mm512_mask_blend_ps(detail::kBitLanes<16, B>, a, b); }
+    template<bool Exact> static size_t partition_store(V x, uint32_t lt, uint32_t valid, float* left, float* right) {
+        const uint32_t ge = valid & ~lt;
+        const size_t nl = std::popcount(lt), nr = std::popcount(ge);
+        _mm512_mask_storeu_ps(left, detail::low_bits(nl), _mm512_maskz_compress_ps(lt, x));
+        _mm512_mask_storeu_ps(right - nr, detail::low_bits(nr), _mm512_maskz_compress_ps(ge, x));
+        return nl;
+    }
+};
+
+template<>
+struct Avx512Ops<int32_t> : simd_compact::Avx512Ops<int32_t> {
+    using V = __m512i;
+
+    static void store(int32_t* p, V x) { _mm512_storeu_si512(p, x); }
+    static void store_partial(int32_t* p, size_t rem, V x) { _mm512_mask_storeu_epi32(p, detail::low_bits(rem), x); }
+    static V load_padded(const int32_t* p, size_t rem, V pad) {
+        return _mm512_mask_loadu_epi32(pad, detail::low_bits(rem), p);
+    }
+    static V min(V a, V b) { return _mm512_min_epi32(a, b); }
+    static V max(V a, V b) { return _mm512_max_epi32(a, b); }
+    template<int X> static V permute_xor(V x) {
+        if constexpr (X < 4) return _mm512_shuffle_epi32(x, static_cast<_MM_PERM_ENUM>(detail::kXorImm4<X>));
+        else return _mm512_permutexvar_epi32(detail::xor_index<16, X>(), x);
+    }
+    template<int B> static V blend_bit(V a, V b) { return _mm512_mask_blend_epi32(detail::kBitLanes<16, B>, a, b); }
+    template<bool Exact> static size_t partition_store(V x, uint32_t lt, uint32_t valid, int32_t* left, int32_t* right) {
+        const uint32_t ge = valid & ~lt;
+        const size_t nl = std::popcount(lt), nr = std::popcount(ge);
+        _mm512_mask_storeu_epi32(left, detail::low_bits(nl), _mm512_maskz_compress_epi32(lt, x));
+        _mm512_mask_storeu_epi32(right - nr, detail::low_bits(nr), _mm512_maskz_compress_epi32(ge, x));
+        return nl;
+    }
+};
+
+template<>
+struct Avx512Ops<double> : simd_compact::Avx512Ops<double> {
+    using V = __m512d;
+
+    static void store(double* p, V x) { _mm512_storeu_pd(p, x); }
+    static void store_partial(double* p, size_t rem, V x) { _mm512_mask_storeu_pd(p, detail::low_bits(rem), x); }
+    static V load_padded(const double* p, size_t rem, V pad) { return _mm512_mask_loadu_pd(pad, detail::low_bits(rem), p); }
+    static V min(V a, V b) { return _mm512_min_pd(a, b); }
+    static V max(V a, V b) { return _mm512_max_pd(a, b); }
+    template<int X> static V permute_xor(V x) {
+        if constexpr (X == 1) return _mm512_permute_pd(x, 0x55);
+        else if constexpr (X < 4) return _mm512_permutex_pd(x, detail::kXorImm64<X>);
+        else return _mm512_permutexvar_pd(detail::xor_index<8, X>(), x);
+    }
+    template<int B> static V blend_bit(V a, V b) { return _mm512_mask_blend_pd(detail::kBitLanes<8, B>, a, b); }
+    template<bool Exact> static size_t partition_store(V x, uint32_t lt, uint32_t valid, double* left, double* right) {
+        const uint32_t ge = valid & ~lt;
+        const size_t nl = std::popcount(lt), nr = std::popcount(ge);
+        _mm512_mask_storeu_pd(left, detail::low_bits(nl), _mm512_maskz_compress_pd(lt, x));
+        _mm512_mask_storeu_pd(right - nr, detail::low_bits(nr), _mm512_maskz_compress_pd(ge, x));
+        return nl;
+    }
+};
+
+template<>
+struct Avx512Ops<int64_t> : simd_compact::Avx512Ops<int64_t> {
+    using V = __m512i;
+
+    static void store(int64_t* p, V x) { _mm512_storeu_si512(p, x); }
+    static void store_partial(int64_t* p, size_t rem, V x) { _mm512_mask_storeu_epi64(p, detail::low_bits(rem), x); }
+    static V load_padded(const int64_t* p, size_t rem, V pad) {
+        return _mm512_mask_loadu_epi64(pad, detail::low_bits(rem), p);
+    }
+    static V min(V a, V b) { return _mm512_min_epi64(a, b); }
+    static V max(V a, V b) { return _mm512_max_epi64(a, b); }
+    template<int X> static V permute_xor(V x) {
+        if constexpr (X < 4) return _mm512_permutex_epi64(x, detail::kXorImm64<X>);
+        else return _mm512_permutexvar_epi64(detail::xor_index<8, X>(), x);
+    }
+    template<int B> static V blend_bit(V a, V b) { return _mm512_mask_blend_epi64(detail::kBitLanes<8, B>, a, b); }
+    template<bool Exact> static size_t partition_store(V x, uint32_t lt, uint32_t valid, int64_t* left, int64_t* right) {
+        const uint32_t ge = valid & ~lt;
+        const size_t nl = std::popcount(lt), nr = std::popcount(ge);
+        _mm512_mask_storeu_epi64(left, detail::low_bits(nl), _mm512_maskz_compress_epi64(lt, x));
+        _mm512_mask_storeu_epi64(right - nr, detail::low_bits(nr), _mm512_maskz_compress_epi64(ge, x));
+        return nl;
+    }
+};
+#endif
+
+// 编译期可用的最宽 ISA
+#if defined(SORT_HAS_AVX512)
+template<typename T> using BestOps = Avx512Ops<T>;
+#elif defined(SORT_HAS_AVX2)
+template<typename T> using BestOps = Avx2Ops<T>;
+#else
+template<typename T> using BestOps = ScalarOps<T>;
+#endif
+
+// ============================================================================
+// Part 2: 双调排序网络
+// ============================================================================
+
+namespace detail {
+
+// 把 M 个向量看成 N = M * W 个元素的序列（第 q 个向量的 lane l 是位置 q * W + l）。
+// 合并阶段 K = 2, 4, ..., N：先做"翻转"比较 i ↔ i ^ (K - 1)，再做 i ↔ i ^ J（J = K/4, ..., 1），
+// 每次较小值留在较低位置。这种写法所有比较方向相同，不需要按位置选择升序 / 降序
+template<typename Ops, size_t M>
+struct Network {
+    using V = typename Ops::V;
+    static constexpr size_t W = Ops::W;
+    static constexpr size_t N = M * W;
+
+    // 向量内 i ↔ i ^ X，(i & B) == 0 的 lane 是较低位置
+    template<int X, int B>
+    static V exchange(V x) {
+        const V y = Ops::template permute_xor<X>(x);
+        return Ops::template blend_bit<B>(Ops::min(x, y), Ops::max(x, y));
+    }
+
+    // 位置距离 J 的半清洗器（J 为 2 的幂）
+    template<size_t J>
+    static void half_cleaner(V (&v)[M]) {
+        if constexpr (J >= W) {
+            constexpr size_t D = J / W;
+            for (size_t q = 0; q < M; ++q) {
+                if (q & D) continue;
+                const V lo = Ops::min(v[q], v[q + D]);
+                v[q + D] = Ops::max(v[q], v[q + D]);
+                v[q] = lo;
+            }
+        } else {
+            for (size_t q = 0; q < M; ++q) v[q] = exchange<static_cast<int>(J), static_cast<int>(J)>(v[q]);
+        }
+        if constexpr (J > 1) half_cleaner<J / 2>(v);
+    }
+
+    // 合并阶段 K：翻转比较 i ↔ i ^ (K - 1)，之后半清洗器 K/4, ..., 1
+    template<size_t K>
+    static void merge_phase(V (&v)[M]) {
+        if constexpr (K > W) {
+            // 向量 q 与 q ^ (K/W - 1) 比较，后者 lane 反转
+            constexpr size_t D = K / W - 1;
+            for (size_t q = 0; q < M; ++q) {
+                const size_t p = q ^ D;
+                if (p < q) continue;
+                const V rev = Ops::template permute_xor<static_cast<int>(W - 1)>(v[p]);
+                const V lo = Ops::min(v[q], rev);
+                v[p] = Ops::template permute_xor<static_cast<int>(W - 1)>(Ops::max(v[q], rev));
+                v[q] = lo;
+            }
+        } else {
+            for (size_t q = 0; q < M; ++q) {
+                v[q] = exchange<static_cast<int>(K - 1), static_cast<int>(K / 2)>(v[q]);
+            }
+        }
+        if constexpr (K >= 4) half_cleaner<K / 4>(v);
+        if constexpr (K < N) merge_phase<K * 2>(v);
+    }
+
+    static void sort(V (&v)[M]) {
+        if constexpr (N > 1) merge_phase<2>(v);
+    }
+};
+
+// 排序后的填充值：浮点为 +inf（NaN 已提前移走），整数为最大值
+template<typename T>
+constexpr T kPad = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                        : std::numeric_limits<T>::max();
+
+// n <= M * W 个元素：不足的 lane 用 kPad 填充，排序后只写回前 n 个
+template<typename Ops, size_t M, typename T>
+inline void sort_block(T* a, size_t n) {
+    constexpr size_t W = Ops::W;
+    using V = typename Ops::V;
+    const V pad = Ops::set1(kPad<T>);
+    V v[M];
+    for (size_t q = 0; q < M; ++q) {
+        const size_t off = q * W;
+        v[q] = off + W <= n ? Ops::load(a + off) : off < n ? Ops::load_padded(a + off, n - off, pad) : pad;
+    }
+    Network<Ops, M>::sort(v);
+    for (size_t q = 0; q < M && q * W < n; ++q) {
+        const size_t off = q * W;
+        if (off + W <= n) Ops::store(a + off, v[q]);
+        else Ops::store_partial(a + off, n - off, v[q]);
+    }
+}
+
+// 排序网络处理的最大块：8 个向量
+inline constexpr size_t kNetworkVectors = 8;
+
+template<typename Ops, typename T>
+inline void small_sort(T* a, size_t n) {
+    constexpr size_t W = Ops::W;
+    if (n <= W) sort_block<Ops, 1>(a, n);
+    else if (n <= 2 * W) sort_block<Ops, 2>(a, n);
+    else if (n <= 4 * W) sort_block<Ops, 4>(a, n);
+    else sort_block<Ops, 8>(a, n);
+}
+
+// ============================================================================
+// Part 3: 向量化分区与快速排序
+// ============================================================================
+
+// 原地分区（n >= 2W）：OrEqual = false 时 [0, mid) < pivot <= [mid, n)；true 时 [0, mid) <= pivot < [mid, n)
+// 两端各先读入一个向量，腾出 2W 个空位；每轮从空位较少的一端读一个向量，读之后两端空位都 >= W，
+// 因此主循环可以整向量写入而不覆盖未读数据。最后剩下 < W 个元素与两个缓存向量，用精确写入收尾
+template<bool OrEqual, typename Ops, typename T>
+inline size_t partition(T* a, size_t n, T pivot) {
+    using V = typename Ops::V;
+    constexpr size_t W = Ops::W;
+    constexpr simd_compact::Cmp C = OrEqual ? simd_compact::Cmp::Le : simd_compact::Cmp::Lt;
+    constexpr uint32_t kAll = static_cast<uint32_t>((uint64_t{ 1 } << W) - 1);
+
+    const V p = Ops::set1(pivot);
+    const V first = Ops::load(a), last = Ops::load(a + n - W);
+    T* left = a;
+    T* right = a + n;
+    const T* lread = a + W;
+    const T* rread = a + n - W;
+
+    auto put = [&]<bool Exact>(V x, uint32_t valid) {
+        const uint32_t lt = Ops::template mask<C>(x, p) & valid;
+        const size_t nl = Ops::template partition_store<Exact>(x, lt, valid, left, right);
+        left += nl;
+        right -= std::popcount(valid) - nl;
+    };
+
+    while (static_cast<size_t>(rread - lread) >= W) {
+        V x;
+        if (lread - left <= right - rread) {
+            x = Ops::load(lread);
+            lread += W;
+        } else {
+            rread -= W;
+            x = Ops::load(rread);
+        }
+        put.template operator()<false>(x, kAll);
+    }
+    if (const size_t rem = rread - lread; rem > 0) {
+        put.template operator()<true>(Ops::load_partial(lread, rem), kAll >> (W - rem));
+    }
+    put.template operator()<true>(first, kAll);
+    put.template operator()<true>(last, kAll);
+    return left - a;
+}
+
+// 16 个等距样本排序后取中位数
+template<typename Ops, typename T>
+inline T choose_pivot(const T* a, size_t n) {
+    constexpr size_t W = Ops::W;
+    constexpr size_t S = 16, M = S / W > 0 ? S / W : 1;
+    alignas(64) T sample[M * W];
+    for (size_t i = 0; i < M * W; ++i) sample[i] = a[(2 * i + 1) * n / (2 * M * W)];
+    sort_block<Ops, M>(sample, M * W);
+    return sample[M * W / 2];
+}
+
+template<typename Ops, typename T>
+inline void quicksort(T* a, size_t n, int depth) {
+    constexpr size_t kSmall = kNetworkVectors * Ops::W;
+    while (n > kSmall) {
+        if (depth-- == 0) {
+            std::sort(a, a + n);
+            return;
+        }
+        const T pivot = choose_pivot<Ops>(a, n);
+        size_t mid = partition<false, Ops>(a, n, pivot);
+        if (mid == 0) {
+            // pivot 是最小值：把等于 pivot 的元素剥离到左端，它们已经就位
+            mid = partition<true, Ops>(a, n, pivot);
+            a += mid;
+            n -= mid;
+            continue;
+        }
+        // 递归处理较小的一侧，较大的一侧继续循环，栈深度 O(log n)
+        if (mid < n - mid) {
+            quicksort<Ops>(a, mid, depth);
+            a += mid;
+            n -= mid;
+        } else {
+            quicksort<Ops>(a + mid, n - mid, depth);
+            n = mid;
+        }
+    }
+    if (n > 1) small_sort<Ops>(a, n);
+}
+
+} // namespace detail
+
+// ============================================================================
+// Part 4: 公共接口
+// ============================================================================
+
+// 升序排序 float / double / int32_t / int64_t；浮点的 NaN 放在末尾
+template<template<typename> class Ops = BestOps, typename T>
+inline void sort(T* a, size_t n) {
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double> ||
+                  std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>,
+                  "simd_sort::sort supports float, double, int32_t and int64_t");
+    if constexpr (Ops<T>::W == 1) {
+        std::sort(a, a + n, [](T x, T y) { return x < y || (x == x && y != y); });
+    } else {
+        if constexpr (std::is_floating_point_v<T>) {
+            n = std::partition(a, a + n, [](T x) { return x == x; }) - a;
+        }
+        // 已有序 / 逆序的输入 O(n) 处理；随机输入在前几个元素处就会退出检查
+        if (std::is_sorted(a, a + n)) return;
+        if (std::is_sorted(a, a + n, std::greater<T>())) {
+            std::reverse(a, a + n);
+            return;
+        }
+        detail::quicksort<Ops<T>>(a, n, 2 * std::bit_width(n));
+    }
+}
+
+namespace detail {
+
+// 32 位键映射为保序的 int32：有符号整数不变；无符号整数翻转符号位；
+// 浮点数负数取反全部位、非负数翻转符号位（-0.0 排在 +0.0 之前，正 NaN 在最后、负 NaN 在最前）
+template<typename K>
+inline int32_t key_to_ordered(K k) {
+    if constexpr (std::is_same_v<K, int32_t>) {
+        return k;
+    } else if constexpr (std::is_same_v<K, uint32_t>) {
+        return static_cast<int32_t>(k ^ 0x80000000u);
+    } else {
+        uint32_t u;
+        std::memcpy(&u, &k, sizeof u);
+        u = (u & 0x80000000u) ? ~u : u | 0x80000000u;
+        return static_cast<int32_t>(u ^ 0x80000000u);
+    }
+}
+
+template<typename K>
+inline K ordered_to_key(int32_t o) {
+    if constexpr (std::is_same_v<K, int32_t>) {
+        return o;
+    } else if constexpr (std::is_same_v<K, uint32_t>) {
+        return static_cast<uint32_t>(o) ^ 0x80000000u;
+    } else {
+        uint32_t u = static_cast<uint32_t>(o) ^ 0x80000000u;
+        u = (u & 0x80000000u) ? u & 0x7FFFFFFFu : ~u;
+        K k;
+        std::memcpy(&k, &u, sizeof k);
+        return k;
+    }
+}
+
+} // namespace detail
+
+// 键值对排序：keys 升序，values 随键移动；键相同时按值升序（结果确定，但不是稳定排序）
+// 键为 float / int32_t / uint32_t，值为 uint32_t（常见用法是下标，即 argsort）
+// 实现：打包成 (有序键 << 32) | 值 的 int64 后调用 int64 内核，额外占用 8n 字节
+template<template<typename> class Ops = BestOps, typename K>
+inline void sort_pairs(K* keys, uint32_t* values, size_t n) {
+    static_assert(std::is_same_v<K, float> || std::is_same_v<K, int32_t> || std::is_same_v<K, uint32_t>,
+                  "simd_sort::sort_pairs supports float, int32_t and uint32_t keys");
+    std::vector<int64_t> packed(n);
+    for (size_t i = 0; i < n; ++i) {
+        packed[i] = static_cast<int64_t>(static_cast<uint64_t>(static_cast<uint32_t>(detail::key_to_ordered(keys[i]))) << 32
+                                         | values[i]);
+    }
+    sort<Ops>(packed.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = detail::ordered_to_key<K>(static_cast<int32_t>(static_cast<uint64_t>(packed[i]) >> 32));
+        values[i] = static_cast<uint32_t>(packed[i]);
+    }
+}
+
+} // namespace simd_sort
@@ -0,0 +1,207 @@
+// streaming.hpp
+// 访存受限内核的非临时（streaming）存储与软件预取：c = a + b、r = a * b + c
+//
+// 1. 普通存储要先把目标缓存行读进来（RFO，read for ownership）再改写：
+//    每写 1 字节实际要搬 2 字节，并且写出的数据把 LLC 里其他有用的行挤掉。
+//    vmovntps（_mm256_stream_ps / _mm512_stream_ps）经写合并缓冲区直接写内存，
+//    没有 RFO，也不占缓存
+// 2. 代价：写出的数据不在缓存中，紧接着读它的代码要回到内存取；数组能放进 LLC 时
+//    普通存储更快。Store::Auto 在工作集（输入 + 输出）超过 LLC 的 3/4 时
+//    才改用 streaming 存储，阈值与 glibc memcpy 的 non_temporal_threshold 同一量级
+// 3. 软件预取：每个缓存行发一次 prefetcht0，提前 PrefetchBytes 字节；
+//    顺序访问时硬件预取器通常已经足够，收益需要用 streaming_benchmark.cpp 实测
+// 4. streaming 存储是弱序的：函数返回前 sfence，保证其他线程 / 之后的普通存储
+//    看到的顺序正确（之后由另一个线程读取结果时尤其重要）
+//
+// 只处理 float；目标地址先用掩码存储对齐到向量宽度（vmovntps 要求对齐）
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <unistd.h>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include "simd_intrin.hpp"
+#define STREAM_HAS_AVX2
+#ifdef __AVX512F__
+#define STREAM_HAS_AVX512
+#endif
+#endif
+
+namespace simd_stream {
+
+// ============================================================================
+// Part 1: 存储策略与 LLC 阈值
+// ============================================================================
+
+enum class Store { Regular, Stream, Auto };
+
+inline const char* store_name(Store s) {
+    switch (s) {
+    case Store::Regular: return "regular";
+    case Store::Stream: return "stream";
+    case Store::Auto: return "auto";
+    }
+    return "?";
+}
+
+// 末级缓存大小（字节）：glibc 的 sysconf，取不到时按 8 MB 估计
+inline size_t llc_bytes() {
+    static const size_t bytes = []() -> size_t {
+        for (int name : { _SC_LEVEL3_CACHE_SIZE, _SC_LEVEL2_CACHE_SIZE }) {
+            const long v = sysconf(name);
+            if (v > 0) return static_cast<size_t>(v);
+        }
+        return size_t{ 8 } << 20;
+    }();
+    return bytes;
+}
+
+// 工作集超过该字节数时 Store::Auto 使用 streaming 存储，默认 LLC 的 3/4。
+// 服务器 / 虚拟机上 sysconf 报告的是整个插槽共享的 LLC（几十到几百 MB），单核实际能用的
+// 远小于它；这时用 streaming_benchmark.cpp 测出的交叉点调用 set_stream_threshold_bytes
+namespace detail {
+inline size_t& stream_threshold() {
+    static size_t bytes = llc_bytes() / 4 * 3;
+    return bytes;
+}
+} // namespace detail
+
+inline size_t stream_threshold_bytes() { return detail::stream_threshold(); }
+inline void set_stream_threshold_bytes(size_t bytes) { detail::stream_threshold() = bytes; }
+
+// ============================================================================
+// Part 2: ISA 描述
+// ============================================================================
+
+#ifdef STREAM_HAS_AVX2
+struct Avx2Ops {
+    static constexpr const char* name = "AVX2";
+    using V = __m256;
+    using M = __m256i;
+    static constexpr size_t W = 8;
+
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V a) { _mm256_storeu_ps(p, a); }
+    static void stream(float* p, V a) { _mm256_stream_ps(p, a); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+
+    // 前 k 个 lane 的 maskload / maskstore 掩码（0 < k < 8），滑动窗口取法同 simd_complete_guide.cpp
+    static M mask(size_t k) {
+        alignas(64) static constexpr int32_t table[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(table + 8 - k));
+    }
+    static V load_partial(const float* p, M m) { return _mm256_maskload_ps(p, m); }
+    static void store_partial(float* p, M m, V a) { _mm256_maskstore_ps(p, m, a); }
+};
+#endif
+
+#ifdef STREAM_HAS_AVX512
+struct Avx512Ops {
+    static constexpr const char* name = "AVX-512";
+    using V = __m512;
+    using M = __mmask16;
+    static constexpr size_t W = 16;
+
+    static V load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, V a) { _mm512_storeu_ps(p, a); }
+    static void stream(float* p, V a) { _mm512_stream_ps(p, a); }
+    static V add(V a, V b) { return _mm512_add_ps(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+
+    static M mask(size_t k) { return static_cast<__mmask16>((1u << k) - 1); }
+    static V load_partial(const float* p, M m) { return _mm512_maskz_loadu_ps(m, p); }
+    static void store_partial(float* p, M m, V a) { _mm512_mask_storeu_ps(p, m, a); }
+};
+#endif
+
+// ============================================================================
+// Part 3: 内核
+// ============================================================================
+
+#ifdef STREAM_HAS_AVX2
+namespace detail {
+
+inline constexpr size_t kLine = 64;
+
+// out[i] = f(in[0][i], ..., in[K-1][i])
+// 主循环每次处理一个缓存行（64 字节）的输出，并对每个输入预取 PrefetchBytes 之后的行
+template<Store S, size_t PrefetchBytes, typename Ops, size_t K, typename F>
+inline void map(float* out, const float* const (&in)[K], size_t n, F f) {
+    using V = typename Ops::V;
+    constexpr size_t W = Ops::W;
+    constexpr size_t VB = W * sizeof(float);
+    constexpr size_t U = kLine / VB;  // 每个缓存行的向量数
+
+    bool stream = S == Store::Stream ||
+                  (S == Store::Auto && (K + 1) * n * sizeof(float) > stream_threshold_bytes());
+
+    auto apply = [&]<size_t... J>(size_t i, std::index_sequence<J...>, auto load) { return f(load(in[J] + i)...); };
+    auto compute = [&](size_t i) {
+        return apply(i, std::make_index_sequence<K>{}, [](const float* p) { return Ops::load(p); });
+    };
+    auto compute_partial = [&](size_t i, typename Ops::M m) {
+        return apply(i, std::make_index_sequence<K>{}, [&](const float* p) { return Ops::load_partial(p, m); });
+    };
+
+    size_t i = 0;
+    if (stream) {
+        // vmovntps 要求目标按向量宽度对齐：先用一次掩码存储补齐到对齐边界；
+        // out 本身不是 4 字节对齐时无法对齐，退回普通存储
+        const uintptr_t addr = reinterpret_cast<uintptr_t>(out);
+        stream = addr % sizeof(float) == 0;
+        const size_t head = std::min(n, (VB - addr % VB) % VB / sizeof(float));
+        if (stream && head > 0) {
+            Ops::store_partial(out, Ops::mask(head), compute_partial(0, Ops::mask(head)));
+            i = head;
+        }
+    }
+
+    auto loop = [&](auto put) {
+        for (; i + U * W <= n; i += U * W) {
+            if constexpr (PrefetchBytes > 0) {
+                for (size_t k = 0; k < K; ++k) {
+                    _mm_prefetch(reinterpret_cast<const char*>(in[k] + i) + PrefetchBytes, _MM_HINT_T0);
+                }
+            }
+            for (size_t u = 0; u < U; ++u) put(out + i + u * W, compute(i + u * W));
+        }
+        for (; i + W <= n; i += W) put(out + i, compute(i));
+    };
+    if (stream) {
+        loop([](float* p, V x) { Ops::stream(p, x); });
+        // streaming 存储是弱序的：之后的存储（以及其他线程对结果的读取）必须排在它们之后
+        _mm_sfence();
+    } else {
+        loop([](float* p, V x) { Ops::store(p, x); });
+    }
+
+    if (i < n) Ops::store_partial(out + i, Ops::mask(n - i), compute_partial(i, Ops::mask(n - i)));
+}
+
+} // namespace detail
+
+#ifdef STREAM_HAS_AVX512
+using BestOps = Avx512Ops;
+#else
+using BestOps = Avx2Ops;
+#endif
+
+// c = a + b
+template<Store S = Store::Auto, size_t PrefetchBytes = 0, typename Ops = BestOps>
+inline void add(const float* a, const float* b, float* c, size_t n) {
+    detail::map<S, PrefetchBytes, Ops>(c, { a, b }, n, [](auto x, auto y) { return Ops::add(x, y); });
+}
+
+// r = a * b + c
+template<Store S = Store::Auto, size_t PrefetchBytes = 0, typename Ops = BestOps>
+inline void fma(const float* a, const float* b, const float* c, float* r, size_t n) {
+    detail::map<S, PrefetchBytes, Ops>(r, { a, b, c }, n, [](auto x, auto y, auto z) { return Ops::fmadd(x, y, z); });
+}
+#endif
+
+} // namespace simd_stream
@@ -0,0 +1,274 @@
+// streaming_benchmark.cpp
+// streaming.hpp 的正确性与性能测试
+// 1. 正确性：n = 0..200、输出地址偏移 0..15 个 float，所有变体与标量结果逐位比较
+// 2. 交叉点：工作集 48 KB - 768 MB，普通存储 vs streaming 存储，找出 streaming 开始占优的大小
+// 3. 预取距离：工作集远大于 LLC 时扫描 0 - 4 KB 的预取距离
+// 带宽按 (输入数 + 1) * 4 字节 / 元素计算，不含普通存储的 RFO 流量
+//
+// 用法: ./streaming [--max-mb N]    工作集上限（默认 768 MB，需要同样大小的内存）
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "streaming.hpp"
+
+namespace st = simd_stream;
+using st::Store;
+
+#ifndef STREAM_HAS_AVX2
+int main() {
+    std::cout << "streaming_benchmark requires AVX2 + FMA (-mavx2 -mfma or -march=native)\n";
+    return 0;
+}
+#else
+
+// ============================================================================
+// 性能测试框架
+// ============================================================================
+
+// 每轮至少跑 ~20 ms，5 轮取最小值，返回单次调用的秒数
+template<typename Func>
+double best_seconds(Func func, size_t bytes) {
+    const int reps = static_cast<int>(std::clamp<size_t>((size_t{ 200 } << 20) / std::max<size_t>(bytes, 1), 1, 10000));
+    func();
+    double best = 1e300;
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            func();
+            asm volatile("" : : : "memory");
+        }
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count() / reps);
+    }
+    return best;
+}
+
+std::string bytes_label(size_t bytes) {
+    if (bytes >= (size_t{ 1 } << 20)) return std::to_string(bytes >> 20) + " MB";
+    return std::to_string(bytes >> 10) + " KB";
+}
+
+// 两个内核：K 为输入个数
+struct AddKernel {
+    static constexpr const char* name = "add: c = a + b";
+    static constexpr size_t K = 2;
+    template<Store S, size_t P, typename Ops>
+    static void run(const std::vector<float>* in, float* out, size_t n) {
+        st::add<S, P, Ops>(in[0].data(), in[1].data(), out, n);
+    }
+    static float scalar(const std::vector<float>* in, size_t i) { return in[0][i] + in[1][i]; }
+};
+
+struct FmaKernel {
+    static constexpr const char* name = "fma: r = a * b + c";
+    static constexpr size_t K = 3;
+    template<Store S, size_t P, typename Ops>
+    static void run(const std::vector<float>* in, float* out, size_t n) {
+        st::fma<S, P, Ops>(in[0].data(), in[1].data(), in[2].data(), out, n);
+    }
+    static float scalar(const std::vector<float>* in, size_t i) { return std::fma(in[0][i], in[1][i], in[2][i]); }
+};
+
+// ============================================================================
+// Part 1: 正确性
+// ============================================================================
+
+// 输出缓冲区预先填哨兵值：越界写、漏写、未对齐时的头部 / 尾部处理错误都会被发现
+template<typename Kernel>
+bool check(const std::vector<float>* in) {
+    constexpr size_t kMaxN = 200, kMaxOffset = 16;
+    std::vector<float> ref(kMaxN + kMaxOffset + 16), out(ref.size());
+    bool ok = true;
+    auto variant = [&]<Store S, typename Ops>() {
+        for (size_t off = 0; off < kMaxOffset; ++off) {
+            for (size_t n = 0; n <= kMaxN; ++n) {
+                std::fill(ref.begin(), ref.end(), -7.0f);
+                std::fill(out.begin(), out.end(), -7.0f);
+                for (size_t i = 0; i < n; ++i) ref[off + i] = Kernel::scalar(in, i);
+                Kernel::template run<S, 256, Ops>(in, out.data() + off, n);
+                ok = ok && std::memcmp(ref.data(), out.data(), ref.size() * sizeof(float)) == 0;
+            }
+        }
+    };
+    variant.template operator()<Store::Regular, st::Avx2Ops>();
+    variant.template operator()<Store::Stream, st::Avx2Ops>();
+#ifdef STREAM_HAS_AVX512
+    variant.template operator()<Store::Regular, st::Avx512Ops>();
+    variant.template operator()<Store::Stream, st::Avx512Ops>();
+#endif
+    return ok;
+}
+
+// ============================================================================
+// Part 2: 交叉点扫描
+// ============================================================================
+
+// 返回 streaming 存储持续快于普通存储的最小工作集（字节），没有则返回 0
+template<typename Kernel>
+size_t crossover_sweep(std::vector<float>* in, std::vector<float>& out, size_t max_bytes, bool& ok) {
+    constexpr size_t K = Kernel::K;
+    std::cout << Kernel::name << " (GB/s, working set = " << K + 1 << " arrays)\n";
+    std::cout << "------------------------------------------------\n";
+    std::cout << std::left << std::setw(11) << "working set" << std::right
+              << std::setw(14) << "AVX2 regular" << std::setw(13) << "AVX2 stream";
+#ifdef STREAM_HAS_AVX512
+    std::cout << std::setw(14) << "512 regular" << std::setw(13) << "512 stream";
+#endif
+    std::cout << std::setw(12) << "auto" << std::setw(10) << "picks" << "\n";
+
+    size_t crossover = 0;
+    std::vector<float> ref(out.size());
+    for (size_t bytes = size_t{ 48 } << 10; bytes <= max_bytes; bytes *= 4) {
+        const size_t n = bytes / ((K + 1) * sizeof(float));
+        const size_t moved = (K + 1) * n * sizeof(float);
+        Kernel::template run<Store::Regular, 0, st::BestOps>(in, ref.data(), n);
+
+        std::vector<double> gbs;
+        double regular_best = 0.0, stream_best = 0.0;
+        auto measure = [&]<Store S, typename Ops>() {
+            const double sec = best_seconds([&]() { Kernel::template run<S, 0, Ops>(in, out.data(), n); }, moved);
+            ok = ok && std::memcmp(ref.data(), out.data(), n * sizeof(float)) == 0;
+            gbs.push_back(moved / sec / 1e9);
+            if (S == Store::Regular) regular_best = std::max(regular_best, gbs.back());
+            if (S == Store::Stream) stream_best = std::max(stream_best, gbs.back());
+        };
+        measure.template operator()<Store::Regular, st::Avx2Ops>();
+        measure.template operator()<Store::Stream, st::Avx2Ops>();
+#ifdef STREAM_HAS_AVX512
+        measure.template operator()<Store::Regular, st::Avx512Ops>();
+        measure.template operator()<Store::Stream, st::Avx512Ops>();
+#endif
+        measure.template operator()<Store::Auto, st::BestOps>();
+
+        const bool auto_streams = moved > st::stream_threshold_bytes();
+        std::cout << std::left << std::setw(11) << bytes_label(moved) << std::right << std::fixed << std::setprecision(1);
+        std::cout << std::setw(14) << gbs[0] << std::setw(13) << gbs[1];
+#ifdef STREAM_HAS_AVX512
+        std::cout << std::setw(14) << gbs[2] << std::setw(13) << gbs[3];
+#endif
+        std::cout << std::setw(12) << gbs.back() << std::setw(10) << (auto_streams ? "stream" : "regular") << "\n";
+
+        if (stream_best > regular_best * 1.05) {
+            if (crossover == 0) crossover = moved;
+        } else {
+            crossover = 0;
+        }
+    }
+    std::cout << "\n";
+    return crossover;
+}
+
+// ============================================================================
+// Part 3: 预取距离
+// ============================================================================
+
+template<typename Kernel, Store S, size_t... P>
+void prefetch_row(std::vector<float>* in, std::vector<float>& out, size_t n, size_t moved) {
+    std::cout << std::left << std::setw(10) << st::store_name(S) << std::right << std::fixed << std::setprecision(1);
+    ((std::cout << std::setw(9) << moved / best_seconds([&]() {
+                      Kernel::template run<S, P, st::BestOps>(in, out.data(), n);
+                  }, moved) / 1e9), ...);
+    std::cout << "\n";
+}
+
+template<typename Kernel>
+void prefetch_sweep(std::vector<float>* in, std::vector<float>& out, size_t bytes) {
+    constexpr size_t K = Kernel::K;
+    const size_t n = bytes / ((K + 1) * sizeof(float));
+    const size_t moved = (K + 1) * n * sizeof(float);
+    std::cout << Kernel::name << ", " << st::BestOps::name << ", working set " << bytes_label(moved)
+              << " (GB/s by prefetch distance)\n";
+    std::cout << "------------------------------------------------\n";
+    std::cout << std::left << std::setw(10) << "store" << std::right;
+    for (const char* d : { "none", "128 B", "256 B", "512 B", "1 KB", "2 KB", "4 KB" }) std::cout << std::setw(9) << d;
+    std::cout << "\n";
+    prefetch_row<Kernel, Store::Regular, 0, 128, 256, 512, 1024, 2048, 4096>(in, out, n, moved);
+    prefetch_row<Kernel, Store::Stream, 0, 128, 256, 512, 1024, 2048, 4096>(in, out, n, moved);
+    std::cout << "\n";
+}
+
+// ============================================================================
+// 主程序
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    size_t max_bytes = size_t{ 768 } << 20;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-mb" && i + 1 < argc) {
+            max_bytes = std::stoull(argv[++i]) << 20;
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--max-mb N]\n";
+            return 2;
+        }
+    }
+
+    std::cout << "================================================\n";
+    std::cout << "  Non-temporal Stores and Software Prefetch\n";
+    std::cout << "================================================\n";
+    std::cout << "LLC: " << bytes_label(st::llc_bytes()) << ", auto threshold: working set > "
+              << bytes_label(st::stream_threshold_bytes()) << "\n\n";
+
+    // 最大工作集按 add 的 3 个数组计算；fma 用同样的数组，工作集是 4 / 3 倍
+    const size_t max_n = max_bytes / (3 * sizeof(float));
+    std::vector<float> in[3] = { std::vector<float>(max_n), std::vector<float>(max_n), std::vector<float>(max_n) };
+    std::vector<float> out(max_n);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    for (auto& v : in) for (auto& x : v) x = dist(rng);
+
+    bool ok = check<AddKernel>(in) && check<FmaKernel>(in);
+    std::cout << (ok ? "✓" : "✗") << " n = 0..200, output offsets 0..15: all variants "
+              << (ok ? "match scalar" : "MISMATCH!") << "\n\n";
+
+    const size_t add_cross = crossover_sweep<AddKernel>(in, out, max_bytes, ok);
+    const size_t fma_cross = crossover_sweep<FmaKernel>(in, out, max_bytes * 4 / 3, ok);
+    prefetch_sweep<AddKernel>(in, out, max_bytes);
+
+    std::cout << "================================================\n";
+    std::cout << "Summary\n";
+    std::cout << "================================================\n";
+    std::cout << (ok ? "✓" : "✗") << " Results " << (ok ? "bit-identical across store modes" : "MISMATCH!") << "\n";
+    auto report = [](const char* kernel, size_t cross) {
+        std::cout << "✓ " << kernel << ": streaming stores win from "
+                  << (cross ? bytes_label(cross) : std::string("(not within the tested sizes)")) << "\n";
+    };
+    report("add", add_cross);
+    report("fma", fma_cross);
+    std::cout << "✓ Auto switches at " << bytes_label(st::stream_threshold_bytes()) << " (3/4 of LLC)";
+    if (add_cross != 0 && (add_cross * 4 < st::stream_threshold_bytes() || add_cross > st::stream_threshold_bytes() * 4)) {
+        std::cout << "; far from the measured crossover, call set_stream_threshold_bytes(" << add_cross << ")";
+    }
+    std::cout << "\n";
+    std::cout << "================================================\n";
+
+    return ok ? 0 : 1;
+}
+
+#endif
+
+/* 编译与运行:
+
+  g++ -std=c++20 -O3 -march=native streaming_benchmark.cpp -o streaming
+  ./streaming                 # 工作集 48 KB - 768 MB
+  ./streaming --max-mb 3072   # LLC 很大（服务器 CPU）时把上限调到 LLC 的 4 倍以上才能看到交叉点
+
+预期结果（台式机，LLC 约 16-32 MB）:
+  - 工作集在 L1 / L2 内时普通存储最快，streaming 存储每次都要写回内存，慢 5-20 倍
+  - 工作集接近 LLC 时两者接近；超过 LLC 后 streaming 快 20-40%：省掉了写目标的 RFO 读，
+    总内存流量从 4 个（add）/ 5 个（fma）数组降到 3 个 / 4 个
+  - auto 列在阈值以下跟随普通存储、以上跟随 streaming，picks 列显示它的选择
+  - 预取距离：顺序访问的硬件预取器已经很有效，软件预取只有 0-5% 的差别，
+    距离过大（4 KB）时跨页预取可能略慢；AVX2 与 AVX-512 在内存带宽上限处基本相同
+  - 服务器 / 虚拟机上 sysconf 报告整个插槽共享的 LLC（例如 300 MB），单核实际可用的缓存小得多：
+    交叉点会出现在几 MB（接近 L2 + 单核 LLC 份额），远低于 auto 的阈值，
+    Summary 会提示用 set_stream_threshold_bytes 换成实测值
+*/